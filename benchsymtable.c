@@ -0,0 +1,1225 @@
+/*--------------------------------------------------------------------*/
+/* benchsymtable.c                                                    */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "symtable.h"
+#ifdef SYMTABLE_ORDERED
+#include "symtableordered.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <assert.h>
+#if defined(__GLIBC__) && \
+   (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define HAVE_MALLINFO2
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock, in nanoseconds. */
+
+static long long getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (long long)sTime.tv_sec * 1000000000LL + sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare the long longs that pvFirst and pvSecond point to, as
+   qsort() expects. */
+
+static int compareLongLongs(const void *pvFirst, const void *pvSecond)
+{
+   long long llFirst = *(const long long*)pvFirst;
+   long long llSecond = *(const long long*)pvSecond;
+   if (llFirst < llSecond)
+      return -1;
+   return llFirst > llSecond;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the dPercentile-th percentile of the uCount sorted
+   latencies in allSorted. */
+
+static long long getPercentile(const long long *allSorted, size_t uCount,
+   double dPercentile)
+{
+   assert(allSorted != NULL);
+   assert(uCount > 0);
+   return allSorted[(size_t)(dPercentile / 100.0 * (double)(uCount - 1))];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a new SymTable object, with the
+   same keys as testLargeTable in testsymtable.c, timing every
+   SymTable_put call. Write the p50, p99, p99.9 and maximum latency
+   per put to stdout. */
+
+static void benchPutLatency(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   long long *allLatencies;
+   long long llStart;
+   long long llTotal = 0;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Latency of each SymTable_put (%d bindings):\n", iBindingCount);
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   allLatencies = (long long*)malloc(sizeof(long long) *
+      (size_t)iBindingCount);
+   if (allLatencies == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   oSymTable = SymTable_new();
+   assert(oSymTable != NULL);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      llStart = getNanoseconds();
+      iSuccessful = SymTable_put(oSymTable, acKey, NULL);
+      allLatencies[i] = getNanoseconds() - llStart;
+      assert(iSuccessful);
+      llTotal += allLatencies[i];
+   }
+   SymTable_free(oSymTable);
+
+   qsort(allLatencies, (size_t)iBindingCount, sizeof(long long),
+      compareLongLongs);
+   printf("mean: %lld ns  p50: %lld ns  p99: %lld ns  p99.9: %lld ns"
+      "  max: %lld ns\n",
+      llTotal / iBindingCount,
+      getPercentile(allLatencies, (size_t)iBindingCount, 50.0),
+      getPercentile(allLatencies, (size_t)iBindingCount, 99.0),
+      getPercentile(allLatencies, (size_t)iBindingCount, 99.9),
+      allLatencies[iBindingCount - 1]);
+   fflush(stdout);
+
+   free(allLatencies);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the next value of the pseudo-random sequence whose state is
+   *puState (a 64-bit xorshift generator, so that every
+   implementation sees the same sequence of operations). */
+
+static unsigned long long getRandom(unsigned long long *puState)
+{
+   unsigned long long u = *puState;
+   u ^= u << 13;
+   u ^= u >> 7;
+   u ^= u << 17;
+   *puState = u;
+   return u;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a short name for hash function eHash. */
+
+static const char *getHashName(enum SymTable_HashFunction eHash)
+{
+   if (eHash == SYMTABLE_HASH_WIDE)
+      return "wide";
+   return "multiplicative";
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a new SymTable object that hashes
+   keys with eHash, then run
+   LOOKUP_MIX_ROUNDS * iBindingCount operations on it, 95% of them
+   SymTable_get of a random present key and the rest an even mix of
+   SymTable_put of a new key and SymTable_remove of the oldest such
+   key. Keys are formatted in advance. Write the throughput of the
+   operations to stdout. */
+
+static void benchLookupMix(int iBindingCount,
+   enum SymTable_HashFunction eHash)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {LOOKUP_MIX_ROUNDS = 10};
+
+   SymTable_T oSymTable;
+   char (*aacKeys)[MAX_KEY_LENGTH];
+   size_t uKeyCount = 2 * (size_t)iBindingCount;
+   size_t uOps = LOOKUP_MIX_ROUNDS * (size_t)iBindingCount;
+   size_t uNextPut = (size_t)iBindingCount;
+   size_t uNextRemove = (size_t)iBindingCount;
+   size_t uFound = 0;
+   size_t u;
+   unsigned long long uState = 88172645463325252ULL;
+   long long llStart;
+   long long llElapsed;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Throughput of 95%% SymTable_get (%d bindings, %s hash):\n",
+      iBindingCount, getHashName(eHash));
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   aacKeys = malloc(uKeyCount * sizeof(*aacKeys));
+   if (aacKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (u = 0; u < uKeyCount; u++)
+      sprintf(aacKeys[u], "%lu", (unsigned long)u);
+
+   oSymTable = SymTable_newWithHash(eHash);
+   assert(oSymTable != NULL);
+   for (u = 0; u < (size_t)iBindingCount; u++)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacKeys[u], aacKeys[u]);
+      assert(iSuccessful);
+   }
+
+   llStart = getNanoseconds();
+   for (u = 0; u < uOps; u++)
+   {
+      unsigned long long uRandom = getRandom(&uState);
+      unsigned uKind = (unsigned)(uRandom % 200);
+      if (uKind < 190)
+      {
+         size_t uKey = (size_t)((uRandom >> 8) % (size_t)iBindingCount);
+         if (SymTable_get(oSymTable, aacKeys[uKey]) != NULL)
+            uFound++;
+      }
+      else if (uKind < 195 && uNextPut < uKeyCount)
+      {
+         iSuccessful = SymTable_put(oSymTable, aacKeys[uNextPut],
+            aacKeys[uNextPut]);
+         assert(iSuccessful);
+         uNextPut++;
+      }
+      else if (uNextRemove < uNextPut)
+      {
+         SymTable_remove(oSymTable, aacKeys[uNextRemove]);
+         uNextRemove++;
+      }
+   }
+   llElapsed = getNanoseconds() - llStart;
+   assert(uFound > 0);
+
+   printf("%lu operations: %f Mops/s\n", (unsigned long)uOps,
+      (double)uOps * 1000.0 / (double)llElapsed);
+   fflush(stdout);
+
+   SymTable_free(oSymTable);
+   free(aacKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a new SymTable object, then
+   repeatedly remove a random binding and put it back, so that the
+   table keeps freeing and allocating bindings. Write the throughput of
+   the removes and puts, and the time SymTable_free takes to release
+   the table, to stdout. */
+
+static void benchChurn(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {CHURN_ROUNDS = 10};
+
+   SymTable_T oSymTable;
+   char (*aacKeys)[MAX_KEY_LENGTH];
+   size_t uOps = CHURN_ROUNDS * (size_t)iBindingCount;
+   size_t u;
+   unsigned long long uState = 88172645463325252ULL;
+   long long llStart;
+   long long llElapsed;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Throughput of SymTable_remove/SymTable_put churn "
+      "(%d bindings):\n", iBindingCount);
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   aacKeys = malloc((size_t)iBindingCount * sizeof(*aacKeys));
+   if (aacKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (u = 0; u < (size_t)iBindingCount; u++)
+      sprintf(aacKeys[u], "%lu", (unsigned long)u);
+
+   oSymTable = SymTable_new();
+   assert(oSymTable != NULL);
+   for (u = 0; u < (size_t)iBindingCount; u++)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacKeys[u], aacKeys[u]);
+      assert(iSuccessful);
+   }
+
+   llStart = getNanoseconds();
+   for (u = 0; u < uOps; u++)
+   {
+      size_t uKey =
+         (size_t)(getRandom(&uState) % (unsigned long long)iBindingCount);
+      SymTable_remove(oSymTable, aacKeys[uKey]);
+      iSuccessful = SymTable_put(oSymTable, aacKeys[uKey], aacKeys[uKey]);
+      assert(iSuccessful);
+   }
+   llElapsed = getNanoseconds() - llStart;
+
+   printf("%lu remove/put pairs: %f Mops/s\n", (unsigned long)uOps,
+      (double)(2 * uOps) * 1000.0 / (double)llElapsed);
+   fflush(stdout);
+
+   llStart = getNanoseconds();
+   SymTable_free(oSymTable);
+   llElapsed = getNanoseconds() - llStart;
+   printf("SymTable_free: %f ms\n", (double)llElapsed / 1e6);
+   fflush(stdout);
+
+   free(aacKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up the two 999-character keys of testLongKey in testsymtable.c
+   iBindingCount times each, in a new SymTable object that hashes keys
+   with eHash. Write the throughput of the lookups to stdout. */
+
+static void benchLongKeys(int iBindingCount,
+   enum SymTable_HashFunction eHash)
+{
+   enum {KEY_SIZE = 1000};
+
+   SymTable_T oSymTable;
+   char acKeyA[KEY_SIZE];
+   char acKeyB[KEY_SIZE];
+   long long llStart;
+   long long llElapsed;
+   size_t uFound = 0;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Throughput of SymTable_get with long keys (%s hash):\n",
+      getHashName(eHash));
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   memset(acKeyA, 'a', KEY_SIZE - 1);
+   acKeyA[KEY_SIZE - 1] = '\0';
+   memset(acKeyB, 'b', KEY_SIZE - 1);
+   acKeyB[KEY_SIZE - 1] = '\0';
+
+   oSymTable = SymTable_newWithHash(eHash);
+   assert(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, acKeyA, acKeyA);
+   assert(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acKeyB, acKeyB);
+   assert(iSuccessful);
+
+   llStart = getNanoseconds();
+   for (i = 0; i < iBindingCount; i++)
+   {
+      if (SymTable_get(oSymTable, acKeyA) != NULL)
+         uFound++;
+      if (SymTable_get(oSymTable, acKeyB) != NULL)
+         uFound++;
+   }
+   llElapsed = getNanoseconds() - llStart;
+   assert(uFound == 2 * (size_t)iBindingCount);
+
+   printf("%lu lookups: %f Mops/s\n", (unsigned long)uFound,
+      (double)uFound * 1000.0 / (double)llElapsed);
+   fflush(stdout);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Model the name lookups of a compiler front end: SCOPE_COUNT nested
+   scopes, each a SymTable object that hashes keys with eHash, where
+   iBindingCount identifiers are declared in the outermost scope and 
+   looked up from the innermost scope outwards. Write the throughput 
+   of the lookups to stdout, first with SymTable_getN (one hash per
+   scope visited) and then with one SymTable_Key handle per identifier
+   (one hash per identifier). */
+
+static void benchScopes(int iBindingCount, 
+   enum SymTable_HashFunction eHash)
+{
+   enum {SCOPE_COUNT = 8};
+   enum {MAX_KEY_LENGTH = 32};
+   enum {SCOPE_ROUNDS = 10};
+   enum {LOCAL_COUNT = 64};
+
+   SymTable_T aoScopes[SCOPE_COUNT];
+   char (*aacKeys)[MAX_KEY_LENGTH];
+   size_t uLookups = SCOPE_ROUNDS * (size_t)iBindingCount;
+   size_t uFound;
+   size_t u;
+   int iScope;
+   int iRun;
+   long long llStart;
+   long long llElapsed;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Throughput of lookups through %d scopes (%s hash):\n",
+      SCOPE_COUNT, getHashName(eHash));
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   aacKeys = malloc((size_t)iBindingCount * sizeof(*aacKeys));
+   if (aacKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (u = 0; u < (size_t)iBindingCount; u++)
+      sprintf(aacKeys[u], "module_identifier_%lu", (unsigned long)u);
+
+   /* Inner scopes hold a few unrelated local names. */
+   for (iScope = 0; iScope < SCOPE_COUNT; iScope++)
+   {
+      aoScopes[iScope] = SymTable_newWithHash(eHash);
+      assert(aoScopes[iScope] != NULL);
+   }
+   for (u = 0; u < (size_t)iBindingCount; u++)
+   {
+      iSuccessful = SymTable_put(aoScopes[SCOPE_COUNT - 1], aacKeys[u],
+         aacKeys[u]);
+      assert(iSuccessful);
+   }
+   for (iScope = 0; iScope < SCOPE_COUNT - 1; iScope++)
+   {
+      char acLocal[MAX_KEY_LENGTH];
+      for (u = 0; u < LOCAL_COUNT; u++)
+      {
+         sprintf(acLocal, "local_%d_%lu", iScope, (unsigned long)u);
+         iSuccessful = SymTable_put(aoScopes[iScope], acLocal, acLocal);
+         assert(iSuccessful);
+      }
+   }
+
+   for (iRun = 0; iRun < 2; iRun++)
+   {
+      uFound = 0;
+      llStart = getNanoseconds();
+      for (u = 0; u < uLookups; u++)
+      {
+         const char *pcKey = aacKeys[u % (size_t)iBindingCount];
+         size_t uLength = strlen(pcKey);
+         SymTable_Key sKey;
+         SymTable_initKey(&sKey, pcKey, uLength);
+         for (iScope = 0; iScope < SCOPE_COUNT; iScope++)
+         {
+            void *pvValue = iRun == 0 ?
+               SymTable_getN(aoScopes[iScope], pcKey, uLength) :
+               SymTable_getKey(aoScopes[iScope], &sKey);
+            if (pvValue != NULL)
+            {
+               uFound++;
+               break;
+            }
+         }
+      }
+      llElapsed = getNanoseconds() - llStart;
+      assert(uFound == uLookups);
+
+      printf("%lu identifiers, %s: %f Mops/s\n", (unsigned long)uLookups,
+         iRun == 0 ? "SymTable_getN  " : "SymTable_getKey",
+         (double)uLookups * 1000.0 / (double)llElapsed);
+      fflush(stdout);
+   }
+
+   for (iScope = 0; iScope < SCOPE_COUNT; iScope++)
+      SymTable_free(aoScopes[iScope]);
+   free(aacKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up iBindingCount keys, in random order, in a SymTable object
+   of iBindingCount bindings that hashes keys with eHash: first with a
+   loop over SymTable_get, then with SymTable_getBatch, BATCH_SIZE keys
+   at a time. Write the throughput of both to stdout. */
+
+static void benchBatch(int iBindingCount, 
+   enum SymTable_HashFunction eHash)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {BATCH_SIZE = 1024};
+   enum {BATCH_ROUNDS = 5};
+
+   SymTable_T oSymTable;
+   char (*aacKeys)[MAX_KEY_LENGTH];
+   const char **apcLookups;
+   void *apvValues[BATCH_SIZE];
+   size_t uCount = (size_t)iBindingCount;
+   size_t uFound;
+   size_t u;
+   size_t uStart;
+   int iRound;
+   int iRun;
+   unsigned long long uState = 88172645463325252ULL;
+   long long llStart;
+   long long llElapsed;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Throughput of SymTable_get and SymTable_getBatch "
+      "(%d bindings, %s hash):\n", iBindingCount, getHashName(eHash));
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   aacKeys = malloc(uCount * sizeof(*aacKeys));
+   apcLookups = malloc(uCount * sizeof(*apcLookups));
+   if (aacKeys == NULL || apcLookups == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   oSymTable = SymTable_newWithHash(eHash);
+   assert(oSymTable != NULL);
+   for (u = 0; u < uCount; u++)
+   {
+      sprintf(aacKeys[u], "%lu", (unsigned long)u);
+      iSuccessful = SymTable_put(oSymTable, aacKeys[u], aacKeys[u]);
+      assert(iSuccessful);
+   }
+   for (u = 0; u < uCount; u++)
+      apcLookups[u] = aacKeys[getRandom(&uState) % uCount];
+
+   for (iRun = 0; iRun < 2; iRun++)
+   {
+      uFound = 0;
+      llStart = getNanoseconds();
+      for (iRound = 0; iRound < BATCH_ROUNDS; iRound++)
+      {
+         for (uStart = 0; uStart < uCount; uStart += BATCH_SIZE)
+         {
+            size_t uBatch = uCount - uStart < BATCH_SIZE ? 
+               uCount - uStart : BATCH_SIZE;
+            if (iRun == 0)
+               for (u = 0; u < uBatch; u++)
+                  apvValues[u] = 
+                     SymTable_get(oSymTable, apcLookups[uStart + u]);
+            else
+               SymTable_getBatch(oSymTable, apcLookups + uStart, uBatch,
+                  apvValues);
+            for (u = 0; u < uBatch; u++)
+               if (apvValues[u] != NULL)
+                  uFound++;
+         }
+      }
+      llElapsed = getNanoseconds() - llStart;
+      assert(uFound == BATCH_ROUNDS * uCount);
+
+      printf("%lu lookups, %s: %f Mops/s\n", (unsigned long)uFound,
+         iRun == 0 ? "SymTable_get     " : "SymTable_getBatch",
+         (double)uFound * 1000.0 / (double)llElapsed);
+      fflush(stdout);
+   }
+
+   SymTable_free(oSymTable);
+   free(aacKeys);
+   free(apcLookups);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Number of rounds of mixing that inspectBinding does per binding. */
+enum {INSPECT_ROUNDS = 256};
+
+/*--------------------------------------------------------------------*/
+
+/* Stand in for a heavy per-binding pass (such as type checking): mix
+   the characters of pcKey INSPECT_ROUNDS times, and add the result to
+   the unsigned long long that pvSlot points to. pvValue and pvExtra
+   are unused. */
+
+static void inspectBinding(const char *pcKey, void *pvValue,
+   void *pvExtra, void *pvSlot)
+{
+   unsigned long long ullMix = 0;
+   const char *pc;
+   int iRound;
+
+   (void)pvValue;
+   (void)pvExtra;
+   for (iRound = 0; iRound < INSPECT_ROUNDS; iRound++)
+      for (pc = pcKey; *pc != '\0'; pc++)
+         ullMix = (ullMix ^ (unsigned char)*pc) * 0x100000001b3ULL;
+   *(unsigned long long*)pvSlot += ullMix;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Call inspectBinding on each binding, with the unsigned long long
+   that pvExtra points to as its slot. pvValue is unused. */
+
+static void inspectBindingSerially(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   inspectBinding(pcKey, pvValue, NULL, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply a heavy function to each binding of a SymTable object of
+   iBindingCount bindings: first with SymTable_map, then with
+   SymTable_mapParallel and 1, 2, 4 and 8 threads, each with its own
+   reduction slot. Write the time of each, and its speedup over
+   SymTable_map, to stdout. */
+
+static void benchMapParallel(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {MAX_THREADS = 8};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   unsigned long long aullSlots[MAX_THREADS];
+   void *apvSlots[MAX_THREADS];
+   unsigned long long ullSerial = 0;
+   unsigned long long ullTotal;
+   long long llStart;
+   long long llSerial;
+   long long llElapsed;
+   size_t uThreads;
+   size_t u;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Time of SymTable_map and SymTable_mapParallel with a heavy "
+      "function (%d bindings):\n", iBindingCount);
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   oSymTable = SymTable_new();
+   assert(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, NULL);
+      assert(iSuccessful);
+   }
+
+   llStart = getNanoseconds();
+   SymTable_map(oSymTable, inspectBindingSerially, &ullSerial);
+   llSerial = getNanoseconds() - llStart;
+   printf("SymTable_map:                   %f s\n", (double)llSerial / 1e9);
+
+   for (uThreads = 1; uThreads <= MAX_THREADS; uThreads *= 2)
+   {
+      for (u = 0; u < MAX_THREADS; u++)
+      {
+         aullSlots[u] = 0;
+         apvSlots[u] = &aullSlots[u];
+      }
+      llStart = getNanoseconds();
+      SymTable_mapParallel(oSymTable, inspectBinding, NULL, uThreads,
+         apvSlots);
+      llElapsed = getNanoseconds() - llStart;
+
+      /* the slots add up to the result of the serial pass */
+      ullTotal = 0;
+      for (u = 0; u < MAX_THREADS; u++)
+         ullTotal += aullSlots[u];
+      assert(ullTotal == ullSerial);
+
+      printf("SymTable_mapParallel, %lu threads: %f s (%.2fx)\n",
+         (unsigned long)uThreads, (double)llElapsed / 1e9,
+         (double)llSerial / (double)llElapsed);
+      fflush(stdout);
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the size_t counter that pvExtra points to. pcKey and
+   pvValue are unused. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvValue;
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Traverse a SymTable object of iBindingCount bindings, then the same
+   object once all but one in SPARSE_STRIDE of them are removed (so
+   that most of its buckets are empty), ITERATE_ROUNDS times each: 
+   with SymTable_map, with a full iterator traversal, and with an 
+   iterator traversal that stops at the first binding whose value is
+   not NULL. Write the average time of each traversal, and the time of
+   SymTable_free on the sparse object, to stdout. */
+
+static void benchIterate(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {ITERATE_ROUNDS = 16};
+   enum {SPARSE_STRIDE = 64};
+
+   SymTable_T oSymTable;
+   SymTable_Iter sIter;
+   char acKey[MAX_KEY_LENGTH];
+   void *pvValue;
+   size_t uCount;
+   size_t uExpected;
+   long long llStart;
+   int iPass;
+   int iRound;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Time of a traversal with SymTable_map and with an iterator "
+      "(%d bindings):\n", iBindingCount);
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   /* only the last key has a value, so the early exit comes at a
+      random point of the traversal */
+   oSymTable = SymTable_new();
+   assert(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey,
+         i == iBindingCount - 1 ? oSymTable : NULL);
+      assert(iSuccessful);
+   }
+
+   uExpected = (size_t)iBindingCount;
+   for (iPass = 0; iPass < 2; iPass++)
+   {
+      llStart = getNanoseconds();
+      for (iRound = 0; iRound < ITERATE_ROUNDS; iRound++)
+      {
+         uCount = 0;
+         SymTable_map(oSymTable, countBinding, &uCount);
+         assert(uCount == uExpected);
+      }
+      printf("%s, SymTable_map:       %10.0f ns\n",
+         iPass == 0 ? "full  " : "sparse",
+         (double)(getNanoseconds() - llStart) / ITERATE_ROUNDS);
+
+      llStart = getNanoseconds();
+      for (iRound = 0; iRound < ITERATE_ROUNDS; iRound++)
+      {
+         uCount = 0;
+         SymTable_iterBegin(oSymTable, &sIter);
+         while (SymTable_iterNext(&sIter, NULL, NULL))
+            uCount++;
+         SymTable_iterEnd(&sIter);
+         assert(uCount == uExpected);
+      }
+      printf("%s, iterator:           %10.0f ns\n",
+         iPass == 0 ? "full  " : "sparse",
+         (double)(getNanoseconds() - llStart) / ITERATE_ROUNDS);
+
+      llStart = getNanoseconds();
+      for (iRound = 0; iRound < ITERATE_ROUNDS; iRound++)
+      {
+         SymTable_iterBegin(oSymTable, &sIter);
+         while (SymTable_iterNext(&sIter, NULL, &pvValue) &&
+            pvValue == NULL)
+            ;
+         SymTable_iterEnd(&sIter);
+         assert(pvValue == oSymTable);
+      }
+      printf("%s, iterator, early exit: %8.0f ns\n",
+         iPass == 0 ? "full  " : "sparse",
+         (double)(getNanoseconds() - llStart) / ITERATE_ROUNDS);
+      fflush(stdout);
+
+      /* keep every SPARSE_STRIDE-th key, and the last one */
+      for (i = 0; i < iBindingCount - 1; i++)
+         if (i % SPARSE_STRIDE != 0)
+         {
+            sprintf(acKey, "%d", i);
+            SymTable_remove(oSymTable, acKey);
+         }
+      uExpected = SymTable_getLength(oSymTable);
+   }
+
+   llStart = getNanoseconds();
+   SymTable_free(oSymTable);
+   printf("sparse, SymTable_free:      %10.0f ns\n",
+      (double)(getNanoseconds() - llStart));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a new SymTable object, remove all
+   but one in KEEP_STRIDE of them, and look up the rest LOOKUP_ROUNDS
+   times: as left by the removes, and again after SymTable_compact.
+   Write the throughput of the lookups, and the time SymTable_compact
+   takes, to stdout. */
+
+static void benchCompact(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {KEEP_STRIDE = 16};
+   enum {LOOKUP_ROUNDS = 64};
+
+   SymTable_T oSymTable;
+   char (*aacKeys)[MAX_KEY_LENGTH];
+   size_t uKept;
+   size_t uFound;
+   size_t u;
+   long long llStart;
+   long long llElapsed;
+   int iPass;
+   int iRound;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Lookups after removing most of %d bindings, before and "
+      "after SymTable_compact:\n", iBindingCount);
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   aacKeys = malloc((size_t)iBindingCount * sizeof(*aacKeys));
+   if (aacKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   oSymTable = SymTable_new();
+   assert(oSymTable != NULL);
+   for (u = 0; u < (size_t)iBindingCount; u++)
+   {
+      sprintf(aacKeys[u], "%lu", (unsigned long)u);
+      iSuccessful = SymTable_put(oSymTable, aacKeys[u], aacKeys[u]);
+      assert(iSuccessful);
+   }
+
+   /* the kept keys are moved to the front of aacKeys */
+   uKept = 0;
+   for (u = 0; u < (size_t)iBindingCount; u++)
+   {
+      if (u % KEEP_STRIDE == 0)
+         memmove(aacKeys[uKept++], aacKeys[u], MAX_KEY_LENGTH);
+      else
+         SymTable_remove(oSymTable, aacKeys[u]);
+   }
+
+   for (iPass = 0; iPass < 2; iPass++)
+   {
+      if (iPass == 1)
+      {
+         llStart = getNanoseconds();
+         iSuccessful = SymTable_compact(oSymTable);
+         assert(iSuccessful);
+         printf("SymTable_compact: %f ms\n",
+            (double)(getNanoseconds() - llStart) / 1e6);
+      }
+      uFound = 0;
+      llStart = getNanoseconds();
+      for (iRound = 0; iRound < LOOKUP_ROUNDS; iRound++)
+         for (u = 0; u < uKept; u++)
+            uFound += SymTable_get(oSymTable, aacKeys[u]) != NULL;
+      llElapsed = getNanoseconds() - llStart;
+      assert(uFound == LOOKUP_ROUNDS * uKept);
+      printf("%s: %lu gets, %f Mops/s\n",
+         iPass == 0 ? "after removes" : "after compact",
+         (unsigned long)(LOOKUP_ROUNDS * uKept),
+         (double)(LOOKUP_ROUNDS * uKept) * 1000.0 / (double)llElapsed);
+      fflush(stdout);
+   }
+
+   SymTable_free(oSymTable);
+   free(aacKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes that malloc has handed out and not taken
+   back, or -1 if the C library cannot tell. */
+
+static long long getHeapBytes(void)
+{
+#ifdef HAVE_MALLINFO2
+   /* a malloc that replaces the C library's (as a sanitizer's does)
+      leaves the counts at zero */
+   struct mallinfo2 sInfo = mallinfo2();
+   if (sInfo.uordblks + sInfo.hblkhd == 0)
+      return -1;
+   return (long long)(sInfo.uordblks + sInfo.hblkhd);
+#else
+   return -1;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a new SymTable object, with the
+   keys of testLargeTable ("0", "1", ...) and then with namespaced
+   identifiers ("pkg_0_module_0_func_0", ...), and write the heap
+   memory that the object takes per binding, keys included, to
+   stdout. */
+
+static void benchMemory(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 40};
+
+   SymTable_T oSymTable;
+   char (*aacKeys)[MAX_KEY_LENGTH];
+   size_t uKeyLengths;
+   long long llBefore;
+   long long llAfter;
+   int iCorpus;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Memory per binding, keys included (%d bindings):\n",
+      iBindingCount);
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+   if (getHeapBytes() < 0)
+   {
+      printf("Not measurable with this malloc.\n");
+      return;
+   }
+
+   aacKeys = malloc((size_t)iBindingCount * sizeof(*aacKeys));
+   if (aacKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   for (iCorpus = 0; iCorpus < 2; iCorpus++)
+   {
+      /* 64 functions to a module, and 64 modules to a package */
+      uKeyLengths = 0;
+      for (i = 0; i < iBindingCount; i++)
+      {
+         if (iCorpus == 0)
+            uKeyLengths += (size_t)sprintf(aacKeys[i], "%d", i);
+         else
+            uKeyLengths += (size_t)sprintf(aacKeys[i],
+               "pkg_%d_module_%d_func_%d", i / 4096, i / 64 % 64, i % 64);
+      }
+
+      llBefore = getHeapBytes();
+      oSymTable = SymTable_new();
+      assert(oSymTable != NULL);
+      for (i = 0; i < iBindingCount; i++)
+      {
+         iSuccessful = SymTable_put(oSymTable, aacKeys[i], NULL);
+         assert(iSuccessful);
+      }
+      llAfter = getHeapBytes();
+      printf("%-13s (%4.1f characters a key): %6.1f bytes\n",
+         iCorpus == 0 ? "numbers" : "namespaced",
+         (double)uKeyLengths / iBindingCount,
+         (double)(llAfter - llBefore) / iBindingCount);
+      fflush(stdout);
+      SymTable_free(oSymTable);
+   }
+
+   free(aacKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Create iBindingCount SymTable objects, as many as a compiler keeps
+   for the nested scopes of a large program, put the same few bindings
+   into each, and free them all again, for empty tables and tables of
+   1 and 4 bindings. Write the throughput of the creations (puts
+   included) and of the frees, and the heap memory each table takes,
+   to stdout. */
+
+static void benchCreate(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 8};
+   enum {SIZE_COUNT = 3};
+   enum {MAX_SIZE = 4};
+
+   static const int aiSizes[SIZE_COUNT] = {0, 1, MAX_SIZE};
+   SymTable_T *aoSymTables;
+   char aacKeys[MAX_SIZE][MAX_KEY_LENGTH];
+   long long llBefore;
+   long long llAfter;
+   long long llStart;
+   long long llCreated;
+   long long llFreed;
+   int iSize;
+   int i;
+   int j;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Creating and freeing %d small tables:\n", iBindingCount);
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   aoSymTables = malloc((size_t)iBindingCount * sizeof(SymTable_T));
+   if (aoSymTables == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (j = 0; j < MAX_SIZE; j++)
+      sprintf(aacKeys[j], "local%d", j);
+
+   for (iSize = 0; iSize < SIZE_COUNT; iSize++)
+   {
+      llBefore = getHeapBytes();
+      llStart = getNanoseconds();
+      for (i = 0; i < iBindingCount; i++)
+      {
+         aoSymTables[i] = SymTable_new();
+         assert(aoSymTables[i] != NULL);
+         for (j = 0; j < aiSizes[iSize]; j++)
+         {
+            iSuccessful = SymTable_put(aoSymTables[i], aacKeys[j], NULL);
+            assert(iSuccessful);
+         }
+      }
+      llCreated = getNanoseconds() - llStart;
+      llAfter = getHeapBytes();
+
+      llStart = getNanoseconds();
+      for (i = 0; i < iBindingCount; i++)
+         SymTable_free(aoSymTables[i]);
+      llFreed = getNanoseconds() - llStart;
+
+      printf("%d bindings: create %f Mtables/s, free %f Mtables/s",
+         aiSizes[iSize], (double)iBindingCount * 1000.0 / (double)llCreated,
+         (double)iBindingCount * 1000.0 / (double)llFreed);
+      if (llBefore >= 0)
+         printf(", %.1f bytes a table",
+            (double)(llAfter - llBefore) / iBindingCount);
+      printf("\n");
+      fflush(stdout);
+   }
+
+   free(aoSymTables);
+}
+
+#ifdef SYMTABLE_ORDERED
+/*--------------------------------------------------------------------*/
+
+/* The keys beginning with a prefix, gathered by a SymTable_map
+   traversal of a table that cannot look them up directly. */
+
+struct PrefixMatches
+{
+   /* The prefix, and its length */
+   const char *pcPrefix;
+   size_t uLength;
+   /* The keys found so far */
+   const char **apcKeys;
+   size_t uCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Add pcKey to the PrefixMatches pvExtra if it begins with its
+   prefix. pvValue is unused. */
+
+static void gatherMatch(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   struct PrefixMatches *psMatches = (struct PrefixMatches*)pvExtra;
+
+   (void)pvValue;
+   if (strncmp(pcKey, psMatches->pcPrefix, psMatches->uLength) == 0)
+      psMatches->apcKeys[psMatches->uCount++] = pcKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare the strings that pvFirst and pvSecond point to, as qsort()
+   expects. */
+
+static int compareStrings(const void *pvFirst, const void *pvSecond)
+{
+   return strcmp(*(const char *const*)pvFirst,
+                 *(const char *const*)pvSecond);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a new SymTable object, and find the
+   keys that begin with each of a few prefixes in order, PREFIX_ROUNDS
+   times: with SymTable_prefix, and by filtering a SymTable_map
+   traversal and sorting the keys it finds, as an unordered table
+   would have to. Write the average time of each query to stdout. */
+
+static void benchPrefix(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {PREFIX_ROUNDS = 16};
+
+   static const char *const apcPrefixes[] = {"12", "1234", "123456"};
+   SymTable_T oSymTable;
+   struct PrefixMatches sMatches;
+   char acKey[MAX_KEY_LENGTH];
+   size_t uCount;
+   size_t uPrefix;
+   long long llStart;
+   long long llQuery;
+   int iRound;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Time of a prefix query, with SymTable_prefix and with "
+      "SymTable_map and qsort (%d bindings):\n", iBindingCount);
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   assert(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, NULL);
+      assert(iSuccessful);
+   }
+   sMatches.apcKeys = (const char**)
+      malloc(((size_t)iBindingCount + 1) * sizeof(const char *));
+   assert(sMatches.apcKeys != NULL);
+
+   for (uPrefix = 0; uPrefix < 3; uPrefix++)
+   {
+      llStart = getNanoseconds();
+      for (iRound = 0; iRound < PREFIX_ROUNDS; iRound++)
+      {
+         uCount = 0;
+         SymTable_prefix(oSymTable, apcPrefixes[uPrefix], countBinding,
+            &uCount);
+      }
+      llQuery = getNanoseconds() - llStart;
+
+      sMatches.pcPrefix = apcPrefixes[uPrefix];
+      sMatches.uLength = strlen(apcPrefixes[uPrefix]);
+      llStart = getNanoseconds();
+      for (iRound = 0; iRound < PREFIX_ROUNDS; iRound++)
+      {
+         sMatches.uCount = 0;
+         SymTable_map(oSymTable, gatherMatch, &sMatches);
+         qsort(sMatches.apcKeys, sMatches.uCount, sizeof(const char *),
+            compareStrings);
+      }
+      assert(sMatches.uCount == uCount);
+      printf("\"%s\" (%lu keys): SymTable_prefix %10.0f ns   "
+         "map and qsort %10.0f ns\n", apcPrefixes[uPrefix],
+         (unsigned long)uCount, (double)llQuery / PREFIX_ROUNDS,
+         (double)(getNanoseconds() - llStart) / PREFIX_ROUNDS);
+      fflush(stdout);
+   }
+
+   free(sMatches.apcKeys);
+   SymTable_free(oSymTable);
+}
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Benchmark the SymTable ADT.  Write the results to stdout. As
+   always, argc is the command-line argument count, argv contains
+   the command-line arguments, and argv[0] is the name of the
+   executable binary file. argv[1] is the number of bindings to put
+   into a potentially large SymTable object.  Exit with EXIT_FAILURE
+   if argv[1] is missing or not numeric.  Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1)
+   {
+      fprintf(stderr, "bindingcount must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+   if (iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount cannot be negative\n");
+      exit(EXIT_FAILURE);
+   }
+
+   benchPutLatency(iBindingCount);
+   benchLookupMix(iBindingCount, SYMTABLE_HASH_MULTIPLICATIVE);
+   benchLookupMix(iBindingCount, SYMTABLE_HASH_WIDE);
+   benchLongKeys(iBindingCount, SYMTABLE_HASH_MULTIPLICATIVE);
+   benchLongKeys(iBindingCount, SYMTABLE_HASH_WIDE);
+   benchChurn(iBindingCount);
+   benchScopes(iBindingCount, SYMTABLE_HASH_MULTIPLICATIVE);
+   benchScopes(iBindingCount, SYMTABLE_HASH_WIDE);
+   benchBatch(iBindingCount, SYMTABLE_HASH_MULTIPLICATIVE);
+   benchBatch(iBindingCount, SYMTABLE_HASH_WIDE);
+   benchMapParallel(iBindingCount);
+   benchIterate(iBindingCount);
+   benchCompact(iBindingCount);
+   benchMemory(iBindingCount);
+   benchCreate(iBindingCount);
+#ifdef SYMTABLE_ORDERED
+   benchPrefix(iBindingCount);
+#endif
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
@@ -0,0 +1,408 @@
+/*--------------------------------------------------------------------*/
+/* stresssymtable.c                                                   */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtable.h"
+#include "symtableconc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/*--------------------------------------------------------------------*/
+
+/* Stress test and scaling benchmark for a SymTable implementation
+   that is safe for concurrent use (symtableconc.c, with or without
+   SYMTABLE_LOCKFREE_READS). Like testLargeTable in testsymtable.c, it
+   puts, gets and removes bindingcount bindings whose keys are the
+   numbers 0 to bindingcount-1, but splits the work among 1, 2, 4, ...
+   threads, up to the number of online processors, and reports the
+   throughput of each phase and its speedup over one thread. */
+
+enum {MAX_KEY_LENGTH = 12};
+
+/* The phases that the threads run, one after the other. */
+enum Phase {
+   /* Each thread puts its share of the keys. */
+   PHASE_PUT,
+   /* Each thread gets every key, starting at a different one. */
+   PHASE_GET,
+   /* Each thread gets keys, 7 times in 8, or else removes one of its
+      own keys and puts it back. */
+   PHASE_MIXED,
+   /* The same, but with 1023 gets for every remove and put. */
+   PHASE_READ_MOSTLY,
+   /* Each thread removes its share of the keys. */
+   PHASE_REMOVE,
+   PHASE_COUNT
+};
+
+/* The state of one thread of the test. */
+struct Worker {
+   /* The table shared by all threads */
+   SymTable_T oSymTable;
+   /* The values: the value of key i is &aiValues[i] */
+   int *aiValues;
+   /* Number of keys */
+   int iBindingCount;
+   /* Index of the thread, and number of threads: thread iThread owns
+      the keys i with i % iThreadCount == iThread */
+   int iThread;
+   int iThreadCount;
+   /* The phase to run */
+   enum Phase ePhase;
+   /* Number of failed checks */
+   int iFailures;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock, in nanoseconds. */
+
+static long long getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (long long)sTime.tv_sec * 1000000000LL + sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the name of phase ePhase. */
+
+static const char *getPhaseName(enum Phase ePhase)
+{
+   switch (ePhase)
+   {
+      case PHASE_PUT:
+         return "put";
+      case PHASE_GET:
+         return "get";
+      case PHASE_MIXED:
+         return "get/remove/put";
+      case PHASE_READ_MOSTLY:
+         return "read-mostly";
+      case PHASE_REMOVE:
+         return "remove";
+      default:
+         return "?";
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of SymTable calls that one thread of iThreadCount
+   makes in phase ePhase with iBindingCount keys. */
+
+static double getOpCount(enum Phase ePhase, int iBindingCount,
+   int iThreadCount)
+{
+   if (ePhase == PHASE_GET || ePhase == PHASE_MIXED ||
+      ePhase == PHASE_READ_MOSTLY)
+      return (double)iBindingCount * iThreadCount;
+   return (double)iBindingCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run the phase of the Worker that pvWorker points to, counting the
+   checks that fail in its iFailures field. Return NULL. */
+
+static void *runWorker(void *pvWorker)
+{
+   struct Worker *psWorker = (struct Worker*)pvWorker;
+   SymTable_T oSymTable = psWorker->oSymTable;
+   int iBindingCount = psWorker->iBindingCount;
+   char acKey[MAX_KEY_LENGTH];
+   void *pvValue;
+   int iUpdatePeriod;
+   int i;
+   int j;
+
+   assert(psWorker != NULL);
+
+   switch (psWorker->ePhase)
+   {
+      case PHASE_PUT:
+         for (i = psWorker->iThread; i < iBindingCount;
+            i += psWorker->iThreadCount)
+         {
+            sprintf(acKey, "%d", i);
+            if (! SymTable_put(oSymTable, acKey, &psWorker->aiValues[i]))
+               psWorker->iFailures++;
+         }
+         break;
+
+      case PHASE_GET:
+         /* each thread starts at a different key, so that the threads
+            do not all work on the same stripe at the same time */
+         for (j = 0; j < iBindingCount; j++)
+         {
+            i = (int)(((long long)iBindingCount * psWorker->iThread /
+               psWorker->iThreadCount + j) % iBindingCount);
+            sprintf(acKey, "%d", i);
+            pvValue = SymTable_get(oSymTable, acKey);
+            if (pvValue != &psWorker->aiValues[i])
+               psWorker->iFailures++;
+         }
+         break;
+
+      case PHASE_MIXED:
+      case PHASE_READ_MOSTLY:
+         iUpdatePeriod = psWorker->ePhase == PHASE_MIXED ? 8 : 1024;
+         for (j = 0; j < iBindingCount; j++)
+         {
+            i = (int)(((long long)iBindingCount * psWorker->iThread /
+               psWorker->iThreadCount + j) % iBindingCount);
+            sprintf(acKey, "%d", i);
+            if (j % iUpdatePeriod == iUpdatePeriod - 1 &&
+               i % psWorker->iThreadCount == psWorker->iThread)
+            {
+               /* only this thread updates its own keys */
+               pvValue = SymTable_remove(oSymTable, acKey);
+               if (pvValue != &psWorker->aiValues[i])
+                  psWorker->iFailures++;
+               if (! SymTable_put(oSymTable, acKey, pvValue))
+                  psWorker->iFailures++;
+            }
+            else
+            {
+               /* another thread may have removed key i for a moment */
+               pvValue = SymTable_get(oSymTable, acKey);
+               if (pvValue != NULL && pvValue != &psWorker->aiValues[i])
+                  psWorker->iFailures++;
+            }
+         }
+         break;
+
+      case PHASE_REMOVE:
+         for (i = psWorker->iThread; i < iBindingCount;
+            i += psWorker->iThreadCount)
+         {
+            sprintf(acKey, "%d", i);
+            pvValue = SymTable_remove(oSymTable, acKey);
+            if (pvValue != &psWorker->aiValues[i])
+               psWorker->iFailures++;
+         }
+         break;
+
+      default:
+         assert(0);
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increment the size_t that pvCount points to. Used with SymTable_map
+   to count bindings; pcKey and pvValue are unused. */
+
+static void countBinding(const char *pcKey, void *pvValue, void *pvCount)
+{
+   (void)pcKey;
+   (void)pvValue;
+   (*(size_t*)pvCount)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run every phase with iThreadCount threads on a new SymTable object
+   with iBindingCount bindings, made by SymTable_newSharded with
+   uShardCount shards, or by SymTable_new if uShardCount is 0, storing
+   the seconds that each phase took in adSeconds. Write failed checks
+   to stdout. Return the number of failed checks. */
+
+static int runThreads(int iBindingCount, int iThreadCount,
+   size_t uShardCount, double adSeconds[])
+{
+   SymTable_T oSymTable;
+   struct Worker *asWorkers;
+   pthread_t *aThreads;
+   int *aiValues;
+   long long llStart;
+   size_t uLength;
+   size_t uMapped;
+   int iFailures = 0;
+   int ePhase;
+   int t;
+
+   asWorkers = (struct Worker*)malloc(sizeof(struct Worker) *
+      (size_t)iThreadCount);
+   aThreads = (pthread_t*)malloc(sizeof(pthread_t) *
+      (size_t)iThreadCount);
+   aiValues = (int*)malloc(sizeof(int) * ((size_t)iBindingCount + 1));
+   if (uShardCount == 0)
+      oSymTable = SymTable_new();
+   else
+      oSymTable = SymTable_newSharded(uShardCount);
+   if (asWorkers == NULL || aThreads == NULL || aiValues == NULL ||
+      oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   for (ePhase = 0; ePhase < PHASE_COUNT; ePhase++)
+   {
+      llStart = getNanoseconds();
+      for (t = 0; t < iThreadCount; t++)
+      {
+         asWorkers[t].oSymTable = oSymTable;
+         asWorkers[t].aiValues = aiValues;
+         asWorkers[t].iBindingCount = iBindingCount;
+         asWorkers[t].iThread = t;
+         asWorkers[t].iThreadCount = iThreadCount;
+         asWorkers[t].ePhase = (enum Phase)ePhase;
+         asWorkers[t].iFailures = 0;
+         if (pthread_create(&aThreads[t], NULL, runWorker,
+            &asWorkers[t]) != 0)
+         {
+            fprintf(stderr, "Cannot create thread %d\n", t);
+            exit(EXIT_FAILURE);
+         }
+      }
+      for (t = 0; t < iThreadCount; t++)
+      {
+         pthread_join(aThreads[t], NULL);
+         iFailures += asWorkers[t].iFailures;
+      }
+      adSeconds[ePhase] = (double)(getNanoseconds() - llStart) / 1e9;
+
+      /* between phases, the table must hold every key, or none */
+      uLength = SymTable_getLength(oSymTable);
+      uMapped = 0;
+      SymTable_map(oSymTable, countBinding, &uMapped);
+      if (uLength != (ePhase == PHASE_REMOVE ? 0 : (size_t)iBindingCount)
+         || uMapped != uLength)
+      {
+         printf("Length %lu (%lu mapped) after %s phase with %d threads "
+            "failed.\n", (unsigned long)uLength, (unsigned long)uMapped,
+            getPhaseName((enum Phase)ePhase), iThreadCount);
+         iFailures++;
+      }
+   }
+
+   if (iFailures != 0)
+      printf("%d checks with %d threads failed.\n", iFailures,
+         iThreadCount);
+   fflush(stdout);
+
+   SymTable_free(oSymTable);
+   free(aiValues);
+   free(aThreads);
+   free(asWorkers);
+   return iFailures;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run the stress test with iBindingCount bindings and 1, 2, 4, ...
+   threads, up to iMaxThreads, on tables with uShardCount shards (or
+   not sharded, if uShardCount is 0), writing the throughput of each
+   phase and its speedup over one thread to stdout. */
+
+static void stressScaling(int iBindingCount, int iMaxThreads,
+   size_t uShardCount)
+{
+   double adSeconds[PHASE_COUNT];
+   double adBaseline[PHASE_COUNT];
+   double dMops;
+   int iThreadCount;
+   int ePhase;
+
+   printf("------------------------------------------------------\n");
+   if (uShardCount == 0)
+      printf("Concurrent SymTable calls (%d bindings, up to %d threads):\n",
+         iBindingCount, iMaxThreads);
+   else
+      printf("Concurrent SymTable calls (%d bindings, up to %d threads, "
+         "%lu shards):\n", iBindingCount, iMaxThreads,
+         (unsigned long)uShardCount);
+   printf("threads %-16s %10s %8s\n", "phase", "Mops/s", "speedup");
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   iThreadCount = 1;
+   for (;;)
+   {
+      runThreads(iBindingCount, iThreadCount, uShardCount, adSeconds);
+      for (ePhase = 0; ePhase < PHASE_COUNT; ePhase++)
+      {
+         if (iThreadCount == 1)
+            adBaseline[ePhase] = adSeconds[ePhase] /
+               getOpCount((enum Phase)ePhase, iBindingCount, 1);
+         dMops = getOpCount((enum Phase)ePhase, iBindingCount,
+            iThreadCount) / adSeconds[ePhase] / 1e6;
+         printf("%7d %-16s %10.2f %7.2fx\n", iThreadCount,
+            getPhaseName((enum Phase)ePhase), dMops,
+            dMops * adBaseline[ePhase] * 1e6);
+      }
+      fflush(stdout);
+
+      if (iThreadCount == iMaxThreads)
+         break;
+      iThreadCount *= 2;
+      if (iThreadCount > iMaxThreads)
+         iThreadCount = iMaxThreads;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Stress test a SymTable implementation that is safe for concurrent
+   use with argv[1] bindings and up to argv[2] threads (by default,
+   one per online processor). Return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+   int iMaxThreads;
+
+   if (argc != 2 && argc != 3)
+   {
+      fprintf(stderr, "Usage: %s bindingcount [maxthreads]\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1)
+   {
+      fprintf(stderr, "bindingcount must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+   if (iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount cannot be negative\n");
+      exit(EXIT_FAILURE);
+   }
+
+   if (argc == 3)
+   {
+      if (sscanf(argv[2], "%d", &iMaxThreads) != 1 || iMaxThreads < 1)
+      {
+         fprintf(stderr, "maxthreads must be a positive number\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+   else
+   {
+      iMaxThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+      if (iMaxThreads < 1)
+         iMaxThreads = 1;
+   }
+
+   stressScaling(iBindingCount, iMaxThreads, 0);
+   stressScaling(iBindingCount, iMaxThreads, 1);
+   stressScaling(iBindingCount, iMaxThreads, 64);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
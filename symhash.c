@@ -0,0 +1,213 @@
+/*--------------------------------------------------------------------*/
+/* symhash.c                                                          */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <string.h>
+#include "symhash.h"
+
+/*--------------------------------------------------------------------*/
+
+/* Unsigned integer type of exactly 64 bits, used by the wide hash
+   whatever the width of size_t. */
+typedef unsigned long long Hash_U64;
+
+/* Secret constants of the wide hash (the wyhash primes). */
+static const Hash_U64 HASH_P0 = 0xa0761d6478bd642fULL;
+static const Hash_U64 HASH_P1 = 0xe7037ed1a0b428dbULL;
+static const Hash_U64 HASH_P2 = 0x8ebc6af09c88c6e3ULL;
+static const Hash_U64 HASH_P3 = 0x589965cc75374cc3ULL;
+
+/*--------------------------------------------------------------------*/
+
+/* Return the multiplicative hash code (multiplier 65599) of the
+   uLength characters starting at pcKey. */
+
+static size_t SymHash_multiplicative(const char *pcKey, size_t uLength)
+{
+    const size_t HASH_MULTIPLIER = 65599;
+    size_t u;
+    size_t uHash = 0;
+
+    assert(pcKey != NULL);
+
+    for (u = 0; u < uLength; u++)
+        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+    return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Store the low and high halves of the 128-bit product of *puA and
+   *puB in *puA and *puB respectively. */
+
+static void SymHash_multiply(Hash_U64 *puA, Hash_U64 *puB)
+{
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 Hash_U128;
+    Hash_U128 uProduct = (Hash_U128)*puA * *puB;
+    *puA = (Hash_U64)uProduct;
+    *puB = (Hash_U64)(uProduct >> 64);
+#else
+    Hash_U64 uHighA = *puA >> 32, uLowA = (unsigned)*puA;
+    Hash_U64 uHighB = *puB >> 32, uLowB = (unsigned)*puB;
+    Hash_U64 uHH = uHighA * uHighB, uHL = uHighA * uLowB;
+    Hash_U64 uLH = uLowA * uHighB, uLL = uLowA * uLowB;
+    Hash_U64 uT = uLL + (uHL << 32);
+    Hash_U64 uLow = uT + (uLH << 32);
+    Hash_U64 uCarry = (uT < uLL) + (uLow < uT);
+    *puA = uLow;
+    *puB = uHH + (uHL >> 32) + (uLH >> 32) + uCarry;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the exclusive or of the two halves of the 128-bit product of
+   uA and uB. */
+
+static Hash_U64 SymHash_mix(Hash_U64 uA, Hash_U64 uB)
+{
+    SymHash_multiply(&uA, &uB);
+    return uA ^ uB;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the 8 bytes starting at pc as an integer. */
+
+static Hash_U64 SymHash_read8(const char *pc)
+{
+    Hash_U64 u;
+    memcpy(&u, pc, sizeof(u));
+    return u;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the 4 bytes starting at pc as an integer. */
+
+static Hash_U64 SymHash_read4(const char *pc)
+{
+    unsigned int u;
+    memcpy(&u, pc, sizeof(u));
+    return u;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the wide hash code of the uLength characters starting at
+   pcKey: wyhash (final version 4) with seed 0, which consumes the key
+   8 or 16 bytes at a time. */
+
+static size_t SymHash_wide(const char *pcKey, size_t uLength)
+{
+    const char *pc = pcKey;
+    Hash_U64 uSeed = 0;
+    Hash_U64 uA;
+    Hash_U64 uB;
+
+    assert(pcKey != NULL);
+
+    uSeed ^= SymHash_mix(uSeed ^ HASH_P0, HASH_P1);
+    if (uLength <= 16){
+        if (uLength >= 4){
+            size_t uShift = (uLength >> 3) << 2;
+            uA = (SymHash_read4(pc) << 32) | SymHash_read4(pc + uShift);
+            uB = (SymHash_read4(pc + uLength - 4) << 32) |
+                SymHash_read4(pc + uLength - 4 - uShift);
+        }
+        else if (uLength > 0){
+            uA = ((Hash_U64)(unsigned char)pc[0] << 16) |
+                ((Hash_U64)(unsigned char)pc[uLength >> 1] << 8) |
+                (Hash_U64)(unsigned char)pc[uLength - 1];
+            uB = 0;
+        }
+        else uA = uB = 0;
+    }
+    else {
+        size_t uLeft = uLength;
+        if (uLeft > 48){
+            Hash_U64 uSeed1 = uSeed;
+            Hash_U64 uSeed2 = uSeed;
+            do {
+                uSeed = SymHash_mix(SymHash_read8(pc) ^ HASH_P1,
+                                    SymHash_read8(pc + 8) ^ uSeed);
+                uSeed1 = SymHash_mix(SymHash_read8(pc + 16) ^ HASH_P2,
+                                     SymHash_read8(pc + 24) ^ uSeed1);
+                uSeed2 = SymHash_mix(SymHash_read8(pc + 32) ^ HASH_P3,
+                                     SymHash_read8(pc + 40) ^ uSeed2);
+                pc += 48;
+                uLeft -= 48;
+            } while (uLeft > 48);
+            uSeed ^= uSeed1 ^ uSeed2;
+        }
+        while (uLeft > 16){
+            uSeed = SymHash_mix(SymHash_read8(pc) ^ HASH_P1,
+                                SymHash_read8(pc + 8) ^ uSeed);
+            pc += 16;
+            uLeft -= 16;
+        }
+        uA = SymHash_read8(pc + uLeft - 16);
+        uB = SymHash_read8(pc + uLeft - 8);
+    }
+
+    uA ^= HASH_P1;
+    uB ^= uSeed;
+    SymHash_multiply(&uA, &uB);
+    return (size_t)SymHash_mix(uA ^ HASH_P0 ^ (Hash_U64)uLength,
+                               uB ^ HASH_P1);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymHash_hash(enum SymTable_HashFunction eHash, const char *pcKey,
+    size_t uLength)
+{
+    assert(pcKey != NULL);
+
+    if (eHash == SYMTABLE_HASH_WIDE)
+        return SymHash_wide(pcKey, uLength);
+    return SymHash_multiplicative(pcKey, uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymHash_keyHash(SymTable_Key *psKey, 
+    enum SymTable_HashFunction eHash)
+{
+    unsigned uBit = 1u << (unsigned)eHash;
+
+    assert(psKey != NULL);
+    assert((int)eHash >= 0 && (int)eHash < SYMTABLE_HASH_COUNT);
+
+    if ((psKey->uHashMask & uBit) == 0){
+        psKey->auHash[eHash] = 
+            SymHash_hash(eHash, psKey->pcKey, psKey->uLength);
+        psKey->uHashMask |= uBit;
+    }
+    return psKey->auHash[eHash];
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymHash_fastRange(size_t uA, size_t uRange)
+{
+#if defined(__SIZEOF_INT128__) && defined(__SIZEOF_SIZE_T__) && \
+    __SIZEOF_SIZE_T__ == 8
+    __extension__ typedef unsigned __int128 Hash_U128;
+    return (size_t)(((Hash_U128)uA * uRange) >> 64);
+#else
+    /* schoolbook multiplication on half-width digits */
+    const int HALF_BITS = (int)(sizeof(size_t) * 4);
+    const size_t LOW_MASK = ((size_t)1 << HALF_BITS) - 1;
+    size_t uHighA = uA >> HALF_BITS, uLowA = uA & LOW_MASK;
+    size_t uHighR = uRange >> HALF_BITS, uLowR = uRange & LOW_MASK;
+    size_t uLL = uLowA * uLowR;
+    size_t uHL = uHighA * uLowR;
+    size_t uLH = uLowA * uHighR;
+    size_t uCross = (uLL >> HALF_BITS) + (uHL & LOW_MASK) + uLH;
+    return uHighA * uHighR + (uHL >> HALF_BITS) + (uCross >> HALF_BITS);
+#endif
+}
@@ -0,0 +1,46 @@
+/*--------------------------------------------------------------------*/
+/* symhash.h                                                          */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMHASH_INCLUDED
+#define SYMHASH_INCLUDED
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include "symtable.h"
+
+/*--------------------------------------------------------------------*/
+
+/* String hash functions shared by the hashed SymTable
+   implementations. */
+
+/*--------------------------------------------------------------------*/
+
+/* Returns the hash code, computed with hash function eHash, of the
+   uLength characters starting at pcKey. The result is not reduced to
+   any range. */
+
+size_t SymHash_hash(enum SymTable_HashFunction eHash, const char *pcKey,
+    size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Returns the hash code, computed with hash function eHash, of the key
+   of the handle *psKey: the one cached in *psKey if any, or else a new
+   one, which is cached in *psKey. */
+
+size_t SymHash_keyHash(SymTable_Key *psKey, 
+    enum SymTable_HashFunction eHash);
+
+/*--------------------------------------------------------------------*/
+
+/* Returns the high half of the double-width product of uA and uB,
+   which is uA * uRange / 2^(bits in size_t): a number between 0 and
+   uRange-1 that is as well distributed as the high bits of uA. Used to
+   map a hash code to a bucket without integer division. */
+
+size_t SymHash_fastRange(size_t uA, size_t uRange);
+
+/*--------------------------------------------------------------------*/
+#endif
@@ -0,0 +1,215 @@
+/*--------------------------------------------------------------------*/
+/* sympar.c                                                           */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "sympar.h"
+
+/*--------------------------------------------------------------------*/
+
+/* Number of items a worker takes from its own range at a time. Small
+   enough that a thief finds items left, large enough that the lock of
+   the range is rarely taken. */
+enum {PAR_CHUNK = 16};
+
+/* Size of the cache line that separates the ranges of the workers. */
+enum {CACHE_LINE_SIZE = 64};
+
+/* The items not yet taken by a worker: [next, end). The worker takes
+   items from the front, and thieves take them from the back. */
+struct Range {
+    /* Guards next and end */
+    pthread_mutex_t mutex;
+    /* The first item not taken */
+    size_t next;
+    /* One past the last item not taken */
+    size_t end;
+    /* Keeps the ranges of different workers in different cache lines */
+    char acPadding[CACHE_LINE_SIZE];
+};
+
+/* A parallel loop: the ranges of its workers and the work to do. */
+struct Loop {
+    /* Array of the ranges of the workers */
+    struct Range *ranges;
+    /* Number of workers */
+    size_t workerCount;
+    /* The work to do on a subrange, and its context */
+    void (*pfWork)(size_t uStart, size_t uEnd, size_t uWorker,
+                   void *pvContext);
+    void *pvContext;
+};
+
+/* The argument of the thread of one worker. */
+struct Worker {
+    /* The loop */
+    struct Loop *psLoop;
+    /* The index of the worker */
+    size_t index;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Take up to uMax items from the front of *psRange. Store the first in
+   *puStart and one past the last in *puEnd. Return 1 (TRUE) if any
+   item was taken, or 0 (FALSE) if the range was empty. */
+
+static int SymPar_take(struct Range *psRange, size_t uMax,
+                       size_t *puStart, size_t *puEnd)
+{
+    int iTaken = 0;
+
+    assert(psRange != NULL);
+    assert(puStart != NULL);
+    assert(puEnd != NULL);
+
+    pthread_mutex_lock(&psRange->mutex);
+    if (psRange->next < psRange->end){
+        *puStart = psRange->next;
+        *puEnd = psRange->end - psRange->next > uMax ?
+            psRange->next + uMax : psRange->end;
+        psRange->next = *puEnd;
+        iTaken = 1;
+    }
+    pthread_mutex_unlock(&psRange->mutex);
+    return iTaken;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the back half of the remaining items of another worker of
+   psLoop into the (empty) range of worker uWorker. Return 1 (TRUE) if
+   any items were moved, or 0 (FALSE) if every other worker's range
+   was empty. */
+
+static int SymPar_steal(struct Loop *psLoop, size_t uWorker)
+{
+    struct Range *psVictim;
+    struct Range *psOwn;
+    size_t uMiddle;
+    size_t uEnd;
+    size_t u;
+
+    assert(psLoop != NULL);
+
+    psOwn = &psLoop->ranges[uWorker];
+    for (u = 1; u < psLoop->workerCount; u++){
+        psVictim = &psLoop->ranges[(uWorker + u) % psLoop->workerCount];
+        pthread_mutex_lock(&psVictim->mutex);
+        uEnd = psVictim->end;
+        uMiddle = psVictim->next + (uEnd - psVictim->next) / 2;
+        if (uMiddle < uEnd)
+            psVictim->end = uMiddle;
+        pthread_mutex_unlock(&psVictim->mutex);
+
+        if (uMiddle < uEnd){
+            pthread_mutex_lock(&psOwn->mutex);
+            psOwn->next = uMiddle;
+            psOwn->end = uEnd;
+            pthread_mutex_unlock(&psOwn->mutex);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run the worker that pvWorker points to: process chunks of its own
+   range, and then of ranges stolen from other workers, until no
+   worker has items left. Return NULL. */
+
+static void *SymPar_work(void *pvWorker)
+{
+    struct Worker *psWorker = (struct Worker*)pvWorker;
+    struct Loop *psLoop;
+    size_t uStart;
+    size_t uEnd;
+
+    assert(psWorker != NULL);
+
+    psLoop = psWorker->psLoop;
+    do {
+        while (SymPar_take(&psLoop->ranges[psWorker->index], PAR_CHUNK,
+                           &uStart, &uEnd))
+            (*psLoop->pfWork)(uStart, uEnd, psWorker->index,
+                              psLoop->pvContext);
+    } while (SymPar_steal(psLoop, psWorker->index));
+    return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymPar_run(size_t uItemCount, size_t uWorkerCount,
+    void (*pfWork)(size_t uStart, size_t uEnd, size_t uWorker,
+                   void *pvContext),
+    void *pvContext)
+{
+    struct Loop sLoop;
+    struct Worker *asWorkers;
+    pthread_t *aThreads;
+    int *aiStarted;
+    size_t u;
+
+    assert(pfWork != NULL);
+
+    /* no worker without at least a chunk of its own */
+    if (uWorkerCount > (uItemCount + PAR_CHUNK - 1) / PAR_CHUNK)
+        uWorkerCount = (uItemCount + PAR_CHUNK - 1) / PAR_CHUNK;
+    if (uWorkerCount <= 1){
+        if (uItemCount > 0)
+            (*pfWork)(0, uItemCount, 0, pvContext);
+        return;
+    }
+
+    sLoop.ranges = (struct Range*)
+        malloc(uWorkerCount * sizeof(struct Range));
+    asWorkers = (struct Worker*)
+        malloc(uWorkerCount * sizeof(struct Worker));
+    aThreads = (pthread_t*)malloc(uWorkerCount * sizeof(pthread_t));
+    aiStarted = (int*)calloc(uWorkerCount, sizeof(int));
+    if (sLoop.ranges == NULL || asWorkers == NULL || aThreads == NULL ||
+        aiStarted == NULL){
+        /* without memory for the workers, work alone */
+        free(sLoop.ranges);
+        free(asWorkers);
+        free(aThreads);
+        free(aiStarted);
+        (*pfWork)(0, uItemCount, 0, pvContext);
+        return;
+    }
+
+    sLoop.workerCount = uWorkerCount;
+    sLoop.pfWork = pfWork;
+    sLoop.pvContext = pvContext;
+    for (u = 0; u < uWorkerCount; u++){
+        pthread_mutex_init(&sLoop.ranges[u].mutex, NULL);
+        sLoop.ranges[u].next = uItemCount / uWorkerCount * u;
+        sLoop.ranges[u].end = u + 1 == uWorkerCount ?
+            uItemCount : uItemCount / uWorkerCount * (u + 1);
+        asWorkers[u].psLoop = &sLoop;
+        asWorkers[u].index = u;
+    }
+
+    /* the range of a worker whose thread cannot be created is left
+       for the others to steal */
+    for (u = 1; u < uWorkerCount; u++)
+        aiStarted[u] = pthread_create(&aThreads[u], NULL, SymPar_work,
+                                      &asWorkers[u]) == 0;
+    SymPar_work(&asWorkers[0]);
+    for (u = 1; u < uWorkerCount; u++)
+        if (aiStarted[u])
+            pthread_join(aThreads[u], NULL);
+
+    for (u = 0; u < uWorkerCount; u++)
+        pthread_mutex_destroy(&sLoop.ranges[u].mutex);
+    free(sLoop.ranges);
+    free(asWorkers);
+    free(aThreads);
+    free(aiStarted);
+}
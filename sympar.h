@@ -0,0 +1,36 @@
+/*--------------------------------------------------------------------*/
+/* sympar.h                                                           */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMPAR_INCLUDED
+#define SYMPAR_INCLUDED
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+
+/*--------------------------------------------------------------------*/
+
+/* Parallel loops over a range of items (such as the buckets of a
+   SymTable), shared by the SymTable implementations that can split
+   their bindings into such a range. */
+
+/*--------------------------------------------------------------------*/
+
+/* Calls (*pfWork)(uStart, uEnd, uWorker, pvContext) for consecutive
+   subranges [uStart, uEnd) that together cover each item from 0 to
+   uItemCount-1 exactly once, from uWorkerCount workers: the calling
+   thread, which is worker 0, and up to uWorkerCount-1 new threads.
+   Each worker starts with an equal share of the items and, when done
+   with it, steals half of the remaining items of another worker, so
+   that workers whose items take longer do not hold up the others.
+   Returns when every item has been processed. If threads cannot be
+   created, fewer workers (at least the calling thread) do the work. */
+
+void SymPar_run(size_t uItemCount, size_t uWorkerCount,
+    void (*pfWork)(size_t uStart, size_t uEnd, size_t uWorker,
+                   void *pvContext),
+    void *pvContext);
+
+/*--------------------------------------------------------------------*/
+#endif
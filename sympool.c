@@ -0,0 +1,217 @@
+/*--------------------------------------------------------------------*/
+/* sympool.c                                                          */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include "sympool.h"
+
+/*--------------------------------------------------------------------*/
+
+/* Block sizes are rounded up to a multiple of POOL_ALIGN bytes. Sizes
+   up to POOL_CLASS_COUNT * POOL_ALIGN bytes are served from slabs;
+   larger blocks are allocated individually. */
+enum {POOL_ALIGN = 16, POOL_CLASS_COUNT = 16};
+
+/* The first slab of a size class holds POOL_MIN_SLAB_BLOCKS blocks;
+   each later one twice as many, until a slab reaches
+   POOL_MAX_SLAB_SIZE bytes. Tables that stay small thus stay cheap. */
+enum {POOL_MIN_SLAB_BLOCKS = 8, POOL_MAX_SLAB_SIZE = 65536};
+
+/* The header of a slab, followed by its blocks. */
+struct Slab {
+    /* The address of the next slab of the pool. */
+    struct Slab *psNextSlab;
+    /* Padding that keeps the blocks aligned. */
+    void *pvUnused;
+};
+
+/* The header of an individually allocated (large) block, which links
+   it into the pool so that SymPool_free can find it. */
+struct LargeBlock {
+    /* The addresses of the previous and next large blocks. */
+    struct LargeBlock *psPrevBlock;
+    struct LargeBlock *psNextBlock;
+};
+
+/* Number of bytes reserved for the header of a large block:
+   sizeof(struct LargeBlock) rounded up to POOL_ALIGN. */
+enum {LARGE_HEADER_SIZE = POOL_ALIGN};
+
+/* A released block, linked into the free list of its size class. */
+struct FreeBlock {
+    /* The address of the next free block of the same size class. */
+    struct FreeBlock *psNextFree;
+};
+
+/* A SymPool structure: slabs, per-size-class free lists and the list
+   of large blocks. */
+struct SymPool {
+    /* Free list of each size class */
+    struct FreeBlock *apsFree[POOL_CLASS_COUNT];
+    /* Next never-used block of the newest slab of each size class */
+    char *apcNext[POOL_CLASS_COUNT];
+    /* End of the newest slab of each size class */
+    char *apcEnd[POOL_CLASS_COUNT];
+    /* Number of blocks in the next slab of each size class */
+    size_t auSlabBlocks[POOL_CLASS_COUNT];
+    /* All slabs of the pool */
+    struct Slab *psSlabs;
+    /* All large blocks of the pool */
+    struct LargeBlock *psLargeBlocks;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymPool_T SymPool_new(void)
+{
+    SymPool_T oPool;
+    int i;
+
+    oPool = (SymPool_T)malloc(sizeof(struct SymPool));
+    if (oPool == NULL)
+        return NULL;
+
+    for (i = 0; i < POOL_CLASS_COUNT; i++){
+        oPool->apsFree[i] = NULL;
+        oPool->apcNext[i] = NULL;
+        oPool->apcEnd[i] = NULL;
+        oPool->auSlabBlocks[i] = POOL_MIN_SLAB_BLOCKS;
+    }
+    oPool->psSlabs = NULL;
+    oPool->psLargeBlocks = NULL;
+    return oPool;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymPool_free(SymPool_T oPool)
+{
+    struct Slab *psSlab;
+    struct LargeBlock *psBlock;
+
+    assert(oPool != NULL);
+
+    psSlab = oPool->psSlabs;
+    while (psSlab != NULL){
+        struct Slab *psNext = psSlab->psNextSlab;
+        free(psSlab);
+        psSlab = psNext;
+    }
+    psBlock = oPool->psLargeBlocks;
+    while (psBlock != NULL){
+        struct LargeBlock *psNext = psBlock->psNextBlock;
+        free(psBlock);
+        psBlock = psNext;
+    }
+    free(oPool);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Allocate a block of more than POOL_CLASS_COUNT * POOL_ALIGN bytes,
+   uSize bytes, individually and link it into oPool. Return its
+   address, or NULL if insufficient memory is available. */
+
+static void *SymPool_allocLarge(SymPool_T oPool, size_t uSize)
+{
+    struct LargeBlock *psBlock;
+
+    assert(oPool != NULL);
+    assert(sizeof(struct LargeBlock) <= LARGE_HEADER_SIZE);
+
+    if (uSize > (size_t)-1 - LARGE_HEADER_SIZE)
+        return NULL;
+    psBlock = (struct LargeBlock*)malloc(LARGE_HEADER_SIZE + uSize);
+    if (psBlock == NULL)
+        return NULL;
+    psBlock->psPrevBlock = NULL;
+    psBlock->psNextBlock = oPool->psLargeBlocks;
+    if (oPool->psLargeBlocks != NULL)
+        oPool->psLargeBlocks->psPrevBlock = psBlock;
+    oPool->psLargeBlocks = psBlock;
+    return (char*)psBlock + LARGE_HEADER_SIZE;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a new slab for size class iClass to oPool. Return 1 (TRUE) if
+   successful, or 0 (FALSE) if insufficient memory is available. */
+
+static int SymPool_addSlab(SymPool_T oPool, int iClass)
+{
+    size_t uBlockSize = (size_t)(iClass + 1) * POOL_ALIGN;
+    size_t uBlocks = oPool->auSlabBlocks[iClass];
+    struct Slab *psSlab;
+
+    assert(oPool != NULL);
+
+    psSlab =
+        (struct Slab*)malloc(sizeof(struct Slab) + uBlocks * uBlockSize);
+    if (psSlab == NULL)
+        return 0;
+    psSlab->psNextSlab = oPool->psSlabs;
+    oPool->psSlabs = psSlab;
+    oPool->apcNext[iClass] = (char*)(psSlab + 1);
+    oPool->apcEnd[iClass] = oPool->apcNext[iClass] + uBlocks * uBlockSize;
+
+    if (2 * uBlocks * uBlockSize <= POOL_MAX_SLAB_SIZE)
+        oPool->auSlabBlocks[iClass] = 2 * uBlocks;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymPool_alloc(SymPool_T oPool, size_t uSize)
+{
+    int iClass;
+    void *pvBlock;
+
+    assert(oPool != NULL);
+
+    if (uSize > POOL_CLASS_COUNT * POOL_ALIGN)
+        return SymPool_allocLarge(oPool, uSize);
+    iClass = uSize == 0 ? 0 : (int)((uSize - 1) / POOL_ALIGN);
+
+    /* reuse a released block if possible */
+    if (oPool->apsFree[iClass] != NULL){
+        struct FreeBlock *psBlock = oPool->apsFree[iClass];
+        oPool->apsFree[iClass] = psBlock->psNextFree;
+        return psBlock;
+    }
+
+    /* otherwise carve the next block out of the newest slab */
+    if (oPool->apcNext[iClass] == oPool->apcEnd[iClass] &&
+        !SymPool_addSlab(oPool, iClass))
+        return NULL;
+    pvBlock = oPool->apcNext[iClass];
+    oPool->apcNext[iClass] += (size_t)(iClass + 1) * POOL_ALIGN;
+    return pvBlock;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymPool_release(SymPool_T oPool, void *pv, size_t uSize)
+{
+    int iClass;
+
+    assert(oPool != NULL);
+    assert(pv != NULL);
+
+    if (uSize > POOL_CLASS_COUNT * POOL_ALIGN){
+        struct LargeBlock *psBlock =
+            (struct LargeBlock*)((char*)pv - LARGE_HEADER_SIZE);
+        if (psBlock->psPrevBlock != NULL)
+            psBlock->psPrevBlock->psNextBlock = psBlock->psNextBlock;
+        else oPool->psLargeBlocks = psBlock->psNextBlock;
+        if (psBlock->psNextBlock != NULL)
+            psBlock->psNextBlock->psPrevBlock = psBlock->psPrevBlock;
+        free(psBlock);
+        return;
+    }
+
+    iClass = uSize == 0 ? 0 : (int)((uSize - 1) / POOL_ALIGN);
+    ((struct FreeBlock*)pv)->psNextFree = oPool->apsFree[iClass];
+    oPool->apsFree[iClass] = (struct FreeBlock*)pv;
+}
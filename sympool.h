@@ -0,0 +1,50 @@
+/*--------------------------------------------------------------------*/
+/* sympool.h                                                          */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMPOOL_INCLUDED
+#define SYMPOOL_INCLUDED
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+
+/*--------------------------------------------------------------------*/
+
+/* A pool is a private allocator for the nodes of one SymTable object.
+   Small blocks are carved out of slabs and recycled through per-size
+   free lists, so that puts and removes rarely call malloc or free,
+   and all blocks are released at once when the pool is freed. */
+
+typedef struct SymPool *SymPool_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Returns a new SymPool object that holds no blocks, or NULL if
+   insufficient memory */
+
+SymPool_T SymPool_new(void);
+
+/*--------------------------------------------------------------------*/
+
+/* Frees oPool together with every block allocated from it. */
+
+void SymPool_free(SymPool_T oPool);
+
+/*--------------------------------------------------------------------*/
+
+/* Returns the address of a block of at least uSize bytes from oPool,
+   aligned for pointers and size_t values, or NULL if insufficient
+   memory. */
+
+void *SymPool_alloc(SymPool_T oPool, size_t uSize);
+
+/*--------------------------------------------------------------------*/
+
+/* Returns the block pv, which was allocated from oPool with size
+   uSize, to oPool for reuse. */
+
+void SymPool_release(SymPool_T oPool, void *pv, size_t uSize);
+
+/*--------------------------------------------------------------------*/
+#endif
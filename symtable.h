@@ -24,12 +24,72 @@ SymTable_T SymTable_new(void);
 
 /*--------------------------------------------------------------------*/
 
+/* Hash functions that a SymTable object may use for its keys. 
+   Implementations that do not hash keys accept and ignore them. */
+
+enum SymTable_HashFunction {
+    /* The multiplicative hash (multiplier 65599) of the assignment
+       specification, one character at a time. Used by SymTable_new. */
+    SYMTABLE_HASH_MULTIPLICATIVE,
+    /* A word-at-a-time hash in the style of wyhash: much faster on 
+       long keys, and well distributed in every bit even for similar
+       keys such as sequential numbers. */
+    SYMTABLE_HASH_WIDE
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Returns a new SymTable object that contains no bindings and hashes 
+   its keys with eHash, or NULL if insufficient memory */
+
+SymTable_T SymTable_newWithHash(enum SymTable_HashFunction eHash);
+
+/*--------------------------------------------------------------------*/
+
+/* Returns a new SymTable object that contains no bindings, as
+   SymTable_new does, but already has room for uCapacity bindings, or
+   NULL if insufficient memory. See SymTable_reserve. */
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity);
+
+/*--------------------------------------------------------------------*/
+
+/* Gives oSymTable room for uCapacity bindings in all, so that putting
+   bindings into it until it holds that many does not resize it (a
+   bulk load thus allocates its buckets, or slots, once rather than at
+   every doubling), and removing bindings does not shrink it below
+   that room until SymTable_compact. Returns 1 (TRUE) if successful,
+   or 0 (FALSE) if insufficient memory is available, in which case
+   oSymTable is unchanged. */
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity);
+
+/*--------------------------------------------------------------------*/
+
 /* Frees all memory occupied by oSymTable. */
 
 void SymTable_free(SymTable_T oSymTable);
 
 /*--------------------------------------------------------------------*/
 
+/* Reorganizes oSymTable for the bindings it now holds: shrinks its 
+   buckets (or slots) to the number a table built by putting those 
+   bindings would have and, where the implementation can, moves the
+   bindings next to each other in memory, in the order that lookups
+   and traversals visit them, giving back the memory that removed 
+   bindings left behind. Any room reserved by SymTable_reserve or
+   SymTable_newWithCapacity is given back as well. Addresses returned
+   by SymTable_getOrInsert, and keys passed by SymTable_map and 
+   SymTable_mapParallel or returned by SymTable_iterNext, before the
+   call are not valid after it. Returns 1 (TRUE) if successful, or 0
+   (FALSE) if insufficient memory is available, in which case 
+   oSymTable holds the same bindings but may be only partly 
+   reorganized. */
+
+int SymTable_compact(SymTable_T oSymTable);
+
+/*--------------------------------------------------------------------*/
+
 /* Returns the number of bindings in oSymTable. */
 
 size_t SymTable_getLength(SymTable_T oSymTable);
@@ -55,6 +115,31 @@ void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
 
 /*--------------------------------------------------------------------*/
 
+/* Makes pvValue the value of the binding of oSymTable whose key is 
+   pcKey, adding such a binding if oSymTable contains none, and returns
+   1 (TRUE). If insufficient memory is available, then the function
+   leaves oSymTable unchanged and returns 0 (FALSE). Unlike 
+   SymTable_contains followed by SymTable_put or SymTable_replace, it
+   searches oSymTable only once. */
+
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey,
+    const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Returns the address of the value of the binding of oSymTable whose 
+   key is pcKey, first adding a binding of pcKey with value pvValue if
+   oSymTable contains none, searching oSymTable only once. The caller
+   may read or store the value through the address until the next 
+   call that adds or removes a binding of oSymTable. If insufficient
+   memory is available, then the function leaves oSymTable unchanged
+   and returns NULL. */
+
+void **SymTable_getOrInsert(SymTable_T oSymTable, const char *pcKey,
+    const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
 /* Returns 1 (TRUE) if oSymTable contains a binding whose key is pcKey, 
    and 0 (FALSE) otherwise. */ 
 
@@ -75,13 +160,178 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey);
    
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey);
 
+/*--------------------------------------------------------------------*/
+
+/* The functions below behave like SymTable_put, SymTable_contains, 
+   SymTable_get and SymTable_remove, but take the key as the uLength 
+   characters starting at pcKey, which need not be followed by '\0' 
+   (so that a caller holding a slice of a larger buffer does not have
+   to copy it). The key must not contain '\0'. Keys put with 
+   SymTable_putN are seen by every function, terminated, as usual. */
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey, 
+    size_t uLength, const void *pvValue);
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength);
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey, 
+    size_t uLength);
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Number of hash functions in enum SymTable_HashFunction. */
+
+enum {SYMTABLE_HASH_COUNT = 2};
+
+/* A key handle: a key together with its hash codes, computed the first
+   time a SymTable object that needs them is given the handle and 
+   reused afterwards. Looking up one key in several SymTable objects 
+   through a handle thus hashes the key once per hash function rather
+   than once per table. The fields are private to the implementation;
+   initialize a handle with SymTable_initKey. */
+
+typedef struct SymTable_Key {
+    /* The key: the uLength characters starting at pcKey */
+    const char *pcKey;
+    size_t uLength;
+    /* auHash[e] is the hash code computed with hash function e, valid
+       if bit e of uHashMask is set */
+    size_t auHash[SYMTABLE_HASH_COUNT];
+    unsigned uHashMask;
+} SymTable_Key;
+
+/*--------------------------------------------------------------------*/
+
+/* Initializes *psKey as a handle for the key made of the uLength 
+   characters starting at pcKey, which need not be followed by '\0'
+   and must not contain it. The handle refers to pcKey without copying
+   it, so the characters must not change while the handle is used. */
+
+void SymTable_initKey(SymTable_Key *psKey, const char *pcKey,
+    size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* The functions below behave like SymTable_put, SymTable_replace, 
+   SymTable_contains, SymTable_get and SymTable_remove, but take the
+   key as the handle *psKey, whose cached hash codes they may fill 
+   in. */
+
+int SymTable_putKey(SymTable_T oSymTable, SymTable_Key *psKey,
+    const void *pvValue);
+
+void *SymTable_replaceKey(SymTable_T oSymTable, SymTable_Key *psKey,
+    const void *pvValue);
+
+int SymTable_containsKey(SymTable_T oSymTable, SymTable_Key *psKey);
+
+void *SymTable_getKey(SymTable_T oSymTable, SymTable_Key *psKey);
+
+void *SymTable_removeKey(SymTable_T oSymTable, SymTable_Key *psKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Stores in apvValues[i], for each i from 0 to uCount-1, the value of
+   the binding within oSymTable whose key is apcKeys[i], or NULL if no
+   such binding exists: the result of SymTable_get. Looking up many 
+   keys at once lets an implementation overlap the memory accesses of
+   different lookups. */
+
+void SymTable_getBatch(SymTable_T oSymTable, const char *const apcKeys[],
+    size_t uCount, void *apvValues[]);
+
+/*--------------------------------------------------------------------*/
+
+/* Puts the bindings of key apcKeys[i] and value apvValues[i], for each
+   i from 0 to uCount-1 in order, into oSymTable as SymTable_put does, 
+   and returns the number of bindings added. A key that oSymTable 
+   already contains (including one added earlier in the batch), or 
+   whose binding cannot be allocated, is skipped. */
+
+size_t SymTable_putBatch(SymTable_T oSymTable, 
+    const char *const apcKeys[], size_t uCount, 
+    const void *const apvValues[]);
+
 /*--------------------------------------------------------------------*/
 /* Applies function *pfApply to each binding (key-value pair) in 
-   oSymTable, passing pvExtra as an extra parameter. */
+   oSymTable, passing pvExtra as an extra parameter. The key passed to
+   pfApply stays valid, at the same address, until its binding is 
+   removed or oSymTable is compacted or freed, whatever other bindings
+   are put or removed meanwhile. */
 
 void SymTable_map(SymTable_T oSymTable,
     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
     const void *pvExtra);
 
+/*--------------------------------------------------------------------*/
+/* Applies function *pfApply to each binding in oSymTable, as
+   SymTable_map does, but from up to uThreadCount threads at once,
+   which share the bindings out among themselves as they go (a thread
+   that runs out takes some from another). pfApply may thus be called
+   concurrently and in any order, and must not update oSymTable. Its
+   pvSlot parameter is apvSlots[i], where i, from 0 to uThreadCount-1,
+   identifies the thread that calls it, so that pfApply can accumulate
+   results per thread without synchronization, to be combined once
+   SymTable_mapParallel returns; pvSlot is NULL if apvSlots is NULL.
+   If threads or memory are unavailable, fewer threads do the work. */
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot),
+    const void *pvExtra, size_t uThreadCount, void *const apvSlots[]);
+
+/*--------------------------------------------------------------------*/
+
+/* A traversal of the bindings of a SymTable object, which the caller
+   declares (typically as a local variable), starts with
+   SymTable_iterBegin, advances with SymTable_iterNext for as long as
+   it likes, and ends with SymTable_iterEnd. Unlike SymTable_map, the
+   caller's loop body runs in place (no call through a function
+   pointer), and the traversal may stop at any binding or be resumed
+   later. The fields are private to the implementation. */
+
+typedef struct SymTable_Iter {
+    /* The table being traversed */
+    SymTable_T oSymTable;
+    /* Where the traversal stands: the part of the table (such as a
+       shard) and the bucket or slot within it from which the search 
+       for the next binding resumes */
+    size_t uPart;
+    size_t uIndex;
+    /* The next binding to return, if already known, or NULL */
+    void *pvNext;
+} SymTable_Iter;
+
+/*--------------------------------------------------------------------*/
+
+/* Starts a traversal *psIter of the bindings of oSymTable. Until 
+   SymTable_iterEnd(psIter), oSymTable must not be updated. */
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter);
+
+/*--------------------------------------------------------------------*/
+
+/* If the traversal *psIter has not yet visited every binding of its
+   table, stores the key and value of the next binding in *ppcKey and
+   *ppvValue (unless they are NULL) and returns 1 (TRUE). Otherwise 
+   returns 0 (FALSE). Each binding is visited once, in no particular
+   order. The key stored in *ppcKey stays valid, as those passed by
+   SymTable_map do, until its binding is removed or the table is
+   compacted or freed, even after the traversal ends. */
+
+int SymTable_iterNext(SymTable_Iter *psIter, const char **ppcKey,
+    void **ppvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Ends the traversal *psIter, whether or not it has visited every 
+   binding, releasing anything that SymTable_iterBegin acquired. */
+
+void SymTable_iterEnd(SymTable_Iter *psIter);
+
 /*--------------------------------------------------------------------*/
 #endif
\ No newline at end of file
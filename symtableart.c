@@ -0,0 +1,1624 @@
+/*--------------------------------------------------------------------*/
+/* symtableart.c                                                      */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symtableordered.h"
+#include "sympar.h"
+#include "sympool.h"
+
+/*--------------------------------------------------------------------*/
+
+/* The table is an adaptive radix tree: a trie whose inner nodes branch
+   on one character of the key each, and come in four sizes (for up to
+   4, 16, 48 or 256 children) so that a node is only as large as its
+   number of children requires. A run of characters that every key
+   below a node shares is stored once, as the prefix of the node,
+   rather than as a chain of nodes with a single child each; keys with
+   a long common namespace thus cost a node for the namespace, not a
+   copy of it per key. The bindings hang below the inner nodes as
+   leaves. A lookup follows the characters of its key down the tree,
+   without hashing it, and the tree keeps the keys in the order of
+   strcmp. A key is taken to end with a '\0', which it contains
+   nowhere else, so that a key that is a prefix of others hangs, under
+   '\0', below the node at which they branch. */
+
+/* Number of the characters of the prefix of an inner node that the
+   node itself holds (so that the header of a node is 24 bytes, and a
+   Node4 64, on LP64 machines). A search skips the characters of a
+   longer prefix without comparing them, and compares the whole key
+   with the leaf it reaches; an insertion, which needs to know where a
+   new key leaves the prefix, reads them from a leaf below the node. */
+enum {PREFIX_SIZE = 13};
+
+/* The types of inner nodes, by their largest number of children */
+enum NodeType {NODE4, NODE16, NODE48, NODE256};
+
+/* Each key-value pair is stored in a Binding, a leaf of the tree. The
+   key is stored at the end of the Binding itself, so a binding is a
+   single allocation. The whole key is kept, although the nodes above
+   the leaf already spell out all but its last characters: symtable.h
+   promises that the key passed by SymTable_map or returned by
+   SymTable_iterNext stays at its address until the binding is 
+   removed, which a key rebuilt in a buffer would not. */
+struct Binding {
+    /* The value. */
+    void *value;
+    /* The key (a defensive copy of the client's key). */
+    char key[];
+};
+
+/* The header with which every inner node begins. A child of an inner
+   node is either another inner node or, with its lowest address bit
+   set (see SymTable_isLeaf), a Binding. */
+struct Node {
+    /* Number of characters that the keys below the node share from
+       the depth of the node (the number of characters above it) on */
+    size_t prefixLength;
+    /* Number of children */
+    unsigned short count;
+    /* The type of the node: an enum NodeType */
+    unsigned char type;
+    /* The first PREFIX_SIZE (at most) of those characters */
+    unsigned char prefix[PREFIX_SIZE];
+};
+
+/* An inner node with up to 4 children: the characters on which they
+   branch, sorted, in aucKeys, and the child for aucKeys[i] in
+   apvChildren[i]. */
+struct Node4 {
+    struct Node sHeader;
+    unsigned char aucKeys[4];
+    void *apvChildren[4];
+};
+
+/* An inner node with up to 16 children, laid out as a Node4. */
+struct Node16 {
+    struct Node sHeader;
+    unsigned char aucKeys[16];
+    void *apvChildren[16];
+};
+
+/* An inner node with up to 48 children: aucIndex[c] is 0 if no child
+   branches on character c, or else one more than the index of its
+   child in apvChildren. */
+struct Node48 {
+    struct Node sHeader;
+    unsigned char aucIndex[256];
+    void *apvChildren[48];
+};
+
+/* An inner node with up to 256 children: the child for character c,
+   or NULL, in apvChildren[c]. */
+struct Node256 {
+    struct Node sHeader;
+    void *apvChildren[256];
+};
+
+/* A SymTable structure symbol table implemented as an adaptive radix
+   tree. */
+struct SymTable {
+    /* The root: NULL if the table is empty, or else a child */
+    void *pvRoot;
+    /* The size (number of bindings) in SymTable */
+    size_t size;
+    /* Allocator of the nodes and Bindings of this SymTable */
+    SymPool_T pool;
+};
+
+/* Size and largest number of children of each type of inner node */
+static const size_t auNodeSizes[] = {sizeof(struct Node4),
+    sizeof(struct Node16), sizeof(struct Node48), sizeof(struct Node256)};
+static const size_t auNodeCapacities[] = {4, 16, 48, 256};
+
+/* Number of children at which a node of each type is replaced by one
+   of the next smaller type: a few fewer than that type holds, so that
+   a node whose count goes back and forth around the capacity of the
+   smaller type is not copied every time. A Node4 is replaced by its
+   child when it has only one. */
+static const size_t auShrinkCounts[] = {1, 3, 12, 40};
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if the child pvChild is a Binding, or 0 (FALSE) if
+   it is an inner node. */
+
+static int SymTable_isLeaf(const void *pvChild)
+{
+    assert(pvChild != NULL);
+
+    return ((size_t)pvChild & 1) != 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the child that stands for psBinding in its parent. */
+
+static void *SymTable_leafChild(struct Binding *psBinding)
+{
+    assert(psBinding != NULL);
+
+    return (char*)psBinding + 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the Binding that the child pvChild, a leaf, stands for. */
+
+static struct Binding *SymTable_leafOf(void *pvChild)
+{
+    assert(SymTable_isLeaf(pvChild));
+
+    return (struct Binding*)((char*)pvChild - 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return character uDepth of the key made of the uLength characters
+   starting at pcKey, as an unsigned char: '\0' from uDepth == uLength
+   on. */
+
+static unsigned char SymTable_keyAt(const char *pcKey, size_t uLength,
+                                    size_t uDepth)
+{
+    assert(pcKey != NULL);
+
+    return uDepth < uLength ? (unsigned char)pcKey[uDepth] : 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if the key of psBinding is the uLength characters
+   starting at pcKey, or 0 (FALSE) otherwise. */
+
+static int SymTable_matches(const struct Binding *psBinding,
+                            const char *pcKey, size_t uLength)
+{
+    assert(psBinding != NULL);
+    assert(pcKey != NULL);
+
+    /* strncmp stops at the end of a shorter key of psBinding, so the
+       last character is read only once the others matched */
+    return strncmp(psBinding->key, pcKey, uLength) == 0 &&
+        psBinding->key[uLength] == '\0';
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the child of psNode for character c, or NULL
+   if it has none. */
+
+static void **SymTable_findChild(struct Node *psNode, unsigned char c)
+{
+    unsigned char *aucKeys;
+    void **apvChildren;
+    size_t i;
+
+    assert(psNode != NULL);
+
+    if (psNode->type == NODE48){
+        struct Node48 *psNode48 = (struct Node48*)psNode;
+        i = psNode48->aucIndex[c];
+        return i == 0 ? NULL : &psNode48->apvChildren[i - 1];
+    }
+    if (psNode->type == NODE256){
+        struct Node256 *psNode256 = (struct Node256*)psNode;
+        return psNode256->apvChildren[c] == NULL ? NULL :
+            &psNode256->apvChildren[c];
+    }
+
+    if (psNode->type == NODE4){
+        aucKeys = ((struct Node4*)psNode)->aucKeys;
+        apvChildren = ((struct Node4*)psNode)->apvChildren;
+    }
+    else {
+        aucKeys = ((struct Node16*)psNode)->aucKeys;
+        apvChildren = ((struct Node16*)psNode)->apvChildren;
+    }
+    /* the characters are sorted, so the search stops at the first
+       that is not smaller */
+    for (i = 0; i < psNode->count && aucKeys[i] <= c; i++)
+        if (aucKeys[i] == c)
+            return &apvChildren[i];
+    return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the first child of psNode, in order of the characters on
+   which the children branch, from position *puPos on, and store its
+   character in *pc and the position after it in *puPos. Return NULL
+   if there is none. Positions are indexes into the children of a
+   Node4 or Node16, and characters for the other types; position 0
+   is thus the first child of any node. */
+
+static void *SymTable_nextChild(struct Node *psNode, size_t *puPos,
+                                unsigned char *pc)
+{
+    size_t u;
+
+    assert(psNode != NULL);
+    assert(puPos != NULL);
+    assert(pc != NULL);
+
+    u = *puPos;
+    if (psNode->type == NODE4 || psNode->type == NODE16){
+        if (u >= psNode->count)
+            return NULL;
+        *puPos = u + 1;
+        if (psNode->type == NODE4){
+            *pc = ((struct Node4*)psNode)->aucKeys[u];
+            return ((struct Node4*)psNode)->apvChildren[u];
+        }
+        *pc = ((struct Node16*)psNode)->aucKeys[u];
+        return ((struct Node16*)psNode)->apvChildren[u];
+    }
+
+    if (psNode->type == NODE48){
+        struct Node48 *psNode48 = (struct Node48*)psNode;
+        for (; u < 256; u++)
+            if (psNode48->aucIndex[u] != 0){
+                *pc = (unsigned char)u;
+                *puPos = u + 1;
+                return psNode48->apvChildren[psNode48->aucIndex[u] - 1];
+            }
+    }
+    else {
+        struct Node256 *psNode256 = (struct Node256*)psNode;
+        for (; u < 256; u++)
+            if (psNode256->apvChildren[u] != NULL){
+                *pc = (unsigned char)u;
+                *puPos = u + 1;
+                return psNode256->apvChildren[u];
+            }
+    }
+    *puPos = u;
+    return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the child of psNode for the smallest character greater than
+   c, or NULL if it has none. */
+
+static void *SymTable_childAfter(struct Node *psNode, unsigned char c)
+{
+    void *pvChild;
+    size_t uPos;
+    unsigned char cChild;
+
+    assert(psNode != NULL);
+
+    /* the position of a character is the character itself in the
+       larger types, whose children need not then be scanned from the
+       first */
+    uPos = psNode->type >= NODE48 ? (size_t)c + 1 : 0;
+    do
+        pvChild = SymTable_nextChild(psNode, &uPos, &cChild);
+    while (pvChild != NULL && cChild <= c);
+    return pvChild;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the Binding with the smallest key below pvChild. */
+
+static struct Binding *SymTable_minimum(void *pvChild)
+{
+    size_t uPos;
+    unsigned char c;
+
+    assert(pvChild != NULL);
+
+    /* an inner node has at least two children */
+    while (!SymTable_isLeaf(pvChild)){
+        uPos = 0;
+        pvChild = SymTable_nextChild((struct Node*)pvChild, &uPos, &c);
+    }
+    return SymTable_leafOf(pvChild);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new inner node of type eType, with no prefix and no
+   children, allocated from oPool, or NULL if insufficient memory. */
+
+static struct Node *SymTable_newNode(SymPool_T oPool,
+                                     enum NodeType eType)
+{
+    struct Node *psNode;
+
+    assert(oPool != NULL);
+
+    psNode = (struct Node*)SymPool_alloc(oPool, auNodeSizes[eType]);
+    if (psNode == NULL)
+        return NULL;
+    memset(psNode, 0, auNodeSizes[eType]);
+    psNode->type = (unsigned char)eType;
+    return psNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Release psNode, allocated by SymTable_newNode for oSymTable, but
+   not its children. */
+
+static void SymTable_freeNode(SymTable_T oSymTable, struct Node *psNode)
+{
+    assert(oSymTable != NULL);
+    assert(psNode != NULL);
+
+    SymPool_release(oSymTable->pool, psNode, auNodeSizes[psNode->type]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Allocate a Binding for oSymTable with key the uLength characters
+   starting at pcKey and value pvValue. Return its address, or NULL if
+   insufficient memory. */
+
+static struct Binding *SymTable_newBinding(SymTable_T oSymTable,
+                                           const char *pcKey,
+                                           size_t uLength,
+                                           const void *pvValue)
+{
+    struct Binding *psBinding;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    psBinding = (struct Binding*)SymPool_alloc(oSymTable->pool,
+        sizeof(struct Binding) + uLength + 1);
+    if (psBinding == NULL)
+        return NULL;
+    memcpy(psBinding->key, pcKey, uLength);
+    psBinding->key[uLength] = '\0';
+    psBinding->value = (void*)pvValue;
+    return psBinding;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Release psBinding, whose key is uLength characters long, allocated
+   by SymTable_newBinding for oSymTable. */
+
+static void SymTable_freeBinding(SymTable_T oSymTable,
+                                 struct Binding *psBinding,
+                                 size_t uLength)
+{
+    assert(oSymTable != NULL);
+    assert(psBinding != NULL);
+
+    SymPool_release(oSymTable->pool, psBinding,
+                    sizeof(struct Binding) + uLength + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make pvChild the child of psNode for character c. psNode must have
+   room for it, and no child for c. */
+
+static void SymTable_addChild(struct Node *psNode, unsigned char c,
+                              void *pvChild)
+{
+    unsigned char *aucKeys;
+    void **apvChildren;
+    size_t i;
+
+    assert(psNode != NULL);
+    assert(pvChild != NULL);
+    assert(psNode->count < auNodeCapacities[psNode->type]);
+
+    if (psNode->type == NODE4 || psNode->type == NODE16){
+        if (psNode->type == NODE4){
+            aucKeys = ((struct Node4*)psNode)->aucKeys;
+            apvChildren = ((struct Node4*)psNode)->apvChildren;
+        }
+        else {
+            aucKeys = ((struct Node16*)psNode)->aucKeys;
+            apvChildren = ((struct Node16*)psNode)->apvChildren;
+        }
+        /* the children for greater characters move up one */
+        for (i = psNode->count; i > 0 && aucKeys[i - 1] > c; i--){
+            aucKeys[i] = aucKeys[i - 1];
+            apvChildren[i] = apvChildren[i - 1];
+        }
+        aucKeys[i] = c;
+        apvChildren[i] = pvChild;
+    }
+    else if (psNode->type == NODE48){
+        struct Node48 *psNode48 = (struct Node48*)psNode;
+        /* removes may have left a free slot anywhere */
+        for (i = 0; psNode48->apvChildren[i] != NULL; i++)
+            ;
+        psNode48->apvChildren[i] = pvChild;
+        psNode48->aucIndex[c] = (unsigned char)(i + 1);
+    }
+    else ((struct Node256*)psNode)->apvChildren[c] = pvChild;
+    psNode->count++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a copy of psNode of type eType, which must hold its
+   children, with the same prefix and children, allocated for
+   oSymTable, or NULL if insufficient memory. psNode is unchanged. */
+
+static struct Node *SymTable_resize(SymTable_T oSymTable,
+                                    struct Node *psNode,
+                                    enum NodeType eType)
+{
+    struct Node *psCopy;
+    void *pvChild;
+    size_t uPos = 0;
+    unsigned char c;
+
+    assert(oSymTable != NULL);
+    assert(psNode != NULL);
+    assert(psNode->count <= auNodeCapacities[eType]);
+
+    psCopy = SymTable_newNode(oSymTable->pool, eType);
+    if (psCopy == NULL)
+        return NULL;
+    psCopy->prefixLength = psNode->prefixLength;
+    memcpy(psCopy->prefix, psNode->prefix, PREFIX_SIZE);
+    while ((pvChild = SymTable_nextChild(psNode, &uPos, &c)) != NULL)
+        SymTable_addChild(psCopy, c, pvChild);
+    return psCopy;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make pvChild the child for character c of the inner node at
+   *ppvSlot of oSymTable, which has no child for c, first replacing
+   the node by one of the next larger type if it is full. Return 1
+   (TRUE) if successful, or 0 (FALSE) if insufficient memory is
+   available, in which case the node is unchanged. */
+
+static int SymTable_insertChild(SymTable_T oSymTable, void **ppvSlot,
+                                unsigned char c, void *pvChild)
+{
+    struct Node *psNode;
+    struct Node *psLarger;
+
+    assert(oSymTable != NULL);
+    assert(ppvSlot != NULL);
+
+    psNode = (struct Node*)*ppvSlot;
+    if (psNode->count == auNodeCapacities[psNode->type]){
+        psLarger = SymTable_resize(oSymTable, psNode,
+                                   (enum NodeType)(psNode->type + 1));
+        if (psLarger == NULL)
+            return 0;
+        SymTable_freeNode(oSymTable, psNode);
+        *ppvSlot = psNode = psLarger;
+    }
+    SymTable_addChild(psNode, c, pvChild);
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Replace the Node4 at *ppvSlot of oSymTable, which has a single
+   child left, by that child. An inner child takes over the prefix of
+   the node and the character on which it branched, ahead of its own
+   prefix. */
+
+static void SymTable_collapse(SymTable_T oSymTable, void **ppvSlot)
+{
+    struct Node4 *psNode4;
+    void *pvChild;
+    unsigned char aucPrefix[PREFIX_SIZE];
+    size_t uLength;
+    size_t uCopied;
+
+    assert(oSymTable != NULL);
+    assert(ppvSlot != NULL);
+
+    psNode4 = (struct Node4*)*ppvSlot;
+    assert(psNode4->sHeader.type == NODE4);
+    assert(psNode4->sHeader.count == 1);
+
+    pvChild = psNode4->apvChildren[0];
+    if (!SymTable_isLeaf(pvChild)){
+        struct Node *psChild = (struct Node*)pvChild;
+        uLength = psNode4->sHeader.prefixLength < PREFIX_SIZE ?
+            psNode4->sHeader.prefixLength : PREFIX_SIZE;
+        memcpy(aucPrefix, psNode4->sHeader.prefix, uLength);
+        if (uLength < PREFIX_SIZE)
+            aucPrefix[uLength++] = psNode4->aucKeys[0];
+        uCopied = psChild->prefixLength < PREFIX_SIZE - uLength ?
+            psChild->prefixLength : PREFIX_SIZE - uLength;
+        memcpy(aucPrefix + uLength, psChild->prefix, uCopied);
+        memcpy(psChild->prefix, aucPrefix, uLength + uCopied);
+        psChild->prefixLength += psNode4->sHeader.prefixLength + 1;
+    }
+    *ppvSlot = pvChild;
+    SymTable_freeNode(oSymTable, &psNode4->sHeader);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the child for character c from the inner node at *ppvSlot of
+   oSymTable, then replace the node by one of the next smaller type if
+   it has become sparse enough, or by its child if it has only one. */
+
+static void SymTable_deleteChild(SymTable_T oSymTable, void **ppvSlot,
+                                 unsigned char c)
+{
+    struct Node *psNode;
+    struct Node *psSmaller;
+    unsigned char *aucKeys;
+    void **apvChildren;
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(ppvSlot != NULL);
+
+    psNode = (struct Node*)*ppvSlot;
+    if (psNode->type == NODE4 || psNode->type == NODE16){
+        if (psNode->type == NODE4){
+            aucKeys = ((struct Node4*)psNode)->aucKeys;
+            apvChildren = ((struct Node4*)psNode)->apvChildren;
+        }
+        else {
+            aucKeys = ((struct Node16*)psNode)->aucKeys;
+            apvChildren = ((struct Node16*)psNode)->apvChildren;
+        }
+        for (i = 0; aucKeys[i] != c; i++)
+            assert(i + 1 < psNode->count);
+        memmove(&aucKeys[i], &aucKeys[i + 1], psNode->count - i - 1);
+        memmove(&apvChildren[i], &apvChildren[i + 1],
+                (psNode->count - i - 1) * sizeof(void *));
+    }
+    else if (psNode->type == NODE48){
+        struct Node48 *psNode48 = (struct Node48*)psNode;
+        assert(psNode48->aucIndex[c] != 0);
+        psNode48->apvChildren[psNode48->aucIndex[c] - 1] = NULL;
+        psNode48->aucIndex[c] = 0;
+    }
+    else ((struct Node256*)psNode)->apvChildren[c] = NULL;
+    psNode->count--;
+
+    if (psNode->count > auShrinkCounts[psNode->type])
+        return;
+    if (psNode->type == NODE4){
+        SymTable_collapse(oSymTable, ppvSlot);
+        return;
+    }
+    /* if the smaller node cannot be allocated, the larger one serves
+       as well */
+    psSmaller = SymTable_resize(oSymTable, psNode,
+                                (enum NodeType)(psNode->type - 1));
+    if (psSmaller != NULL){
+        SymTable_freeNode(oSymTable, psNode);
+        *ppvSlot = psSmaller;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if the characters of the prefix of psNode, at depth
+   uDepth, that psNode holds match those of the key made of the
+   uLength characters starting at pcKey, or 0 (FALSE) otherwise. The
+   rest of a longer prefix is not compared. */
+
+static int SymTable_prefixMatches(const struct Node *psNode,
+                                  const char *pcKey, size_t uLength,
+                                  size_t uDepth)
+{
+    size_t i;
+
+    assert(psNode != NULL);
+    assert(pcKey != NULL);
+
+    for (i = 0; i < psNode->prefixLength && i < PREFIX_SIZE; i++)
+        if (psNode->prefix[i] != SymTable_keyAt(pcKey, uLength, uDepth + i))
+            return 0;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of characters of the prefix of psNode, at depth
+   uDepth, that the key made of the uLength characters starting at
+   pcKey matches before the first that differs: the length of the
+   prefix if they all match. */
+
+static size_t SymTable_prefixMismatch(struct Node *psNode,
+                                      const char *pcKey, size_t uLength,
+                                      size_t uDepth)
+{
+    const struct Binding *psMinimum;
+    size_t i;
+
+    assert(psNode != NULL);
+    assert(pcKey != NULL);
+
+    for (i = 0; i < psNode->prefixLength && i < PREFIX_SIZE; i++)
+        if (psNode->prefix[i] != SymTable_keyAt(pcKey, uLength, uDepth + i))
+            return i;
+    if (i == psNode->prefixLength)
+        return i;
+
+    /* the rest of the prefix is in the key of any leaf below */
+    psMinimum = SymTable_minimum(psNode);
+    for (; i < psNode->prefixLength; i++)
+        if ((unsigned char)psMinimum->key[uDepth + i] !=
+            SymTable_keyAt(pcKey, uLength, uDepth + i))
+            return i;
+    return i;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the Binding of oSymTable whose key is the uLength characters
+   starting at pcKey, or NULL if there is none. */
+
+static struct Binding *SymTable_find(SymTable_T oSymTable,
+                                     const char *pcKey, size_t uLength)
+{
+    void *pvChild;
+    void **ppvChild;
+    size_t uDepth = 0;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    pvChild = oSymTable->pvRoot;
+    if (pvChild == NULL)
+        return NULL;
+    while (!SymTable_isLeaf(pvChild)){
+        struct Node *psNode = (struct Node*)pvChild;
+        if (!SymTable_prefixMatches(psNode, pcKey, uLength, uDepth))
+            return NULL;
+        uDepth += psNode->prefixLength;
+        ppvChild = SymTable_findChild(psNode,
+            SymTable_keyAt(pcKey, uLength, uDepth));
+        if (ppvChild == NULL)
+            return NULL;
+        pvChild = *ppvChild;
+        uDepth++;
+    }
+    /* the characters of prefixes that were skipped are compared
+       here */
+    if (!SymTable_matches(SymTable_leafOf(pvChild), pcKey, uLength))
+        return NULL;
+    return SymTable_leafOf(pvChild);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Replace the child at *ppvSlot of oSymTable, at depth uDepth, whose
+   keys have their next uCommon characters in common with the key made
+   of the uLength characters starting at pcKey and then continue with
+   character cOld, by a new Node4 with those characters as its prefix
+   and two children: the replaced child, for cOld, and a new Binding
+   of the key and pvValue. Return the new Binding, or NULL if
+   insufficient memory, in which case oSymTable is unchanged. */
+
+static struct Binding *SymTable_branch(SymTable_T oSymTable,
+                                       void **ppvSlot, size_t uDepth,
+                                       size_t uCommon,
+                                       unsigned char cOld,
+                                       const char *pcKey, size_t uLength,
+                                       const void *pvValue)
+{
+    struct Node *psNode;
+    struct Binding *psBinding;
+
+    assert(oSymTable != NULL);
+    assert(ppvSlot != NULL);
+    assert(uDepth + uCommon <= uLength);
+
+    psNode = SymTable_newNode(oSymTable->pool, NODE4);
+    if (psNode == NULL)
+        return NULL;
+    psBinding = SymTable_newBinding(oSymTable, pcKey, uLength, pvValue);
+    if (psBinding == NULL){
+        SymTable_freeNode(oSymTable, psNode);
+        return NULL;
+    }
+    psNode->prefixLength = uCommon;
+    memcpy(psNode->prefix, pcKey + uDepth,
+           uCommon < PREFIX_SIZE ? uCommon : PREFIX_SIZE);
+    SymTable_addChild(psNode, cOld, *ppvSlot);
+    SymTable_addChild(psNode,
+                      SymTable_keyAt(pcKey, uLength, uDepth + uCommon),
+                      SymTable_leafChild(psBinding));
+    *ppvSlot = psNode;
+    return psBinding;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the Binding of oSymTable whose key is the uLength characters
+   starting at pcKey, first adding one with value pvValue if there is
+   none. Set *piAdded to 1 (TRUE) if a Binding was added, and to 0
+   (FALSE) otherwise. Return NULL if insufficient memory, in which case
+   oSymTable is unchanged. */
+
+static struct Binding *SymTable_insert(SymTable_T oSymTable,
+                                       const char *pcKey, size_t uLength,
+                                       const void *pvValue, int *piAdded)
+{
+    struct Binding *psBinding;
+    const struct Binding *psMinimum;
+    void **ppvSlot;
+    void **ppvChild;
+    size_t uDepth = 0;
+    size_t uCommon;
+    unsigned char c;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(piAdded != NULL);
+
+    /* unlike a search, the descent compares every character of the
+       prefixes, to find where the key leaves the tree */
+    *piAdded = 0;
+    ppvSlot = &oSymTable->pvRoot;
+    while (*ppvSlot != NULL && !SymTable_isLeaf(*ppvSlot)){
+        struct Node *psNode = (struct Node*)*ppvSlot;
+        uCommon = SymTable_prefixMismatch(psNode, pcKey, uLength, uDepth);
+        if (uCommon < psNode->prefixLength){
+            /* the key leaves the prefix: the node keeps the part of
+               the prefix after the character on which they differ,
+               below a new node with the part before it */
+            psMinimum = psNode->prefixLength > PREFIX_SIZE ?
+                SymTable_minimum(psNode) : NULL;
+            c = uCommon < PREFIX_SIZE ? psNode->prefix[uCommon] :
+                (unsigned char)psMinimum->key[uDepth + uCommon];
+            psBinding = SymTable_branch(oSymTable, ppvSlot, uDepth,
+                                        uCommon, c, pcKey, uLength,
+                                        pvValue);
+            if (psBinding == NULL)
+                return NULL;
+            psNode->prefixLength -= uCommon + 1;
+            if (psMinimum == NULL)
+                memmove(psNode->prefix, psNode->prefix + uCommon + 1,
+                        psNode->prefixLength);
+            else
+                memcpy(psNode->prefix,
+                       psMinimum->key + uDepth + uCommon + 1,
+                       psNode->prefixLength < PREFIX_SIZE ?
+                       psNode->prefixLength : PREFIX_SIZE);
+            oSymTable->size++;
+            *piAdded = 1;
+            return psBinding;
+        }
+        uDepth += psNode->prefixLength;
+
+        c = SymTable_keyAt(pcKey, uLength, uDepth);
+        ppvChild = SymTable_findChild(psNode, c);
+        if (ppvChild == NULL){
+            psBinding = SymTable_newBinding(oSymTable, pcKey, uLength,
+                                            pvValue);
+            if (psBinding == NULL)
+                return NULL;
+            if (!SymTable_insertChild(oSymTable, ppvSlot, c,
+                                      SymTable_leafChild(psBinding))){
+                SymTable_freeBinding(oSymTable, psBinding, uLength);
+                return NULL;
+            }
+            oSymTable->size++;
+            *piAdded = 1;
+            return psBinding;
+        }
+        ppvSlot = ppvChild;
+        uDepth++;
+    }
+
+    if (*ppvSlot == NULL){
+        psBinding = SymTable_newBinding(oSymTable, pcKey, uLength, pvValue);
+        if (psBinding == NULL)
+            return NULL;
+        *ppvSlot = SymTable_leafChild(psBinding);
+        oSymTable->size++;
+        *piAdded = 1;
+        return psBinding;
+    }
+
+    /* the leaf reached has the same first uDepth characters as the
+       key; unless it is the key, a new node branches where they
+       differ, which is at or before the end of the shorter */
+    psMinimum = SymTable_leafOf(*ppvSlot);
+    if (SymTable_matches(psMinimum, pcKey, uLength))
+        return SymTable_leafOf(*ppvSlot);
+    uCommon = 0;
+    while (SymTable_keyAt(pcKey, uLength, uDepth + uCommon) ==
+           (unsigned char)psMinimum->key[uDepth + uCommon])
+        uCommon++;
+    psBinding = SymTable_branch(oSymTable, ppvSlot, uDepth, uCommon,
+        (unsigned char)psMinimum->key[uDepth + uCommon], pcKey, uLength,
+        pvValue);
+    if (psBinding == NULL)
+        return NULL;
+    oSymTable->size++;
+    *piAdded = 1;
+    return psBinding;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the Binding that follows psBinding, a Binding of oSymTable,
+   in order of their keys, or NULL if psBinding is the last. */
+
+static struct Binding *SymTable_successor(SymTable_T oSymTable,
+                                          const struct Binding *psBinding)
+{
+    void *pvChild;
+    void *pvAfter;
+    void *pvNext = NULL;
+    size_t uDepth = 0;
+    unsigned char c;
+
+    assert(oSymTable != NULL);
+    assert(psBinding != NULL);
+
+    /* down the path of psBinding; the successor is the smallest key
+       below the child for the next greater character at the deepest
+       node on the way that has one */
+    pvChild = oSymTable->pvRoot;
+    while (!SymTable_isLeaf(pvChild)){
+        struct Node *psNode = (struct Node*)pvChild;
+        uDepth += psNode->prefixLength;
+        c = (unsigned char)psBinding->key[uDepth];
+        pvAfter = SymTable_childAfter(psNode, c);
+        if (pvAfter != NULL)
+            pvNext = pvAfter;
+        pvChild = *SymTable_findChild(psNode, c);
+        uDepth++;
+    }
+    assert(SymTable_leafOf(pvChild) == psBinding);
+    return pvNext == NULL ? NULL : SymTable_minimum(pvNext);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The function that a traversal of the bindings in key order applies
+   to them, and its extra parameter. */
+struct Walk {
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+    void *pvExtra;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of *psWalk to each Binding below pvChild, at
+   depth uDepth, whose key is at least pcLow and less than pcHigh, in
+   order of their keys. A NULL pcLow or pcHigh leaves the range
+   unbounded on that side; the keys below pvChild must have the same
+   first uDepth characters as the bounds that are not NULL. */
+
+static void SymTable_walk(void *pvChild, size_t uDepth,
+                          const char *pcLow, const char *pcHigh,
+                          const struct Walk *psWalk)
+{
+    struct Node *psNode;
+    const char *pcShared;
+    const char *pcChildLow;
+    const char *pcChildHigh;
+    void *pvGrandchild;
+    size_t uEnd;
+    size_t uPos = 0;
+    unsigned char c;
+    int iOrder;
+
+    assert(pvChild != NULL);
+    assert(psWalk != NULL);
+
+    if (SymTable_isLeaf(pvChild)){
+        struct Binding *psBinding = SymTable_leafOf(pvChild);
+        if ((pcLow == NULL || strcmp(psBinding->key, pcLow) >= 0) &&
+            (pcHigh == NULL || strcmp(psBinding->key, pcHigh) < 0))
+            (*psWalk->pfApply)(psBinding->key, psBinding->value,
+                               psWalk->pvExtra);
+        return;
+    }
+
+    /* the prefix of the node either puts all of its keys on one side
+       of a bound, which can then be dropped (or the node skipped), or
+       matches the bound, which then still applies to the children */
+    psNode = (struct Node*)pvChild;
+    uEnd = uDepth + psNode->prefixLength;
+    if (pcLow != NULL || pcHigh != NULL){
+        pcShared = SymTable_minimum(psNode)->key + uDepth;
+        if (pcLow != NULL){
+            iOrder = strncmp(pcShared, pcLow + uDepth,
+                             psNode->prefixLength);
+            if (iOrder < 0)
+                return;
+            if (iOrder > 0)
+                pcLow = NULL;
+        }
+        if (pcHigh != NULL){
+            iOrder = strncmp(pcShared, pcHigh + uDepth,
+                             psNode->prefixLength);
+            if (iOrder > 0)
+                return;
+            if (iOrder < 0)
+                pcHigh = NULL;
+        }
+    }
+
+    /* and so does the character on which each child branches */
+    while ((pvGrandchild = SymTable_nextChild(psNode, &uPos, &c)) != NULL){
+        pcChildLow = pcLow;
+        pcChildHigh = pcHigh;
+        if (pcLow != NULL){
+            if (c < (unsigned char)pcLow[uEnd])
+                continue;
+            if (c > (unsigned char)pcLow[uEnd])
+                pcChildLow = NULL;
+        }
+        if (pcHigh != NULL){
+            if (c > (unsigned char)pcHigh[uEnd])
+                return;
+            if (c < (unsigned char)pcHigh[uEnd])
+                pcChildHigh = NULL;
+        }
+        SymTable_walk(pvGrandchild, uEnd + 1, pcChildLow, pcChildHigh,
+                      psWalk);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a copy of pvChild and of everything below it, allocated from
+   oPool in the order that SymTable_map visits them, with each inner
+   node of the smallest type that holds its children, or NULL if
+   insufficient memory (the blocks already allocated are left in
+   oPool). */
+
+static void *SymTable_copy(SymPool_T oPool, void *pvChild)
+{
+    struct Node *psNode;
+    struct Node *psCopy;
+    void *pvGrandchild;
+    void *pvCopy;
+    size_t uSize;
+    size_t uPos = 0;
+    unsigned char c;
+    enum NodeType eType = NODE4;
+
+    assert(oPool != NULL);
+    assert(pvChild != NULL);
+
+    if (SymTable_isLeaf(pvChild)){
+        struct Binding *psBinding = SymTable_leafOf(pvChild);
+        uSize = sizeof(struct Binding) + strlen(psBinding->key) + 1;
+        pvCopy = SymPool_alloc(oPool, uSize);
+        if (pvCopy == NULL)
+            return NULL;
+        memcpy(pvCopy, psBinding, uSize);
+        return SymTable_leafChild((struct Binding*)pvCopy);
+    }
+
+    psNode = (struct Node*)pvChild;
+    while (psNode->count > auNodeCapacities[eType])
+        eType++;
+    psCopy = SymTable_newNode(oPool, eType);
+    if (psCopy == NULL)
+        return NULL;
+    psCopy->prefixLength = psNode->prefixLength;
+    memcpy(psCopy->prefix, psNode->prefix, PREFIX_SIZE);
+    while ((pvGrandchild = SymTable_nextChild(psNode, &uPos, &c)) != NULL){
+        pvCopy = SymTable_copy(oPool, pvGrandchild);
+        if (pvCopy == NULL)
+            return NULL;
+        SymTable_addChild(psCopy, c, pvCopy);
+    }
+    return psCopy;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Store the Bindings below pvChild, in order of their keys, in
+   apsBindings from index *puCount on, and advance *puCount past
+   them. */
+
+static void SymTable_gather(void *pvChild, struct Binding **apsBindings,
+                            size_t *puCount)
+{
+    void *pvGrandchild;
+    size_t uPos = 0;
+    unsigned char c;
+
+    assert(pvChild != NULL);
+    assert(apsBindings != NULL);
+    assert(puCount != NULL);
+
+    if (SymTable_isLeaf(pvChild)){
+        apsBindings[(*puCount)++] = SymTable_leafOf(pvChild);
+        return;
+    }
+    while ((pvGrandchild = SymTable_nextChild((struct Node*)pvChild,
+                                              &uPos, &c)) != NULL)
+        SymTable_gather(pvGrandchild, apsBindings, puCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void){
+    SymTable_T oSymTable;
+
+    oSymTable = (SymTable_T) malloc(sizeof(struct SymTable));
+    if (oSymTable == NULL)
+        return NULL;
+    oSymTable->pool = SymPool_new();
+    if (oSymTable->pool == NULL){
+        free(oSymTable);
+        return NULL;
+    }
+
+    oSymTable->pvRoot = NULL;
+    oSymTable->size = 0;
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithHash(enum SymTable_HashFunction eHash){
+    /* keys are never hashed */
+    (void)eHash;
+    return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity){
+    /* the tree grows a node at a time, and never moves its bindings */
+    (void)uCapacity;
+    return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity){
+    assert(oSymTable != NULL);
+    (void)uCapacity;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    /* every node and binding lives in the pool, which is released as
+       a whole */
+    SymPool_free(oSymTable->pool);
+    free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_compact(SymTable_T oSymTable){
+    SymPool_T oPool;
+    void *pvRoot = NULL;
+
+    assert(oSymTable != NULL);
+
+    /* the tree is copied into a new pool, so that running out of
+       memory halfway leaves the old tree as it was */
+    oPool = SymPool_new();
+    if (oPool == NULL)
+        return 0;
+    if (oSymTable->pvRoot != NULL){
+        pvRoot = SymTable_copy(oPool, oSymTable->pvRoot);
+        if (pvRoot == NULL){
+            SymPool_free(oPool);
+            return 0;
+        }
+    }
+    SymPool_free(oSymTable->pool);
+    oSymTable->pool = oPool;
+    oSymTable->pvRoot = pvRoot;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    return oSymTable->size;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_initKey(SymTable_Key *psKey, const char *pcKey,
+                      size_t uLength){
+    assert(psKey != NULL);
+    assert(pcKey != NULL);
+
+    /* keys are never hashed, so no hash code is ever cached */
+    psKey->pcKey = pcKey;
+    psKey->uLength = uLength;
+    psKey->uHashMask = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey,
+                 const void *pvValue){
+    assert(pcKey != NULL);
+
+    return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+                  size_t uLength, const void *pvValue){
+    int iAdded;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    (void)SymTable_insert(oSymTable, pcKey, uLength, pvValue, &iAdded);
+    return iAdded;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putKey(SymTable_T oSymTable, SymTable_Key *psKey,
+                    const void *pvValue){
+    assert(psKey != NULL);
+
+    return SymTable_putN(oSymTable, psKey->pcKey, psKey->uLength, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
+                       const void *pvValue){
+    SymTable_Key sKey;
+
+    assert(pcKey != NULL);
+
+    SymTable_initKey(&sKey, pcKey, strlen(pcKey));
+    return SymTable_replaceKey(oSymTable, &sKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceKey(SymTable_T oSymTable, SymTable_Key *psKey,
+                          const void *pvValue){
+    struct Binding *psBinding;
+    void *pvOldValue;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    psBinding = SymTable_find(oSymTable, psKey->pcKey, psKey->uLength);
+    if (psBinding == NULL)
+        return NULL;
+    pvOldValue = psBinding->value;
+    psBinding->value = (void*)pvValue;
+    return pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey,
+                    const void *pvValue){
+    void **ppvValue;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    ppvValue = SymTable_getOrInsert(oSymTable, pcKey, pvValue);
+    if (ppvValue == NULL)
+        return 0;
+    *ppvValue = (void*)pvValue;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable, const char *pcKey,
+                            const void *pvValue){
+    struct Binding *psBinding;
+    int iAdded;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /* a Binding never moves, so its value's address stays valid */
+    psBinding = SymTable_insert(oSymTable, pcKey, strlen(pcKey), pvValue,
+                                &iAdded);
+    if (psBinding == NULL)
+        return NULL;
+    return &psBinding->value;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength){
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    return SymTable_find(oSymTable, pcKey, uLength) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    assert(psKey != NULL);
+
+    return SymTable_containsN(oSymTable, psKey->pcKey, psKey->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+                    size_t uLength){
+    struct Binding *psBinding;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    psBinding = SymTable_find(oSymTable, pcKey, uLength);
+    return psBinding == NULL ? NULL : psBinding->value;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    assert(psKey != NULL);
+
+    return SymTable_getN(oSymTable, psKey->pcKey, psKey->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength){
+    struct Binding *psBinding;
+    void **ppvSlot;
+    void **ppvChild;
+    void *pvValue;
+    size_t uDepth = 0;
+    unsigned char c;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    ppvSlot = &oSymTable->pvRoot;
+    if (*ppvSlot == NULL)
+        return NULL;
+    if (SymTable_isLeaf(*ppvSlot)){
+        psBinding = SymTable_leafOf(*ppvSlot);
+        if (!SymTable_matches(psBinding, pcKey, uLength))
+            return NULL;
+        *ppvSlot = NULL;
+    }
+    else for (;;){
+        /* *ppvSlot is the parent of the next child, which is taken
+           from it if it is the leaf of the key */
+        struct Node *psNode = (struct Node*)*ppvSlot;
+        if (!SymTable_prefixMatches(psNode, pcKey, uLength, uDepth))
+            return NULL;
+        uDepth += psNode->prefixLength;
+        c = SymTable_keyAt(pcKey, uLength, uDepth);
+        ppvChild = SymTable_findChild(psNode, c);
+        if (ppvChild == NULL)
+            return NULL;
+        if (SymTable_isLeaf(*ppvChild)){
+            psBinding = SymTable_leafOf(*ppvChild);
+            if (!SymTable_matches(psBinding, pcKey, uLength))
+                return NULL;
+            SymTable_deleteChild(oSymTable, ppvSlot, c);
+            break;
+        }
+        ppvSlot = ppvChild;
+        uDepth++;
+    }
+    oSymTable->size--;
+
+    pvValue = psBinding->value;
+    SymTable_freeBinding(oSymTable, psBinding, uLength);
+    return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    assert(psKey != NULL);
+
+    return SymTable_removeN(oSymTable, psKey->pcKey, psKey->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable, const char *const apcKeys[],
+                       size_t uCount, void *apvValues[]){
+    size_t u;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL || uCount == 0);
+    assert(apvValues != NULL || uCount == 0);
+
+    /* the lookups share the upper levels of the tree, which the first
+       of them brings into the cache for the others */
+    for (u = 0; u < uCount; u++)
+        apvValues[u] = SymTable_get(oSymTable, apcKeys[u]);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable,
+                         const char *const apcKeys[], size_t uCount,
+                         const void *const apvValues[]){
+    size_t u;
+    size_t uAdded = 0;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL || uCount == 0);
+    assert(apvValues != NULL || uCount == 0);
+
+    for (u = 0; u < uCount; u++)
+        uAdded += (size_t)SymTable_put(oSymTable, apcKeys[u], apvValues[u]);
+    return uAdded;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+    struct Walk sWalk;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    if (oSymTable->pvRoot == NULL)
+        return;
+    sWalk.pfApply = pfApply;
+    sWalk.pvExtra = (void*)pvExtra;
+    SymTable_walk(oSymTable->pvRoot, 0, NULL, NULL, &sWalk);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a call to SymTable_mapParallel, shared by the
+   workers that run it. */
+struct MapTask {
+    /* The bindings of the table, in order of their keys */
+    struct Binding **apsBindings;
+    /* The function to apply, and its extra parameter */
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot);
+    const void *pvExtra;
+    /* The slot of each worker, or NULL */
+    void *const *apvSlots;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the MapTask that pvTask points to to bindings
+   uStart to uEnd-1 of its array, for worker uWorker. */
+
+static void SymTable_mapRange(size_t uStart, size_t uEnd, size_t uWorker,
+                              void *pvTask)
+{
+    struct MapTask *psTask = (struct MapTask*)pvTask;
+    void *pvSlot;
+    size_t u;
+
+    assert(psTask != NULL);
+
+    pvSlot = psTask->apvSlots == NULL ? NULL : psTask->apvSlots[uWorker];
+    for (u = uStart; u < uEnd; u++)
+        (*psTask->pfApply)(psTask->apsBindings[u]->key,
+                           psTask->apsBindings[u]->value,
+                           (void*)psTask->pvExtra, pvSlot);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot),
+    const void *pvExtra, size_t uThreadCount, void *const apvSlots[]){
+    struct MapTask sTask;
+    SymTable_Iter sIter;
+    const char *pcKey;
+    void *pvValue;
+    size_t u = 0;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    assert(uThreadCount > 0);
+
+    /* the bindings are the items shared out among the workers; they
+       are spread over the tree, so they are first gathered into an
+       array */
+    sTask.apsBindings = NULL;
+    if (uThreadCount > 1 && oSymTable->size > 1 &&
+        oSymTable->size <= (size_t)-1 / sizeof(struct Binding *))
+        sTask.apsBindings = (struct Binding**)
+            malloc(oSymTable->size * sizeof(struct Binding *));
+    if (sTask.apsBindings == NULL){
+        /* work alone */
+        SymTable_iterBegin(oSymTable, &sIter);
+        while (SymTable_iterNext(&sIter, &pcKey, &pvValue))
+            (*pfApply)(pcKey, pvValue, (void*)pvExtra,
+                       apvSlots == NULL ? NULL : apvSlots[0]);
+        SymTable_iterEnd(&sIter);
+        return;
+    }
+
+    SymTable_gather(oSymTable->pvRoot, sTask.apsBindings, &u);
+    assert(u == oSymTable->size);
+    sTask.pfApply = pfApply;
+    sTask.pvExtra = pvExtra;
+    sTask.apvSlots = apvSlots;
+    SymPar_run(u, uThreadCount, SymTable_mapRange, &sTask);
+    free(sTask.apsBindings);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter){
+    size_t u = 0;
+
+    assert(oSymTable != NULL);
+    assert(psIter != NULL);
+
+    psIter->oSymTable = oSymTable;
+    psIter->uIndex = 0;
+
+    /* the bindings are gathered once into an array (part 1), which
+       the traversal then steps through, as SymTable_mapParallel does;
+       without the memory for it, each binding is found from the one
+       before it by descending the tree again along its key (part 0) */
+    psIter->pvNext = NULL;
+    if (oSymTable->size > 1 &&
+        oSymTable->size <= (size_t)-1 / sizeof(struct Binding *))
+        psIter->pvNext = malloc(oSymTable->size * 
+                                sizeof(struct Binding *));
+    if (psIter->pvNext != NULL){
+        SymTable_gather(oSymTable->pvRoot, 
+                        (struct Binding**)psIter->pvNext, &u);
+        assert(u == oSymTable->size);
+        psIter->uPart = 1;
+        return;
+    }
+    psIter->uPart = 0;
+    psIter->pvNext = oSymTable->pvRoot == NULL ? NULL :
+        SymTable_minimum(oSymTable->pvRoot);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTable_Iter *psIter, const char **ppcKey,
+                      void **ppvValue){
+    struct Binding *psBinding;
+
+    assert(psIter != NULL);
+    assert(psIter->oSymTable != NULL);
+
+    if (psIter->uPart == 1){
+        /* pvNext is the array of the gathered bindings */
+        if (psIter->uIndex == psIter->oSymTable->size)
+            return 0;
+        psBinding = ((struct Binding**)psIter->pvNext)[psIter->uIndex++];
+    }
+    else {
+        /* pvNext is the next binding */
+        psBinding = (struct Binding*)psIter->pvNext;
+        if (psBinding == NULL)
+            return 0;
+        psIter->pvNext = SymTable_successor(psIter->oSymTable, 
+                                            psBinding);
+    }
+
+    if (ppcKey != NULL)
+        *ppcKey = psBinding->key;
+    if (ppvValue != NULL)
+        *ppvValue = psBinding->value;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTable_Iter *psIter){
+    assert(psIter != NULL);
+
+    if (psIter->uPart == 1)
+        free(psIter->pvNext);
+    psIter->pvNext = NULL;
+    psIter->oSymTable = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_range(SymTable_T oSymTable, const char *pcLow,
+                    const char *pcHigh,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                    const void *pvExtra){
+    struct Walk sWalk;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    if (oSymTable->pvRoot == NULL)
+        return;
+    sWalk.pfApply = pfApply;
+    sWalk.pvExtra = (void*)pvExtra;
+    SymTable_walk(oSymTable->pvRoot, 0, pcLow, pcHigh, &sWalk);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_prefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                     const void *pvExtra){
+    struct Walk sWalk;
+    void *pvChild;
+    void **ppvChild;
+    size_t uLength;
+    size_t uDepth = 0;
+
+    assert(oSymTable != NULL);
+    assert(pcPrefix != NULL);
+    assert(pfApply != NULL);
+
+    /* down to the first child whose keys all have their first uLength
+       characters in common; one of its keys then tells whether they
+       all begin with pcPrefix */
+    uLength = strlen(pcPrefix);
+    pvChild = oSymTable->pvRoot;
+    if (pvChild == NULL)
+        return;
+    while (!SymTable_isLeaf(pvChild)){
+        struct Node *psNode = (struct Node*)pvChild;
+        if (uDepth + psNode->prefixLength >= uLength)
+            break;
+        uDepth += psNode->prefixLength;
+        ppvChild = SymTable_findChild(psNode,
+                                      (unsigned char)pcPrefix[uDepth]);
+        if (ppvChild == NULL)
+            return;
+        pvChild = *ppvChild;
+        uDepth++;
+    }
+    if (strncmp(SymTable_minimum(pvChild)->key, pcPrefix, uLength) != 0)
+        return;
+
+    sWalk.pfApply = pfApply;
+    sWalk.pvExtra = (void*)pvExtra;
+    SymTable_walk(pvChild, uDepth, NULL, NULL, &sWalk);
+}
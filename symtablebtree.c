@@ -0,0 +1,1562 @@
+/*--------------------------------------------------------------------*/
+/* symtablebtree.c                                                    */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symtableordered.h"
+#include "sympar.h"
+#include "sympool.h"
+
+/*--------------------------------------------------------------------*/
+
+/* The table is a B+tree. The bindings sit in leaves, sorted by key and
+   chained left to right, so that ordered traversals and range queries
+   walk along the leaves without climbing back up the tree; the inner
+   nodes above them hold only the separator keys that steer a search.
+   Every node is aligned to a cache line and fills a few whole ones.
+   Next to its key pointers, a node keeps the first PREFIX_SIZE
+   characters of each key packed into an integer, so that a search
+   compares integers within the node and follows a key pointer only to
+   tell apart keys that share a prefix. */
+
+/* Size of the cache lines to which nodes are aligned. */
+enum {CACHE_LINE_SIZE = 64};
+
+/* Number of leading characters of a key packed into its prefix. */
+enum {PREFIX_SIZE = sizeof(unsigned long long)};
+
+/* Largest and smallest numbers of bindings of a leaf, and of separator
+   keys of an inner node, other than the root (nodes are 256 bytes on
+   LP64 machines). Two nodes at their minimum, plus for inner nodes the
+   separator between them, fit in one. */
+enum {LEAF_KEYS = 15, LEAF_MIN = 7};
+enum {INNER_KEYS = 10, INNER_MIN = 4};
+
+/* Each key-value pair is stored in a Binding. The key is stored at the
+   end of the Binding itself, so a binding is a single allocation. The
+   separator keys of inner nodes are Bindings too, whose values are
+   unused. */
+struct Binding {
+    /* The value. */
+    void *value;
+    /* The length of the key. */
+    size_t keyLength;
+    /* The key (a defensive copy of the client's key). */
+    char key[];
+};
+
+/* A leaf of the tree: up to LEAF_KEYS bindings, sorted by key. */
+struct Leaf {
+    /* The prefix (see SymTable_prefixOf) of the key of each binding */
+    unsigned long long auPrefix[LEAF_KEYS];
+    /* The bindings */
+    struct Binding *apsBindings[LEAF_KEYS];
+    /* The next leaf to the right, or NULL */
+    struct Leaf *psNext;
+    /* Number of bindings */
+    size_t count;
+};
+
+/* An inner node of the tree: up to INNER_KEYS separator keys, sorted,
+   and one child more. apvChildren[i] holds the keys that are at least
+   apsKeys[i-1] (if i > 0) and less than apsKeys[i] (if i < count). */
+struct Inner {
+    /* The prefix of each separator key */
+    unsigned long long auPrefix[INNER_KEYS];
+    /* The separator keys */
+    struct Binding *apsKeys[INNER_KEYS];
+    /* The children: all Leaves or all Inners */
+    void *apvChildren[INNER_KEYS + 1];
+    /* Number of separator keys */
+    size_t count;
+};
+
+/* A SymTable structure symbol table implemented as a B+tree. */
+struct SymTable {
+    /* The root: a Leaf if height is 0, or else an Inner */
+    void *pvRoot;
+    /* Number of levels of inner nodes above the leaves */
+    size_t height;
+    /* The size (number of bindings) in SymTable */
+    size_t size;
+    /* Number of leaves */
+    size_t leafCount;
+    /* Allocator of the Bindings (and separator keys) of this SymTable */
+    SymPool_T pool;
+};
+
+/* A key to search for, together with its prefix. */
+struct Probe {
+    /* The key: the uLength characters starting at pcKey */
+    const char *pcKey;
+    size_t uLength;
+    /* Its prefix */
+    unsigned long long uPrefix;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the prefix of the key made of the uLength characters
+   starting at pcKey: its first PREFIX_SIZE characters, as unsigned
+   bytes from the most significant down, padded with zero bytes. Since
+   keys contain no '\0', prefixes order keys as strcmp does, except
+   that keys with the same prefix may still differ. */
+
+static unsigned long long SymTable_prefixOf(const char *pcKey,
+                                            size_t uLength)
+{
+    unsigned long long uPrefix = 0;
+    size_t i;
+
+    assert(pcKey != NULL);
+
+    for (i = 0; i < PREFIX_SIZE; i++){
+        uPrefix <<= 8;
+        if (i < uLength)
+            uPrefix |= (unsigned char)pcKey[i];
+    }
+    return uPrefix;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make *psProbe the probe for the key made of the uLength characters
+   starting at pcKey. */
+
+static void SymTable_initProbe(struct Probe *psProbe, const char *pcKey,
+                               size_t uLength)
+{
+    assert(psProbe != NULL);
+    assert(pcKey != NULL);
+
+    psProbe->pcKey = pcKey;
+    psProbe->uLength = uLength;
+    psProbe->uPrefix = SymTable_prefixOf(pcKey, uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a negative number, zero or a positive number as the key of
+   *psProbe is less than, equal to or greater than the key of
+   psBinding, whose prefix is uPrefix. */
+
+static int SymTable_compare(const struct Probe *psProbe,
+                            unsigned long long uPrefix,
+                            const struct Binding *psBinding)
+{
+    size_t uMin;
+    int iOrder;
+
+    assert(psProbe != NULL);
+    assert(psBinding != NULL);
+
+    if (psProbe->uPrefix != uPrefix)
+        return psProbe->uPrefix < uPrefix ? -1 : 1;
+
+    /* the first PREFIX_SIZE characters (or all of the shorter key)
+       are equal */
+    uMin = psProbe->uLength < psBinding->keyLength ?
+        psProbe->uLength : psBinding->keyLength;
+    if (uMin > PREFIX_SIZE){
+        iOrder = memcmp(psProbe->pcKey + PREFIX_SIZE,
+                        psBinding->key + PREFIX_SIZE,
+                        uMin - PREFIX_SIZE);
+        if (iOrder != 0)
+            return iOrder;
+    }
+    return (psProbe->uLength > psBinding->keyLength) -
+        (psProbe->uLength < psBinding->keyLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the child of psInner whose subtree holds the key
+   of *psProbe if any does: the number of separator keys of psInner
+   that are not greater than it. */
+
+static size_t SymTable_childIndex(const struct Inner *psInner,
+                                  const struct Probe *psProbe)
+{
+    size_t i;
+
+    assert(psInner != NULL);
+    assert(psProbe != NULL);
+
+    for (i = 0; i < psInner->count; i++)
+        if (SymTable_compare(psProbe, psInner->auPrefix[i],
+                             psInner->apsKeys[i]) < 0)
+            break;
+    return i;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the first binding of psLeaf whose key is not
+   less than the key of *psProbe, or psLeaf->count if there is none,
+   and set *piFound to 1 (TRUE) if that binding's key is the key of
+   *psProbe, or to 0 (FALSE) otherwise. */
+
+static size_t SymTable_lowerBound(const struct Leaf *psLeaf,
+                                  const struct Probe *psProbe,
+                                  int *piFound)
+{
+    size_t i;
+    int iOrder = 1;
+
+    assert(psLeaf != NULL);
+    assert(psProbe != NULL);
+    assert(piFound != NULL);
+
+    for (i = 0; i < psLeaf->count; i++){
+        iOrder = SymTable_compare(psProbe, psLeaf->auPrefix[i],
+                                  psLeaf->apsBindings[i]);
+        if (iOrder <= 0)
+            break;
+    }
+    *piFound = i < psLeaf->count && iOrder == 0;
+    return i;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the leaf of oSymTable that holds the key of *psProbe if any
+   leaf does (or else would hold it). */
+
+static struct Leaf *SymTable_findLeaf(SymTable_T oSymTable,
+                                      const struct Probe *psProbe)
+{
+    void *pvNode;
+    size_t uLevel;
+
+    assert(oSymTable != NULL);
+    assert(psProbe != NULL);
+
+    pvNode = oSymTable->pvRoot;
+    for (uLevel = oSymTable->height; uLevel > 0; uLevel--){
+        struct Inner *psInner = (struct Inner*)pvNode;
+        pvNode = psInner->apvChildren[SymTable_childIndex(psInner,
+                                                          psProbe)];
+    }
+    return (struct Leaf*)pvNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the leftmost leaf of oSymTable. */
+
+static struct Leaf *SymTable_firstLeaf(SymTable_T oSymTable)
+{
+    void *pvNode;
+    size_t uLevel;
+
+    assert(oSymTable != NULL);
+
+    pvNode = oSymTable->pvRoot;
+    for (uLevel = oSymTable->height; uLevel > 0; uLevel--)
+        pvNode = ((struct Inner*)pvNode)->apvChildren[0];
+    return (struct Leaf*)pvNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the binding of oSymTable whose key is the key of *psProbe,
+   or NULL if no such binding exists. */
+
+static struct Binding *SymTable_find(SymTable_T oSymTable,
+                                     const struct Probe *psProbe)
+{
+    struct Leaf *psLeaf;
+    size_t i;
+    int iFound;
+
+    assert(oSymTable != NULL);
+    assert(psProbe != NULL);
+
+    psLeaf = SymTable_findLeaf(oSymTable, psProbe);
+    i = SymTable_lowerBound(psLeaf, psProbe, &iFound);
+    return iFound ? psLeaf->apsBindings[i] : NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Allocate a Binding for oSymTable with key the uLength characters
+   starting at pcKey and value pvValue. Return its address, or NULL if
+   insufficient memory. */
+
+static struct Binding *SymTable_newBinding(SymTable_T oSymTable,
+                                           const char *pcKey,
+                                           size_t uLength,
+                                           const void *pvValue)
+{
+    struct Binding *psBinding;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    psBinding = (struct Binding*)SymPool_alloc(oSymTable->pool,
+        sizeof(struct Binding) + uLength + 1);
+    if (psBinding == NULL)
+        return NULL;
+    memcpy(psBinding->key, pcKey, uLength);
+    psBinding->key[uLength] = '\0';
+    psBinding->keyLength = uLength;
+    psBinding->value = (void*)pvValue;
+    return psBinding;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Release psBinding, allocated by SymTable_newBinding for
+   oSymTable. */
+
+static void SymTable_freeBinding(SymTable_T oSymTable,
+                                 struct Binding *psBinding)
+{
+    assert(oSymTable != NULL);
+    assert(psBinding != NULL);
+
+    SymPool_release(oSymTable->pool, psBinding,
+                    sizeof(struct Binding) + psBinding->keyLength + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty Leaf, aligned to a cache line, or NULL if
+   insufficient memory. */
+
+static struct Leaf *SymTable_newLeaf(void)
+{
+    void *pvLeaf;
+
+    if (posix_memalign(&pvLeaf, CACHE_LINE_SIZE, sizeof(struct Leaf)) != 0)
+        return NULL;
+    ((struct Leaf*)pvLeaf)->psNext = NULL;
+    ((struct Leaf*)pvLeaf)->count = 0;
+    return (struct Leaf*)pvLeaf;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new Inner with no separator keys, aligned to a cache line,
+   or NULL if insufficient memory. */
+
+static struct Inner *SymTable_newInner(void)
+{
+    void *pvInner;
+
+    if (posix_memalign(&pvInner, CACHE_LINE_SIZE,
+                       sizeof(struct Inner)) != 0)
+        return NULL;
+    ((struct Inner*)pvInner)->count = 0;
+    return (struct Inner*)pvInner;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the node pvNode, uLevel levels above the leaves, together with
+   the nodes below it (but not their bindings, which live in the
+   pool). */
+
+static void SymTable_freeNodes(void *pvNode, size_t uLevel)
+{
+    size_t i;
+
+    assert(pvNode != NULL);
+
+    if (uLevel > 0){
+        struct Inner *psInner = (struct Inner*)pvNode;
+        for (i = 0; i <= psInner->count; i++)
+            SymTable_freeNodes(psInner->apvChildren[i], uLevel - 1);
+    }
+    free(pvNode);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings of pvNode if it is a leaf (iLeaf), or
+   else its number of separator keys. */
+
+static size_t SymTable_nodeCount(const void *pvNode, int iLeaf)
+{
+    assert(pvNode != NULL);
+
+    return iLeaf ? ((const struct Leaf*)pvNode)->count :
+        ((const struct Inner*)pvNode)->count;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Insert separator key psKey, with prefix uPrefix, into psInner, which
+   is not full, after child uChild, and make pvRight the child that
+   follows it. */
+
+static void SymTable_insertSeparator(struct Inner *psInner, size_t uChild,
+                                     unsigned long long uPrefix,
+                                     struct Binding *psKey, void *pvRight)
+{
+    size_t uMoved;
+
+    assert(psInner != NULL);
+    assert(psInner->count < INNER_KEYS);
+    assert(uChild <= psInner->count);
+
+    uMoved = psInner->count - uChild;
+    memmove(&psInner->auPrefix[uChild + 1], &psInner->auPrefix[uChild],
+            uMoved * sizeof(unsigned long long));
+    memmove(&psInner->apsKeys[uChild + 1], &psInner->apsKeys[uChild],
+            uMoved * sizeof(struct Binding *));
+    memmove(&psInner->apvChildren[uChild + 2],
+            &psInner->apvChildren[uChild + 1], uMoved * sizeof(void *));
+    psInner->auPrefix[uChild] = uPrefix;
+    psInner->apsKeys[uChild] = psKey;
+    psInner->apvChildren[uChild + 1] = pvRight;
+    psInner->count++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove separator key uKey of psInner, and the child that follows
+   it. */
+
+static void SymTable_removeSeparator(struct Inner *psInner, size_t uKey)
+{
+    size_t uMoved;
+
+    assert(psInner != NULL);
+    assert(uKey < psInner->count);
+
+    uMoved = psInner->count - uKey - 1;
+    memmove(&psInner->auPrefix[uKey], &psInner->auPrefix[uKey + 1],
+            uMoved * sizeof(unsigned long long));
+    memmove(&psInner->apsKeys[uKey], &psInner->apsKeys[uKey + 1],
+            uMoved * sizeof(struct Binding *));
+    memmove(&psInner->apvChildren[uKey + 1],
+            &psInner->apvChildren[uKey + 2], uMoved * sizeof(void *));
+    psInner->count--;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Split child uChild of psParent, which is full, in two, adding the
+   separator between the halves to psParent, which is not full. The
+   children of psParent are leaves if iLeaves. Return 1 (TRUE) if
+   successful, or 0 (FALSE) if insufficient memory is available, in
+   which case nothing changes. */
+
+static int SymTable_splitChild(SymTable_T oSymTable,
+                               struct Inner *psParent, size_t uChild,
+                               int iLeaves)
+{
+    /* the key of an inner node that moves up to the parent */
+    const size_t MIDDLE = INNER_KEYS - INNER_MIN - 1;
+    struct Binding *psSeparator;
+    unsigned long long uSeparatorPrefix;
+    void *pvRight;
+
+    assert(oSymTable != NULL);
+    assert(psParent != NULL);
+    assert(psParent->count < INNER_KEYS);
+
+    if (iLeaves){
+        struct Leaf *psLeft = (struct Leaf*)psParent->apvChildren[uChild];
+        struct Leaf *psRight;
+
+        assert(psLeft->count == LEAF_KEYS);
+        psRight = SymTable_newLeaf();
+        if (psRight == NULL)
+            return 0;
+        /* a leaf keeps all of its keys: the separator is a copy of the
+           first one to move right */
+        psSeparator = SymTable_newBinding(oSymTable,
+            psLeft->apsBindings[LEAF_MIN]->key,
+            psLeft->apsBindings[LEAF_MIN]->keyLength, NULL);
+        if (psSeparator == NULL){
+            free(psRight);
+            return 0;
+        }
+        uSeparatorPrefix = psLeft->auPrefix[LEAF_MIN];
+        psRight->count = LEAF_KEYS - LEAF_MIN;
+        memcpy(psRight->auPrefix, &psLeft->auPrefix[LEAF_MIN],
+               psRight->count * sizeof(unsigned long long));
+        memcpy(psRight->apsBindings, &psLeft->apsBindings[LEAF_MIN],
+               psRight->count * sizeof(struct Binding *));
+        psLeft->count = LEAF_MIN;
+        psRight->psNext = psLeft->psNext;
+        psLeft->psNext = psRight;
+        oSymTable->leafCount++;
+        pvRight = psRight;
+    }
+    else {
+        struct Inner *psLeft = (struct Inner*)psParent->apvChildren[uChild];
+        struct Inner *psRight;
+
+        assert(psLeft->count == INNER_KEYS);
+        psRight = SymTable_newInner();
+        if (psRight == NULL)
+            return 0;
+        /* the middle key itself moves up */
+        psSeparator = psLeft->apsKeys[MIDDLE];
+        uSeparatorPrefix = psLeft->auPrefix[MIDDLE];
+        psRight->count = INNER_KEYS - MIDDLE - 1;
+        memcpy(psRight->auPrefix, &psLeft->auPrefix[MIDDLE + 1],
+               psRight->count * sizeof(unsigned long long));
+        memcpy(psRight->apsKeys, &psLeft->apsKeys[MIDDLE + 1],
+               psRight->count * sizeof(struct Binding *));
+        memcpy(psRight->apvChildren, &psLeft->apvChildren[MIDDLE + 1],
+               (psRight->count + 1) * sizeof(void *));
+        psLeft->count = MIDDLE;
+        pvRight = psRight;
+    }
+    SymTable_insertSeparator(psParent, uChild, uSeparatorPrefix,
+                             psSeparator, pvRight);
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the binding of oSymTable whose key is the key of *psProbe,
+   first adding one with value pvValue if oSymTable contains none, and
+   set *piAdded to 1 (TRUE) if it was added or to 0 (FALSE) otherwise.
+   Full nodes are split on the way down, so that a split never has to
+   climb back up the tree. Return NULL if insufficient memory is
+   available, in which case oSymTable holds the same bindings as
+   before. */
+
+static struct Binding *SymTable_insert(SymTable_T oSymTable,
+                                       const struct Probe *psProbe,
+                                       const void *pvValue, int *piAdded)
+{
+    struct Binding *psBinding;
+    struct Leaf *psLeaf;
+    void *pvNode;
+    size_t uLevel;
+    size_t i;
+    int iFound;
+
+    assert(oSymTable != NULL);
+    assert(psProbe != NULL);
+    assert(piAdded != NULL);
+
+    *piAdded = 0;
+
+    /* a full root gets a new root above it, and the tree grows a
+       level */
+    if (SymTable_nodeCount(oSymTable->pvRoot, oSymTable->height == 0) ==
+        (oSymTable->height == 0 ? LEAF_KEYS : INNER_KEYS)){
+        struct Inner *psRoot = SymTable_newInner();
+        if (psRoot == NULL)
+            return NULL;
+        psRoot->apvChildren[0] = oSymTable->pvRoot;
+        if (!SymTable_splitChild(oSymTable, psRoot, 0,
+                                 oSymTable->height == 0)){
+            free(psRoot);
+            return NULL;
+        }
+        oSymTable->pvRoot = psRoot;
+        oSymTable->height++;
+    }
+
+    pvNode = oSymTable->pvRoot;
+    for (uLevel = oSymTable->height; uLevel > 0; uLevel--){
+        struct Inner *psInner = (struct Inner*)pvNode;
+        i = SymTable_childIndex(psInner, psProbe);
+        if (SymTable_nodeCount(psInner->apvChildren[i], uLevel == 1) ==
+            (uLevel == 1 ? LEAF_KEYS : INNER_KEYS)){
+            if (!SymTable_splitChild(oSymTable, psInner, i, uLevel == 1))
+                return NULL;
+            if (SymTable_compare(psProbe, psInner->auPrefix[i],
+                                 psInner->apsKeys[i]) >= 0)
+                i++;
+        }
+        pvNode = psInner->apvChildren[i];
+    }
+
+    psLeaf = (struct Leaf*)pvNode;
+    i = SymTable_lowerBound(psLeaf, psProbe, &iFound);
+    if (iFound)
+        return psLeaf->apsBindings[i];
+    psBinding = SymTable_newBinding(oSymTable, psProbe->pcKey,
+                                    psProbe->uLength, pvValue);
+    if (psBinding == NULL)
+        return NULL;
+    memmove(&psLeaf->auPrefix[i + 1], &psLeaf->auPrefix[i],
+            (psLeaf->count - i) * sizeof(unsigned long long));
+    memmove(&psLeaf->apsBindings[i + 1], &psLeaf->apsBindings[i],
+            (psLeaf->count - i) * sizeof(struct Binding *));
+    psLeaf->auPrefix[i] = psProbe->uPrefix;
+    psLeaf->apsBindings[i] = psBinding;
+    psLeaf->count++;
+    oSymTable->size++;
+    *piAdded = 1;
+    return psBinding;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the last key of child uChild-1 of psParent to the front of
+   child uChild, whose children are leaves if iLeaves. A leaf needs a
+   new separator in front of it; if that cannot be allocated, nothing
+   changes. */
+
+static void SymTable_borrowLeft(SymTable_T oSymTable,
+                                struct Inner *psParent, size_t uChild,
+                                int iLeaves)
+{
+    assert(oSymTable != NULL);
+    assert(psParent != NULL);
+    assert(uChild > 0);
+
+    if (iLeaves){
+        struct Leaf *psLeft =
+            (struct Leaf*)psParent->apvChildren[uChild - 1];
+        struct Leaf *psChild = (struct Leaf*)psParent->apvChildren[uChild];
+        struct Binding *psMoved = psLeft->apsBindings[psLeft->count - 1];
+        struct Binding *psSeparator = SymTable_newBinding(oSymTable,
+            psMoved->key, psMoved->keyLength, NULL);
+
+        if (psSeparator == NULL)
+            return;
+        memmove(&psChild->auPrefix[1], &psChild->auPrefix[0],
+                psChild->count * sizeof(unsigned long long));
+        memmove(&psChild->apsBindings[1], &psChild->apsBindings[0],
+                psChild->count * sizeof(struct Binding *));
+        psChild->auPrefix[0] = psLeft->auPrefix[psLeft->count - 1];
+        psChild->apsBindings[0] = psMoved;
+        psChild->count++;
+        psLeft->count--;
+        SymTable_freeBinding(oSymTable, psParent->apsKeys[uChild - 1]);
+        psParent->apsKeys[uChild - 1] = psSeparator;
+        psParent->auPrefix[uChild - 1] = psChild->auPrefix[0];
+    }
+    else {
+        struct Inner *psLeft =
+            (struct Inner*)psParent->apvChildren[uChild - 1];
+        struct Inner *psChild =
+            (struct Inner*)psParent->apvChildren[uChild];
+
+        /* the separator comes down, and the left key goes up */
+        memmove(&psChild->auPrefix[1], &psChild->auPrefix[0],
+                psChild->count * sizeof(unsigned long long));
+        memmove(&psChild->apsKeys[1], &psChild->apsKeys[0],
+                psChild->count * sizeof(struct Binding *));
+        memmove(&psChild->apvChildren[1], &psChild->apvChildren[0],
+                (psChild->count + 1) * sizeof(void *));
+        psChild->auPrefix[0] = psParent->auPrefix[uChild - 1];
+        psChild->apsKeys[0] = psParent->apsKeys[uChild - 1];
+        psChild->apvChildren[0] = psLeft->apvChildren[psLeft->count];
+        psChild->count++;
+        psParent->auPrefix[uChild - 1] = psLeft->auPrefix[psLeft->count - 1];
+        psParent->apsKeys[uChild - 1] = psLeft->apsKeys[psLeft->count - 1];
+        psLeft->count--;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the first key of child uChild+1 of psParent to the end of
+   child uChild, whose children are leaves if iLeaves. A leaf needs a
+   new separator after it; if that cannot be allocated, nothing
+   changes. */
+
+static void SymTable_borrowRight(SymTable_T oSymTable,
+                                 struct Inner *psParent, size_t uChild,
+                                 int iLeaves)
+{
+    assert(oSymTable != NULL);
+    assert(psParent != NULL);
+    assert(uChild < psParent->count);
+
+    if (iLeaves){
+        struct Leaf *psChild = (struct Leaf*)psParent->apvChildren[uChild];
+        struct Leaf *psRight =
+            (struct Leaf*)psParent->apvChildren[uChild + 1];
+        struct Binding *psSeparator = SymTable_newBinding(oSymTable,
+            psRight->apsBindings[1]->key, psRight->apsBindings[1]->keyLength,
+            NULL);
+
+        if (psSeparator == NULL)
+            return;
+        psChild->auPrefix[psChild->count] = psRight->auPrefix[0];
+        psChild->apsBindings[psChild->count] = psRight->apsBindings[0];
+        psChild->count++;
+        psRight->count--;
+        memmove(&psRight->auPrefix[0], &psRight->auPrefix[1],
+                psRight->count * sizeof(unsigned long long));
+        memmove(&psRight->apsBindings[0], &psRight->apsBindings[1],
+                psRight->count * sizeof(struct Binding *));
+        SymTable_freeBinding(oSymTable, psParent->apsKeys[uChild]);
+        psParent->apsKeys[uChild] = psSeparator;
+        psParent->auPrefix[uChild] = psRight->auPrefix[0];
+    }
+    else {
+        struct Inner *psChild =
+            (struct Inner*)psParent->apvChildren[uChild];
+        struct Inner *psRight =
+            (struct Inner*)psParent->apvChildren[uChild + 1];
+
+        /* the separator comes down, and the right key goes up */
+        psChild->auPrefix[psChild->count] = psParent->auPrefix[uChild];
+        psChild->apsKeys[psChild->count] = psParent->apsKeys[uChild];
+        psChild->apvChildren[psChild->count + 1] = psRight->apvChildren[0];
+        psChild->count++;
+        psParent->auPrefix[uChild] = psRight->auPrefix[0];
+        psParent->apsKeys[uChild] = psRight->apsKeys[0];
+        psRight->count--;
+        memmove(&psRight->auPrefix[0], &psRight->auPrefix[1],
+                psRight->count * sizeof(unsigned long long));
+        memmove(&psRight->apsKeys[0], &psRight->apsKeys[1],
+                psRight->count * sizeof(struct Binding *));
+        memmove(&psRight->apvChildren[0], &psRight->apvChildren[1],
+                (psRight->count + 1) * sizeof(void *));
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Merge child uLeft+1 of psParent into child uLeft, whose children are
+   leaves if iLeaves, and free it. The two must fit in one node. */
+
+static void SymTable_merge(SymTable_T oSymTable, struct Inner *psParent,
+                           size_t uLeft, int iLeaves)
+{
+    assert(oSymTable != NULL);
+    assert(psParent != NULL);
+    assert(uLeft < psParent->count);
+
+    if (iLeaves){
+        struct Leaf *psLeft = (struct Leaf*)psParent->apvChildren[uLeft];
+        struct Leaf *psRight =
+            (struct Leaf*)psParent->apvChildren[uLeft + 1];
+
+        assert(psLeft->count + psRight->count <= LEAF_KEYS);
+        memcpy(&psLeft->auPrefix[psLeft->count], psRight->auPrefix,
+               psRight->count * sizeof(unsigned long long));
+        memcpy(&psLeft->apsBindings[psLeft->count], psRight->apsBindings,
+               psRight->count * sizeof(struct Binding *));
+        psLeft->count += psRight->count;
+        psLeft->psNext = psRight->psNext;
+        /* the separator between them is no longer needed */
+        SymTable_freeBinding(oSymTable, psParent->apsKeys[uLeft]);
+        free(psRight);
+        oSymTable->leafCount--;
+    }
+    else {
+        struct Inner *psLeft = (struct Inner*)psParent->apvChildren[uLeft];
+        struct Inner *psRight =
+            (struct Inner*)psParent->apvChildren[uLeft + 1];
+
+        assert(psLeft->count + 1 + psRight->count <= INNER_KEYS);
+        /* the separator between them comes down between their keys */
+        psLeft->auPrefix[psLeft->count] = psParent->auPrefix[uLeft];
+        psLeft->apsKeys[psLeft->count] = psParent->apsKeys[uLeft];
+        memcpy(&psLeft->auPrefix[psLeft->count + 1], psRight->auPrefix,
+               psRight->count * sizeof(unsigned long long));
+        memcpy(&psLeft->apsKeys[psLeft->count + 1], psRight->apsKeys,
+               psRight->count * sizeof(struct Binding *));
+        memcpy(&psLeft->apvChildren[psLeft->count + 1],
+               psRight->apvChildren, (psRight->count + 1) * sizeof(void *));
+        psLeft->count += 1 + psRight->count;
+        free(psRight);
+    }
+    SymTable_removeSeparator(psParent, uLeft);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give child uChild of psParent, whose children are leaves if iLeaves
+   and which holds no more than the minimum number of keys, a key
+   more, from a sibling that can spare one, or else merge it with a
+   sibling, so that removing a key below it cannot leave it
+   underfull. If a leaf cannot borrow for lack of memory, it is left
+   as it is: the tree stays correct, only less full. */
+
+static void SymTable_fillChild(SymTable_T oSymTable,
+                               struct Inner *psParent, size_t uChild,
+                               int iLeaves)
+{
+    size_t uMin = iLeaves ? LEAF_MIN : INNER_MIN;
+
+    assert(oSymTable != NULL);
+    assert(psParent != NULL);
+    assert(psParent->count > 0);
+
+    if (uChild > 0 &&
+        SymTable_nodeCount(psParent->apvChildren[uChild - 1], iLeaves) >
+        uMin)
+        SymTable_borrowLeft(oSymTable, psParent, uChild, iLeaves);
+    else if (uChild < psParent->count &&
+             SymTable_nodeCount(psParent->apvChildren[uChild + 1],
+                                iLeaves) > uMin)
+        SymTable_borrowRight(oSymTable, psParent, uChild, iLeaves);
+    else if (uChild > 0)
+        SymTable_merge(oSymTable, psParent, uChild - 1, iLeaves);
+    else SymTable_merge(oSymTable, psParent, uChild, iLeaves);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Fill apvNodes[0] to apvNodes[uLeafCount-1] with new leaves, chained
+   left to right, holding copies (allocated from the pool of
+   oSymTable) of the bindings of oSymTable in order, shared out evenly
+   among them. Store in apsSeparators[j] and auPrefixes[j], for each j
+   from 1 to uLeafCount-1, a separator key in front of leaf j and its
+   prefix. Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient
+   memory is available, in which case the leaves built so far are
+   freed (but not the copies, which are left in the pool). */
+
+static int SymTable_buildLeaves(SymTable_T oSymTable, void *apvNodes[],
+                                struct Binding *apsSeparators[],
+                                unsigned long long auPrefixes[],
+                                size_t uLeafCount)
+{
+    struct Leaf *psOldLeaf;
+    struct Leaf *psLeaf = NULL;
+    struct Binding *psOld;
+    size_t uOldIndex = 0;
+    size_t uCount;
+    size_t i;
+    size_t j;
+
+    assert(oSymTable != NULL);
+    assert(uLeafCount > 0);
+
+    psOldLeaf = SymTable_firstLeaf(oSymTable);
+    for (j = 0; j < uLeafCount; j++){
+        uCount = oSymTable->size / uLeafCount +
+            (j < oSymTable->size % uLeafCount);
+        psLeaf = SymTable_newLeaf();
+        if (psLeaf == NULL)
+            break;
+        apvNodes[j] = psLeaf;
+        if (j > 0)
+            ((struct Leaf*)apvNodes[j - 1])->psNext = psLeaf;
+        for (i = 0; i < uCount; i++){
+            while (uOldIndex == psOldLeaf->count){
+                psOldLeaf = psOldLeaf->psNext;
+                uOldIndex = 0;
+            }
+            psOld = psOldLeaf->apsBindings[uOldIndex];
+            psLeaf->apsBindings[i] = SymTable_newBinding(oSymTable,
+                psOld->key, psOld->keyLength, psOld->value);
+            if (psLeaf->apsBindings[i] == NULL)
+                break;
+            psLeaf->auPrefix[i] = psOldLeaf->auPrefix[uOldIndex];
+            psLeaf->count++;
+            uOldIndex++;
+        }
+        if (i < uCount)
+            break;
+        if (j > 0){
+            apsSeparators[j] = SymTable_newBinding(oSymTable,
+                psLeaf->apsBindings[0]->key,
+                psLeaf->apsBindings[0]->keyLength, NULL);
+            if (apsSeparators[j] == NULL)
+                break;
+            auPrefixes[j] = psLeaf->auPrefix[0];
+        }
+    }
+    if (j == uLeafCount)
+        return 1;
+
+    if (psLeaf != NULL)
+        free(psLeaf);
+    while (j-- > 0)
+        free(apvNodes[j]);
+    return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Replace the *puNodeCount nodes apvNodes[0], ..., uLevel levels above
+   the leaves, where each node j but the first has separator key
+   apsSeparators[j] with prefix auPrefixes[j] in front of it, by the
+   level of new inner nodes above them, sharing them out evenly, with
+   the separator key in front of each parent in the same arrays.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available, in which case every node of both levels is freed. */
+
+static int SymTable_buildLevel(void *apvNodes[],
+                               struct Binding *apsSeparators[],
+                               unsigned long long auPrefixes[],
+                               size_t *puNodeCount, size_t uLevel)
+{
+    struct Inner *psInner;
+    size_t uNodeCount;
+    size_t uParentCount;
+    size_t uStart = 0;
+    size_t uCount;
+    size_t i;
+    size_t j;
+
+    assert(apvNodes != NULL);
+    assert(puNodeCount != NULL);
+
+    /* parent j takes its children from uStart >= j onwards, so the
+       parents can overwrite the children already taken */
+    uNodeCount = *puNodeCount;
+    uParentCount = (uNodeCount + INNER_KEYS) / (INNER_KEYS + 1);
+    for (j = 0; j < uParentCount; j++){
+        uCount = uNodeCount / uParentCount +
+            (j < uNodeCount % uParentCount);
+        psInner = SymTable_newInner();
+        if (psInner == NULL){
+            for (i = 0; i < j; i++)
+                SymTable_freeNodes(apvNodes[i], uLevel + 1);
+            for (i = uStart; i < uNodeCount; i++)
+                SymTable_freeNodes(apvNodes[i], uLevel);
+            return 0;
+        }
+        for (i = 0; i < uCount; i++){
+            psInner->apvChildren[i] = apvNodes[uStart + i];
+            if (i > 0){
+                psInner->apsKeys[i - 1] = apsSeparators[uStart + i];
+                psInner->auPrefix[i - 1] = auPrefixes[uStart + i];
+            }
+        }
+        psInner->count = uCount - 1;
+        apvNodes[j] = psInner;
+        apsSeparators[j] = apsSeparators[uStart];
+        auPrefixes[j] = auPrefixes[uStart];
+        uStart += uCount;
+    }
+    *puNodeCount = uParentCount;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void){
+    SymTable_T oSymTable;
+
+    oSymTable = (SymTable_T) malloc(sizeof(struct SymTable));
+    if (oSymTable == NULL)
+        return NULL;
+    oSymTable->pool = SymPool_new();
+    if (oSymTable->pool == NULL){
+        free(oSymTable);
+        return NULL;
+    }
+    oSymTable->pvRoot = SymTable_newLeaf();
+    if (oSymTable->pvRoot == NULL){
+        SymPool_free(oSymTable->pool);
+        free(oSymTable);
+        return NULL;
+    }
+
+    oSymTable->height = 0;
+    oSymTable->size = 0;
+    oSymTable->leafCount = 1;
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithHash(enum SymTable_HashFunction eHash){
+    /* keys are never hashed */
+    (void)eHash;
+    return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity){
+    /* the tree grows a node at a time, and never moves its bindings */
+    (void)uCapacity;
+    return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity){
+    assert(oSymTable != NULL);
+    (void)uCapacity;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    /* every binding and separator key lives in the pool, which is
+       released as a whole */
+    SymTable_freeNodes(oSymTable->pvRoot, oSymTable->height);
+    SymPool_free(oSymTable->pool);
+    free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_compact(SymTable_T oSymTable){
+    void **apvNodes;
+    struct Binding **apsSeparators;
+    unsigned long long *auPrefixes;
+    SymPool_T oldPool;
+    size_t uLeafCount;
+    size_t uNodeCount;
+    size_t uHeight = 0;
+    int iSuccessful;
+
+    assert(oSymTable != NULL);
+
+    /* the tree is rebuilt bottom-up, with nodes as full as the
+       minimum occupancy of the last of each level allows, from copies
+       of the bindings in a new pool, so that running out of memory
+       halfway leaves the old tree as it was */
+    uLeafCount = (oSymTable->size + LEAF_KEYS - 1) / LEAF_KEYS;
+    if (uLeafCount == 0)
+        uLeafCount = 1;
+    apvNodes = (void**)malloc(uLeafCount * sizeof(void *));
+    apsSeparators = (struct Binding**)
+        malloc(uLeafCount * sizeof(struct Binding *));
+    auPrefixes = (unsigned long long*)
+        malloc(uLeafCount * sizeof(unsigned long long));
+    oldPool = oSymTable->pool;
+    oSymTable->pool = SymPool_new();
+    iSuccessful = apvNodes != NULL && apsSeparators != NULL &&
+        auPrefixes != NULL && oSymTable->pool != NULL &&
+        SymTable_buildLeaves(oSymTable, apvNodes, apsSeparators,
+                             auPrefixes, uLeafCount);
+    uNodeCount = uLeafCount;
+    while (iSuccessful && uNodeCount > 1){
+        iSuccessful = SymTable_buildLevel(apvNodes, apsSeparators,
+                                          auPrefixes, &uNodeCount,
+                                          uHeight);
+        uHeight++;
+    }
+
+    if (iSuccessful){
+        SymTable_freeNodes(oSymTable->pvRoot, oSymTable->height);
+        SymPool_free(oldPool);
+        oSymTable->pvRoot = apvNodes[0];
+        oSymTable->height = uHeight;
+        oSymTable->leafCount = uLeafCount;
+    }
+    else {
+        if (oSymTable->pool != NULL)
+            SymPool_free(oSymTable->pool);
+        oSymTable->pool = oldPool;
+    }
+    free(apvNodes);
+    free(apsSeparators);
+    free(auPrefixes);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    return oSymTable->size;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_initKey(SymTable_Key *psKey, const char *pcKey,
+                      size_t uLength){
+    assert(psKey != NULL);
+    assert(pcKey != NULL);
+
+    /* keys are never hashed, so no hash code is ever cached */
+    psKey->pcKey = pcKey;
+    psKey->uLength = uLength;
+    psKey->uHashMask = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey,
+                 const void *pvValue){
+    assert(pcKey != NULL);
+
+    return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+                  size_t uLength, const void *pvValue){
+    struct Probe sProbe;
+    int iAdded;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    SymTable_initProbe(&sProbe, pcKey, uLength);
+    (void)SymTable_insert(oSymTable, &sProbe, pvValue, &iAdded);
+    return iAdded;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putKey(SymTable_T oSymTable, SymTable_Key *psKey,
+                    const void *pvValue){
+    assert(psKey != NULL);
+
+    return SymTable_putN(oSymTable, psKey->pcKey, psKey->uLength, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
+                       const void *pvValue){
+    SymTable_Key sKey;
+
+    assert(pcKey != NULL);
+
+    SymTable_initKey(&sKey, pcKey, strlen(pcKey));
+    return SymTable_replaceKey(oSymTable, &sKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceKey(SymTable_T oSymTable, SymTable_Key *psKey,
+                          const void *pvValue){
+    struct Probe sProbe;
+    struct Binding *psBinding;
+    void *pvOldValue;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    SymTable_initProbe(&sProbe, psKey->pcKey, psKey->uLength);
+    psBinding = SymTable_find(oSymTable, &sProbe);
+    if (psBinding == NULL)
+        return NULL;
+    pvOldValue = psBinding->value;
+    psBinding->value = (void*)pvValue;
+    return pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey,
+                    const void *pvValue){
+    void **ppvValue;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    ppvValue = SymTable_getOrInsert(oSymTable, pcKey, pvValue);
+    if (ppvValue == NULL)
+        return 0;
+    *ppvValue = (void*)pvValue;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable, const char *pcKey,
+                            const void *pvValue){
+    struct Probe sProbe;
+    struct Binding *psBinding;
+    int iAdded;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /* one descent, which splits full nodes whether or not the key is
+       found; a Binding never moves, so its value's address stays
+       valid */
+    SymTable_initProbe(&sProbe, pcKey, strlen(pcKey));
+    psBinding = SymTable_insert(oSymTable, &sProbe, pvValue, &iAdded);
+    if (psBinding == NULL)
+        return NULL;
+    return &psBinding->value;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength){
+    struct Probe sProbe;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    SymTable_initProbe(&sProbe, pcKey, uLength);
+    return SymTable_find(oSymTable, &sProbe) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    assert(psKey != NULL);
+
+    return SymTable_containsN(oSymTable, psKey->pcKey, psKey->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+                    size_t uLength){
+    struct Probe sProbe;
+    struct Binding *psBinding;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    SymTable_initProbe(&sProbe, pcKey, uLength);
+    psBinding = SymTable_find(oSymTable, &sProbe);
+    return psBinding == NULL ? NULL : psBinding->value;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    assert(psKey != NULL);
+
+    return SymTable_getN(oSymTable, psKey->pcKey, psKey->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength){
+    struct Probe sProbe;
+    struct Leaf *psLeaf;
+    struct Binding *psBinding;
+    void *pvNode;
+    void *pvValue;
+    size_t uLevel;
+    size_t i;
+    int iFound;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /* each node on the way down is first given more than the minimum
+       number of keys, so that a merge never has to climb back up */
+    SymTable_initProbe(&sProbe, pcKey, uLength);
+    pvNode = oSymTable->pvRoot;
+    uLevel = oSymTable->height;
+    while (uLevel > 0){
+        struct Inner *psInner = (struct Inner*)pvNode;
+        i = SymTable_childIndex(psInner, &sProbe);
+        if (SymTable_nodeCount(psInner->apvChildren[i], uLevel == 1) <=
+            (uLevel == 1 ? LEAF_MIN : INNER_MIN)){
+            SymTable_fillChild(oSymTable, psInner, i, uLevel == 1);
+            if (psInner->count == 0){
+                /* the root merged its last two children: the merged
+                   child becomes the root, and the tree loses a level */
+                assert(psInner == oSymTable->pvRoot);
+                oSymTable->pvRoot = psInner->apvChildren[0];
+                oSymTable->height--;
+                free(psInner);
+                pvNode = oSymTable->pvRoot;
+                uLevel--;
+                continue;
+            }
+            i = SymTable_childIndex(psInner, &sProbe);
+        }
+        pvNode = psInner->apvChildren[i];
+        uLevel--;
+    }
+
+    psLeaf = (struct Leaf*)pvNode;
+    i = SymTable_lowerBound(psLeaf, &sProbe, &iFound);
+    if (!iFound)
+        return NULL;
+    psBinding = psLeaf->apsBindings[i];
+    psLeaf->count--;
+    memmove(&psLeaf->auPrefix[i], &psLeaf->auPrefix[i + 1],
+            (psLeaf->count - i) * sizeof(unsigned long long));
+    memmove(&psLeaf->apsBindings[i], &psLeaf->apsBindings[i + 1],
+            (psLeaf->count - i) * sizeof(struct Binding *));
+    oSymTable->size--;
+
+    pvValue = psBinding->value;
+    SymTable_freeBinding(oSymTable, psBinding);
+    return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    assert(psKey != NULL);
+
+    return SymTable_removeN(oSymTable, psKey->pcKey, psKey->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable, const char *const apcKeys[],
+                       size_t uCount, void *apvValues[]){
+    size_t u;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL || uCount == 0);
+    assert(apvValues != NULL || uCount == 0);
+
+    /* the lookups share the upper levels of the tree, which the first
+       of them brings into the cache for the others */
+    for (u = 0; u < uCount; u++)
+        apvValues[u] = SymTable_get(oSymTable, apcKeys[u]);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable,
+                         const char *const apcKeys[], size_t uCount,
+                         const void *const apvValues[]){
+    size_t u;
+    size_t uAdded = 0;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL || uCount == 0);
+    assert(apvValues != NULL || uCount == 0);
+
+    for (u = 0; u < uCount; u++)
+        uAdded += (size_t)SymTable_put(oSymTable, apcKeys[u], apvValues[u]);
+    return uAdded;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+    struct Leaf *psLeaf;
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    /* along the leaves, in order of the keys */
+    for (psLeaf = SymTable_firstLeaf(oSymTable); psLeaf != NULL;
+         psLeaf = psLeaf->psNext)
+        for (i = 0; i < psLeaf->count; i++)
+            (*pfApply)(psLeaf->apsBindings[i]->key,
+                       psLeaf->apsBindings[i]->value, (void*)pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a call to SymTable_mapParallel, shared by the
+   workers that run it. */
+struct MapTask {
+    /* The leaves of the table, from left to right */
+    struct Leaf **apsLeaves;
+    /* The function to apply, and its extra parameter */
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot);
+    const void *pvExtra;
+    /* The slot of each worker, or NULL */
+    void *const *apvSlots;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the MapTask that pvTask points to to the
+   bindings of leaves uStart to uEnd-1 of its array, for worker
+   uWorker. */
+
+static void SymTable_mapRange(size_t uStart, size_t uEnd, size_t uWorker,
+                              void *pvTask)
+{
+    struct MapTask *psTask = (struct MapTask*)pvTask;
+    void *pvSlot;
+    size_t u;
+    size_t i;
+
+    assert(psTask != NULL);
+
+    pvSlot = psTask->apvSlots == NULL ? NULL : psTask->apvSlots[uWorker];
+    for (u = uStart; u < uEnd; u++){
+        struct Leaf *psLeaf = psTask->apsLeaves[u];
+        for (i = 0; i < psLeaf->count; i++)
+            (*psTask->pfApply)(psLeaf->apsBindings[i]->key,
+                               psLeaf->apsBindings[i]->value,
+                               (void*)psTask->pvExtra, pvSlot);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot),
+    const void *pvExtra, size_t uThreadCount, void *const apvSlots[]){
+    struct MapTask sTask;
+    struct Leaf *psLeaf;
+    size_t u = 0;
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    assert(uThreadCount > 0);
+
+    /* the leaves are the items shared out among the workers; they
+       are chained, so they are first gathered into an array */
+    sTask.apsLeaves = NULL;
+    if (uThreadCount > 1 && oSymTable->leafCount > 1 &&
+        oSymTable->leafCount <= (size_t)-1 / sizeof(struct Leaf *))
+        sTask.apsLeaves = (struct Leaf**)
+            malloc(oSymTable->leafCount * sizeof(struct Leaf *));
+    if (sTask.apsLeaves == NULL){
+        /* work alone */
+        for (psLeaf = SymTable_firstLeaf(oSymTable); psLeaf != NULL;
+             psLeaf = psLeaf->psNext)
+            for (i = 0; i < psLeaf->count; i++)
+                (*pfApply)(psLeaf->apsBindings[i]->key,
+                           psLeaf->apsBindings[i]->value, (void*)pvExtra,
+                           apvSlots == NULL ? NULL : apvSlots[0]);
+        return;
+    }
+
+    for (psLeaf = SymTable_firstLeaf(oSymTable); psLeaf != NULL;
+         psLeaf = psLeaf->psNext)
+        sTask.apsLeaves[u++] = psLeaf;
+    assert(u == oSymTable->leafCount);
+    sTask.pfApply = pfApply;
+    sTask.pvExtra = pvExtra;
+    sTask.apvSlots = apvSlots;
+    SymPar_run(u, uThreadCount, SymTable_mapRange, &sTask);
+    free(sTask.apsLeaves);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter){
+    assert(oSymTable != NULL);
+    assert(psIter != NULL);
+
+    psIter->oSymTable = oSymTable;
+    psIter->uPart = 0;
+    psIter->uIndex = 0;
+    psIter->pvNext = SymTable_firstLeaf(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTable_Iter *psIter, const char **ppcKey,
+                      void **ppvValue){
+    struct Leaf *psLeaf;
+    struct Binding *psBinding;
+
+    assert(psIter != NULL);
+    assert(psIter->oSymTable != NULL);
+
+    /* pvNext is the current leaf, and uIndex the next binding in it */
+    psLeaf = (struct Leaf*)psIter->pvNext;
+    while (psLeaf != NULL && psIter->uIndex == psLeaf->count){
+        psLeaf = psLeaf->psNext;
+        psIter->uIndex = 0;
+    }
+    psIter->pvNext = psLeaf;
+    if (psLeaf == NULL)
+        return 0;
+
+    psBinding = psLeaf->apsBindings[psIter->uIndex++];
+    if (ppcKey != NULL)
+        *ppcKey = psBinding->key;
+    if (ppvValue != NULL)
+        *ppvValue = psBinding->value;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTable_Iter *psIter){
+    assert(psIter != NULL);
+
+    /* nothing was acquired */
+    psIter->oSymTable = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_range(SymTable_T oSymTable, const char *pcLow,
+                    const char *pcHigh,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                    const void *pvExtra){
+    struct Probe sLow;
+    struct Probe sHigh;
+    struct Leaf *psLeaf;
+    size_t i = 0;
+    int iFound;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    /* down to the first binding not less than pcLow, then along the
+       leaves until one not less than pcHigh */
+    if (pcLow != NULL){
+        SymTable_initProbe(&sLow, pcLow, strlen(pcLow));
+        psLeaf = SymTable_findLeaf(oSymTable, &sLow);
+        i = SymTable_lowerBound(psLeaf, &sLow, &iFound);
+    }
+    else psLeaf = SymTable_firstLeaf(oSymTable);
+    if (pcHigh != NULL)
+        SymTable_initProbe(&sHigh, pcHigh, strlen(pcHigh));
+
+    for (; psLeaf != NULL; psLeaf = psLeaf->psNext, i = 0)
+        for (; i < psLeaf->count; i++){
+            if (pcHigh != NULL &&
+                SymTable_compare(&sHigh, psLeaf->auPrefix[i],
+                                 psLeaf->apsBindings[i]) <= 0)
+                return;
+            (*pfApply)(psLeaf->apsBindings[i]->key,
+                       psLeaf->apsBindings[i]->value, (void*)pvExtra);
+        }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_prefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                     const void *pvExtra){
+    struct Probe sPrefix;
+    struct Leaf *psLeaf;
+    size_t i;
+    int iFound;
+
+    assert(oSymTable != NULL);
+    assert(pcPrefix != NULL);
+    assert(pfApply != NULL);
+
+    /* the keys that begin with pcPrefix follow one another from the
+       first key not less than pcPrefix */
+    SymTable_initProbe(&sPrefix, pcPrefix, strlen(pcPrefix));
+    psLeaf = SymTable_findLeaf(oSymTable, &sPrefix);
+    i = SymTable_lowerBound(psLeaf, &sPrefix, &iFound);
+    for (; psLeaf != NULL; psLeaf = psLeaf->psNext, i = 0)
+        for (; i < psLeaf->count; i++){
+            struct Binding *psBinding = psLeaf->apsBindings[i];
+            if (psBinding->keyLength < sPrefix.uLength ||
+                memcmp(psBinding->key, pcPrefix, sPrefix.uLength) != 0)
+                return;
+            (*pfApply)(psBinding->key, psBinding->value, (void*)pvExtra);
+        }
+}
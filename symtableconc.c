@@ -0,0 +1,1633 @@
+/*--------------------------------------------------------------------*/
+/* symtableconc.c                                                     */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "symtable.h"
+#include "symtableconc.h"
+#include "symhash.h"
+#include "sympar.h"
+#ifndef SYMTABLE_MALLOC
+#include "sympool.h"
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable object that may be used by several threads at once. The
+   buckets are divided into STRIPE_COUNT stripes, each guarded by its
+   own reader/writer lock: lookups of keys in different stripes never
+   wait for each other, and lookups in the same stripe only wait for
+   writers.
+
+   A key's stripe depends only on its hash code, never on the bucket
+   count: the bucket count is always the stripe count times a power of
+   2, and the bucket of hash code uHash among uBucketCount buckets is
+   uHash * uBucketCount / 2^(bits in size_t), so the buckets of a
+   stripe are consecutive and stay in the stripe as the table grows.
+   Resizing write-locks every stripe (in order), so any operation that
+   holds a stripe lock sees a stable bucket array.
+
+   A table made by SymTable_newSharded holds no buckets itself, but
+   splits its keys among independent tables (shards) with one stripe
+   each, by the high bits of their hash codes. Each shard then uses the
+   bits below those, so that its keys still fill all of its buckets.
+   Shards grow one at a time, so a resize blocks only the updates and
+   lookups of one shard.
+
+   Built with SYMTABLE_LOCKFREE_READS, lookups take no lock at all, for
+   tables that are read far more often than they are updated. Updates
+   still lock their stripe, and publish every change to the buckets
+   with a single release store, so that a lookup running at the same
+   time sees each chain either before or after the change. A resize
+   relinks the bindings into a new bucket array, and bumps a sequence
+   number before and after, so that a lookup that missed during a
+   resize can tell and retry. Removed Bindings and replaced bucket
+   arrays stay allocated until no lookup can still be reading them,
+   which epoch-based reclamation detects: each thread that reads a
+   table records the global epoch while it does, and memory retired in
+   epoch e is released once the epoch has advanced to e+2, which needs
+   every reading thread to have seen e+1. */
+
+/* Number of stripes (and locks) of a table that is not sharded. */
+enum {STRIPE_COUNT = 64};
+
+/* Number of buckets per stripe of a new SymTable. */
+enum {INIT_BUCKETS_PER_STRIPE = 8};
+
+/* Size of the cache line that separates the locks of the stripes. */
+enum {CACHE_LINE_SIZE = 64};
+
+#ifdef SYMTABLE_LOCKFREE_READS
+#ifndef __GNUC__
+#error "SYMTABLE_LOCKFREE_READS needs the __atomic builtins of GCC"
+#endif
+/* Number of removed Bindings a stripe keeps before it tries to
+   release some of them. */
+enum {RECLAIM_THRESHOLD = 64};
+
+/* Read and write a field that lock-free lookups read concurrently:
+   every change is a release store, and every read an acquire load. */
+#define LOAD_SHARED(field) __atomic_load_n(&(field), __ATOMIC_ACQUIRE)
+#define STORE_SHARED(field, value) \
+    __atomic_store_n(&(field), (value), __ATOMIC_RELEASE)
+#else
+#define LOAD_SHARED(field) (field)
+#define STORE_SHARED(field, value) ((field) = (value))
+#endif
+
+/* Each key-value pair is stored in a Binding, and points to next Binding.
+   The key is stored at the end of the Binding itself. */
+struct Binding {
+    /* The value. */
+    void *value;
+    /* The full hash code of the key, so that a resize does not rehash
+       keys and probes only compare keys whose hash codes match. */
+    size_t hash;
+    /* The length of the key, compared before the key itself. */
+    size_t keyLength;
+    /* The address of the next Binding of the same bucket. */
+    struct Binding *pNextBinding;
+#ifdef SYMTABLE_LOCKFREE_READS
+    /* Once removed, the next removed Binding of the stripe, and the
+       epoch in which this one was removed. */
+    struct Binding *pNextRetired;
+    size_t retireEpoch;
+#endif
+    /* The key (a defensive copy of the client's key). */
+    char key[];
+};
+
+/* An array of buckets. The count travels with the array, so that a
+   lock-free lookup never pairs an array with the count of another. */
+struct Buckets {
+    /* Number of buckets, the stripe count times a power of 2 */
+    size_t count;
+#ifdef SYMTABLE_LOCKFREE_READS
+    /* Once replaced, the next replaced array of the table, and the
+       epoch in which this one was replaced */
+    struct Buckets *pNextRetired;
+    size_t retireEpoch;
+#endif
+    /* The first Binding of each bucket */
+    struct Binding *first[];
+};
+
+/* A stripe: a lock and the state it guards, besides the buckets. */
+struct Stripe {
+    /* Read-locked by lookups, write-locked by updates of the stripe
+       and by resizes */
+    pthread_rwlock_t lock;
+    /* Number of bindings in the buckets of the stripe */
+    size_t size;
+#ifndef SYMTABLE_MALLOC
+    /* Allocator of the Bindings of the stripe (unless built with
+       SYMTABLE_MALLOC, which allocates each Binding with malloc).
+       A Binding never leaves its stripe, so it is always returned
+       to the pool it came from. */
+    SymPool_T pool;
+#endif
+#ifdef SYMTABLE_LOCKFREE_READS
+    /* Removed Bindings that lookups may still be reading, and their
+       number */
+    struct Binding *retired;
+    size_t retiredCount;
+#endif
+    /* Keeps the locks of different stripes in different cache lines,
+       so that threads working on different stripes do not contend */
+    char acPadding[CACHE_LINE_SIZE];
+};
+
+/* A SymTable structure symbol table implemented with hash buckets that
+   contain bindings, safe for concurrent use. */
+struct SymTable {
+    /* Array of stripes, and their number */
+    struct Stripe *stripes;
+    size_t stripeCount;
+    /* Array of bindings, replaced only with every stripe locked */
+    struct Buckets *buckets;
+#ifdef SYMTABLE_LOCKFREE_READS
+    /* Even while no resize is in progress, odd during one */
+    size_t resizeSequence;
+    /* Replaced bucket arrays that lookups may still be reading */
+    struct Buckets *retiredBuckets;
+#endif
+    /* Hash function applied to keys */
+    enum SymTable_HashFunction hashFunction;
+    /* For a sharded table, the array of shards and their number, and
+       no stripes or buckets; otherwise NULL and 0 */
+    SymTable_T *shards;
+    size_t shardCount;
+};
+
+#ifdef SYMTABLE_LOCKFREE_READS
+/* The record of a thread that makes lock-free lookups, shared by all
+   SymTable objects. Records are never freed: when a thread exits, its
+   record is left for the next new thread. */
+struct Reader {
+    /* The global epoch when the current lookup began, or 0 if the
+       thread is not looking up a key */
+    size_t epoch;
+    /* 1 (TRUE) if a thread owns the record, or 0 (FALSE) otherwise */
+    int inUse;
+    /* The next record */
+    struct Reader *pNextReader;
+    /* Keeps the records of different threads in different cache
+       lines, so that readers never write to a shared line */
+    char acPadding[CACHE_LINE_SIZE];
+};
+
+/* The global epoch, which starts at 1 and only grows */
+static size_t uGlobalEpoch = 1;
+
+/* All reader records; new ones are added at the front */
+static struct Reader *psReaders = NULL;
+
+/* Serializes the assignment of records to threads */
+static pthread_mutex_t readersMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Thread-specific data key of the record of each thread */
+static pthread_key_t readerKey;
+static pthread_once_t readerKeyOnce = PTHREAD_ONCE_INIT;
+static int iReaderKeyCreated = 0;
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Return a hash code for the key of the handle *psKey, computed with
+   the hash function of oSymTable. Stripes and buckets are chosen by
+   the high bits of the code, so the multiplicative hash is followed
+   by a finalizer; the wide hash is well distributed already. */
+
+static size_t SymTable_hash(SymTable_T oSymTable, SymTable_Key *psKey)
+{
+    unsigned long long ullHash;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    ullHash = SymHash_keyHash(psKey, oSymTable->hashFunction);
+    if (oSymTable->hashFunction != SYMTABLE_HASH_MULTIPLICATIVE)
+        return (size_t)ullHash;
+
+    /* 64-bit finalizer from MurmurHash3 */
+    ullHash ^= ullHash >> 33;
+    ullHash *= 0xff51afd7ed558ccdULL;
+    ullHash ^= ullHash >> 33;
+    ullHash *= 0xc4ceb9fe1a85ec53ULL;
+    ullHash ^= ullHash >> 33;
+    return (size_t)ullHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the stripe of oSymTable that holds the keys with hash code
+   uHash. */
+
+static struct Stripe *SymTable_stripe(SymTable_T oSymTable, size_t uHash)
+{
+    assert(oSymTable != NULL);
+
+    return &oSymTable->stripes[
+        SymHash_fastRange(uHash, oSymTable->stripeCount)];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable is sharded, return the shard that holds the keys with
+   hash code *puHash, and replace *puHash with the hash code that the
+   shard uses: the bits below those that chose the shard. Otherwise,
+   return oSymTable. */
+
+static SymTable_T SymTable_shard(SymTable_T oSymTable, size_t *puHash)
+{
+    size_t uHash;
+
+    assert(oSymTable != NULL);
+    assert(puHash != NULL);
+
+    if (oSymTable->shards == NULL)
+        return oSymTable;
+    uHash = *puHash;
+    *puHash = uHash * oSymTable->shardCount;
+    return oSymTable->shards[
+        SymHash_fastRange(uHash, oSymTable->shardCount)];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Lock every stripe of oSymTable (of every shard, if it is sharded),
+   for writing if iForWriting, or else for reading. Stripes are always
+   locked in the same order, so that two threads locking all of them
+   cannot deadlock. */
+
+static void SymTable_lockAll(SymTable_T oSymTable, int iForWriting)
+{
+    size_t i;
+
+    assert(oSymTable != NULL);
+
+    for (i = 0; i < oSymTable->shardCount; i++)
+        SymTable_lockAll(oSymTable->shards[i], iForWriting);
+    for (i = 0; i < oSymTable->stripeCount; i++){
+        if (iForWriting)
+            pthread_rwlock_wrlock(&oSymTable->stripes[i].lock);
+        else pthread_rwlock_rdlock(&oSymTable->stripes[i].lock);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Unlock every stripe of oSymTable locked by SymTable_lockAll. */
+
+static void SymTable_unlockAll(SymTable_T oSymTable)
+{
+    size_t i;
+
+    assert(oSymTable != NULL);
+
+    for (i = oSymTable->stripeCount; i > 0; i--)
+        pthread_rwlock_unlock(&oSymTable->stripes[i - 1].lock);
+    for (i = oSymTable->shardCount; i > 0; i--)
+        SymTable_unlockAll(oSymTable->shards[i - 1]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new bucket array of uCount empty buckets, or NULL if
+   insufficient memory is available. */
+
+static struct Buckets *SymTable_newBuckets(size_t uCount)
+{
+    struct Buckets *psBuckets;
+
+    if (uCount > ((size_t)-1 - sizeof(struct Buckets)) /
+        sizeof(struct Binding *))
+        return NULL;
+    psBuckets = (struct Buckets*)calloc(1, sizeof(struct Buckets) +
+                                        uCount * sizeof(struct Binding *));
+    if (psBuckets == NULL)
+        return NULL;
+    psBuckets->count = uCount;
+    return psBuckets;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the link (bucket entry or pNextBinding field)
+   that points to the binding of oSymTable whose key is that of the
+   handle *psKey, or NULL if no such binding exists. uHash is the hash
+   code of the key. The caller must hold the lock of its stripe. */
+
+static struct Binding **SymTable_findLink(SymTable_T oSymTable,
+                                          const SymTable_Key *psKey,
+                                          size_t uHash)
+{
+    struct Buckets *psBuckets;
+    struct Binding **ppLink;
+    struct Binding *psBinding;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    psBuckets = oSymTable->buckets;
+    ppLink = &psBuckets->first[SymHash_fastRange(uHash, psBuckets->count)];
+    while ((psBinding = LOAD_SHARED(*ppLink)) != NULL){
+        if (psBinding->hash == uHash &&
+            psBinding->keyLength == psKey->uLength &&
+            memcmp(psKey->pcKey, psBinding->key, psKey->uLength) == 0)
+            return ppLink;
+        ppLink = &psBinding->pNextBinding;
+    }
+    return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a binding of the key of the handle *psKey, whose hash code is
+   uHash and which oSymTable does not contain, with value pvValue to
+   psStripe, the stripe of the key, whose lock the caller must hold
+   for writing. Return the new binding, or NULL if insufficient memory
+   is available. */
+
+static struct Binding *SymTable_addBinding(SymTable_T oSymTable,
+                                           struct Stripe *psStripe,
+                                           const SymTable_Key *psKey,
+                                           size_t uHash,
+                                           const void *pvValue)
+{
+    struct Binding *newBinding;
+    struct Binding **ppFirst;
+    size_t uSize;
+
+    assert(oSymTable != NULL);
+    assert(psStripe != NULL);
+    assert(psKey != NULL);
+
+    uSize = sizeof(struct Binding) + psKey->uLength + 1;
+#ifdef SYMTABLE_MALLOC
+    newBinding = (struct Binding*)malloc(uSize);
+#else
+    newBinding = (struct Binding*)SymPool_alloc(psStripe->pool, uSize);
+#endif
+    if (newBinding == NULL)
+        return NULL;
+
+    memcpy(newBinding->key, psKey->pcKey, psKey->uLength);
+    newBinding->key[psKey->uLength] = '\0';
+    newBinding->value = (void*) pvValue;
+    newBinding->hash = uHash;
+    newBinding->keyLength = psKey->uLength;
+
+    /* the Binding is complete before lookups can reach it */
+    ppFirst = &oSymTable->buckets->first[
+        SymHash_fastRange(uHash, oSymTable->buckets->count)];
+    newBinding->pNextBinding = *ppFirst;
+    STORE_SHARED(*ppFirst, newBinding);
+    psStripe->size++;
+    return newBinding;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Release psBinding, which belongs to psStripe, whose lock the caller
+   must hold for writing. */
+
+static void SymTable_freeBinding(struct Stripe *psStripe,
+                                 struct Binding *psBinding)
+{
+    assert(psStripe != NULL);
+    assert(psBinding != NULL);
+#ifdef SYMTABLE_MALLOC
+    (void)psStripe;
+    free(psBinding);
+#else
+    SymPool_release(psStripe->pool, psBinding,
+                    sizeof(struct Binding) + psBinding->keyLength + 1);
+#endif
+}
+
+#ifdef SYMTABLE_LOCKFREE_READS
+/*--------------------------------------------------------------------*/
+
+/* Mark the reader record pvReader free for another thread. Called
+   when the thread that owns it exits. */
+
+static void SymTable_releaseReader(void *pvReader)
+{
+    struct Reader *psReader = (struct Reader*)pvReader;
+
+    assert(psReader != NULL);
+
+    pthread_mutex_lock(&readersMutex);
+    __atomic_store_n(&psReader->epoch, 0, __ATOMIC_RELEASE);
+    psReader->inUse = 0;
+    pthread_mutex_unlock(&readersMutex);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Create the thread-specific data key of the reader records. */
+
+static void SymTable_createReaderKey(void)
+{
+    iReaderKeyCreated =
+        pthread_key_create(&readerKey, SymTable_releaseReader) == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the reader record of the calling thread, assigning one to it
+   first if necessary, or NULL if insufficient memory is available. */
+
+static struct Reader *SymTable_getReader(void)
+{
+    struct Reader *psReader;
+
+    pthread_once(&readerKeyOnce, SymTable_createReaderKey);
+    if (!iReaderKeyCreated)
+        return NULL;
+    psReader = (struct Reader*)pthread_getspecific(readerKey);
+    if (psReader != NULL)
+        return psReader;
+
+    /* reuse the record of a thread that has exited, if any */
+    pthread_mutex_lock(&readersMutex);
+    for (psReader = psReaders; psReader != NULL;
+         psReader = psReader->pNextReader)
+        if (!psReader->inUse)
+            break;
+    if (psReader == NULL){
+        psReader = (struct Reader*)malloc(sizeof(struct Reader));
+        if (psReader != NULL){
+            psReader->epoch = 0;
+            psReader->pNextReader = psReaders;
+            STORE_SHARED(psReaders, psReader);
+        }
+    }
+    if (psReader != NULL){
+        psReader->inUse = 1;
+        if (pthread_setspecific(readerKey, psReader) != 0){
+            psReader->inUse = 0;
+            psReader = NULL;
+        }
+    }
+    pthread_mutex_unlock(&readersMutex);
+    return psReader;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Begin a lock-free lookup by the calling thread. Return its reader
+   record, to be passed to SymTable_exitRead, or NULL if the thread
+   has none, in which case it must look up keys with locks. */
+
+static struct Reader *SymTable_enterRead(void)
+{
+    struct Reader *psReader = SymTable_getReader();
+
+    if (psReader == NULL)
+        return NULL;
+    /* one store to the thread's own record: no lock, and nothing
+       written to a line that other readers share. It is sequentially
+       consistent, so that the lookup's first load (of the resize
+       sequence) cannot move before it, and costs less than a separate
+       fence. */
+    __atomic_store_n(&psReader->epoch,
+                     __atomic_load_n(&uGlobalEpoch, __ATOMIC_RELAXED),
+                     __ATOMIC_SEQ_CST);
+    return psReader;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* End the lock-free lookup of the thread whose record is *psReader. */
+
+static void SymTable_exitRead(struct Reader *psReader)
+{
+    assert(psReader != NULL);
+
+    __atomic_store_n(&psReader->epoch, 0, __ATOMIC_RELEASE);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Advance the global epoch if every thread in a lookup has seen its
+   current value. Return the global epoch. */
+
+static size_t SymTable_advanceEpoch(void)
+{
+    struct Reader *psReader;
+    size_t uEpoch;
+    size_t uReaderEpoch;
+
+    uEpoch = __atomic_load_n(&uGlobalEpoch, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (psReader = LOAD_SHARED(psReaders); psReader != NULL;
+         psReader = psReader->pNextReader){
+        uReaderEpoch = __atomic_load_n(&psReader->epoch, __ATOMIC_ACQUIRE);
+        if (uReaderEpoch != 0 && uReaderEpoch != uEpoch)
+            return uEpoch;
+    }
+    /* if another thread advanced it first, uEpoch gets its value */
+    if (__atomic_compare_exchange_n(&uGlobalEpoch, &uEpoch, uEpoch + 1, 0,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+        uEpoch++;
+    return uEpoch;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the global epoch in which memory unlinked from a table just
+   now is retired. */
+
+static size_t SymTable_retireEpoch(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return __atomic_load_n(&uGlobalEpoch, __ATOMIC_SEQ_CST);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Release the removed Bindings of psStripe that no lookup can still
+   be reading. The caller must hold the lock of psStripe for writing. */
+
+static void SymTable_reclaim(struct Stripe *psStripe)
+{
+    struct Binding **ppRetired;
+    struct Binding *psBinding;
+    size_t uEpoch;
+
+    assert(psStripe != NULL);
+
+    uEpoch = SymTable_advanceEpoch();
+    ppRetired = &psStripe->retired;
+    while ((psBinding = *ppRetired) != NULL){
+        if (psBinding->retireEpoch + 2 <= uEpoch){
+            *ppRetired = psBinding->pNextRetired;
+            SymTable_freeBinding(psStripe, psBinding);
+            psStripe->retiredCount--;
+        }
+        else ppRetired = &psBinding->pNextRetired;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Retire psBinding, which the caller has just unlinked from psStripe,
+   whose lock it holds for writing: release it once no lookup can
+   still be reading it. */
+
+static void SymTable_retireBinding(struct Stripe *psStripe,
+                                   struct Binding *psBinding)
+{
+    assert(psStripe != NULL);
+    assert(psBinding != NULL);
+
+    psBinding->retireEpoch = SymTable_retireEpoch();
+    psBinding->pNextRetired = psStripe->retired;
+    psStripe->retired = psBinding;
+    if (++psStripe->retiredCount >= RECLAIM_THRESHOLD)
+        SymTable_reclaim(psStripe);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the binding of oSymTable whose key is that of the handle
+   *psKey, or NULL if no such binding exists, without taking a lock.
+   uHash is the hash code of the key. The caller must be in a lookup
+   begun with SymTable_enterRead. */
+
+static struct Binding *SymTable_findLockFree(SymTable_T oSymTable,
+                                             const SymTable_Key *psKey,
+                                             size_t uHash)
+{
+    struct Buckets *psBuckets;
+    struct Binding *psBinding;
+    size_t uSequence;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    for (;;){
+        uSequence = __atomic_load_n(&oSymTable->resizeSequence,
+                                    __ATOMIC_SEQ_CST);
+        psBuckets = LOAD_SHARED(oSymTable->buckets);
+        psBinding = LOAD_SHARED(psBuckets->first[
+            SymHash_fastRange(uHash, psBuckets->count)]);
+        while (psBinding != NULL){
+            if (psBinding->hash == uHash &&
+                psBinding->keyLength == psKey->uLength &&
+                memcmp(psKey->pcKey, psBinding->key, psKey->uLength) == 0)
+                return psBinding;
+            psBinding = LOAD_SHARED(psBinding->pNextBinding);
+        }
+
+        /* a resize may have moved the binding to a chain that this
+           lookup did not follow: a miss is only certain if no resize
+           overlapped it */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (uSequence % 2 == 0 &&
+            __atomic_load_n(&oSymTable->resizeSequence,
+                            __ATOMIC_RELAXED) == uSequence)
+            return NULL;
+    }
+}
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if psStripe, whose lock the caller holds, has more
+   bindings than oSymTable has buckets per stripe, so that the table
+   should grow, or 0 (FALSE) otherwise. */
+
+static int SymTable_stripeIsFull(SymTable_T oSymTable,
+                                 const struct Stripe *psStripe)
+{
+    assert(oSymTable != NULL);
+    assert(psStripe != NULL);
+
+    return psStripe->size >
+        oSymTable->buckets->count / oSymTable->stripeCount &&
+        oSymTable->buckets->count <=
+            ((size_t)-1 / sizeof(struct Binding *)) / 2;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Relink every Binding of oSymTable, which is not sharded, into 
+   newBuckets, make newBuckets its bucket array, and release (or, 
+   with lock-free lookups, retire) the previous one. The caller must
+   hold every stripe lock for writing. */
+
+static void SymTable_moveBindings(SymTable_T oSymTable,
+                                  struct Buckets *newBuckets)
+{
+    struct Buckets *oldBuckets;
+    size_t index;
+
+    assert(oSymTable != NULL);
+    assert(newBuckets != NULL);
+
+    oldBuckets = oSymTable->buckets;
+#ifdef SYMTABLE_LOCKFREE_READS
+    __atomic_store_n(&oSymTable->resizeSequence,
+                     oSymTable->resizeSequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+    for (index = 0; index < oldBuckets->count; index++){
+        struct Binding *currentBind = oldBuckets->first[index];
+        while (currentBind != NULL){
+            struct Binding *pNext = currentBind->pNextBinding;
+            struct Binding **ppFirst = &newBuckets->first[
+                SymHash_fastRange(currentBind->hash,
+                                  newBuckets->count)];
+            STORE_SHARED(currentBind->pNextBinding, *ppFirst);
+            *ppFirst = currentBind;
+            currentBind = pNext;
+        }
+    }
+    STORE_SHARED(oSymTable->buckets, newBuckets);
+#ifdef SYMTABLE_LOCKFREE_READS
+    __atomic_store_n(&oSymTable->resizeSequence,
+                     oSymTable->resizeSequence + 1, __ATOMIC_RELEASE);
+
+    /* release the arrays that no lookup can still be reading */
+    {
+        struct Buckets **ppRetired = &oSymTable->retiredBuckets;
+        size_t uEpoch = SymTable_advanceEpoch();
+        while (*ppRetired != NULL){
+            struct Buckets *psRetired = *ppRetired;
+            if (psRetired->retireEpoch + 2 <= uEpoch){
+                *ppRetired = psRetired->pNextRetired;
+                free(psRetired);
+            }
+            else ppRetired = &psRetired->pNextRetired;
+        }
+    }
+    oldBuckets->retireEpoch = SymTable_retireEpoch();
+    oldBuckets->pNextRetired = oSymTable->retiredBuckets;
+    oSymTable->retiredBuckets = oldBuckets;
+#else
+    free(oldBuckets);
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Double the bucket count of oSymTable, relinking the existing
+   Bindings, unless another thread has already grown it past
+   uOldBucketCount. The caller must hold no stripe lock. If
+   insufficient memory is available, oSymTable keeps its buckets (it
+   is still correct, only slower). */
+
+static void SymTable_grow(SymTable_T oSymTable, size_t uOldBucketCount)
+{
+    struct Buckets *newBuckets = NULL;
+
+    assert(oSymTable != NULL);
+
+    SymTable_lockAll(oSymTable, 1);
+    if (oSymTable->buckets->count == uOldBucketCount)
+        newBuckets = SymTable_newBuckets(2 * uOldBucketCount);
+    if (newBuckets != NULL)
+        SymTable_moveBindings(oSymTable, newBuckets);
+    SymTable_unlockAll(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of buckets, the initial number for uStripeCount
+   stripes times a power of two, that a table with uStripeCount 
+   stripes needs to hold uCapacity bindings without growing. Since the
+   table grows as soon as one stripe holds more bindings than it has 
+   buckets, and the bindings do not spread over the stripes exactly
+   evenly, the count leaves a quarter more room than uCapacity. */
+
+static size_t SymTable_capacityBucketCount(size_t uStripeCount,
+                                           size_t uCapacity)
+{
+    const size_t MAX_BUCKET_COUNT =
+        ((size_t)-1 / sizeof(struct Binding *)) / 2;
+    size_t uBucketCount = uStripeCount * INIT_BUCKETS_PER_STRIPE;
+    size_t uTarget = uCapacity + uCapacity / 4;
+
+    assert(uStripeCount > 0);
+
+    if (uTarget < uCapacity)
+        uTarget = (size_t)-1;
+    while (uBucketCount < uTarget && uBucketCount <= MAX_BUCKET_COUNT)
+        uBucketCount *= 2;
+    return uBucketCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable object that contains no bindings, hashes its
+   keys with eHash and has uStripeCount stripes sharing uBucketCount 
+   buckets, a multiple of uStripeCount, or NULL if insufficient memory
+   is available. */
+
+static SymTable_T SymTable_newStriped(enum SymTable_HashFunction eHash,
+                                      size_t uStripeCount,
+                                      size_t uBucketCount)
+{
+    SymTable_T oSymTable;
+    size_t i;
+
+    assert(uStripeCount > 0);
+    assert(uBucketCount % uStripeCount == 0);
+
+    oSymTable = (SymTable_T) malloc(sizeof(struct SymTable));
+    if (oSymTable == NULL)
+        return NULL;
+
+    oSymTable->stripes = (struct Stripe*)
+        malloc(uStripeCount * sizeof(struct Stripe));
+    oSymTable->buckets = SymTable_newBuckets(uBucketCount);
+    if (oSymTable->stripes == NULL || oSymTable->buckets == NULL){
+        free(oSymTable->stripes);
+        free(oSymTable->buckets);
+        free(oSymTable);
+        return NULL;
+    }
+
+    for (i = 0; i < uStripeCount; i++){
+        struct Stripe *psStripe = &oSymTable->stripes[i];
+        int iFailed = pthread_rwlock_init(&psStripe->lock, NULL) != 0;
+#ifndef SYMTABLE_MALLOC
+        if (!iFailed){
+            psStripe->pool = SymPool_new();
+            if (psStripe->pool == NULL){
+                pthread_rwlock_destroy(&psStripe->lock);
+                iFailed = 1;
+            }
+        }
+#endif
+        if (iFailed){
+            /* undo the stripes already set up */
+            while (i-- > 0){
+#ifndef SYMTABLE_MALLOC
+                SymPool_free(oSymTable->stripes[i].pool);
+#endif
+                pthread_rwlock_destroy(&oSymTable->stripes[i].lock);
+            }
+            free(oSymTable->stripes);
+            free(oSymTable->buckets);
+            free(oSymTable);
+            return NULL;
+        }
+        psStripe->size = 0;
+#ifdef SYMTABLE_LOCKFREE_READS
+        psStripe->retired = NULL;
+        psStripe->retiredCount = 0;
+#endif
+    }
+
+#ifdef SYMTABLE_LOCKFREE_READS
+    oSymTable->resizeSequence = 0;
+    oSymTable->retiredBuckets = NULL;
+#endif
+    oSymTable->stripeCount = uStripeCount;
+    oSymTable->hashFunction = eHash;
+    oSymTable->shards = NULL;
+    oSymTable->shardCount = 0;
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void){
+    return SymTable_newWithHash(SYMTABLE_HASH_MULTIPLICATIVE);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithHash(enum SymTable_HashFunction eHash){
+    return SymTable_newStriped(eHash, STRIPE_COUNT,
+                               STRIPE_COUNT * INIT_BUCKETS_PER_STRIPE);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity){
+    return SymTable_newStriped(SYMTABLE_HASH_MULTIPLICATIVE, STRIPE_COUNT,
+        SymTable_capacityBucketCount(STRIPE_COUNT, uCapacity));
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newSharded(size_t uShardCount){
+    SymTable_T oSymTable;
+    size_t i;
+
+    assert(uShardCount > 0);
+
+    oSymTable = (SymTable_T) malloc(sizeof(struct SymTable));
+    if (oSymTable == NULL)
+        return NULL;
+    oSymTable->shards = uShardCount > (size_t)-1 / sizeof(SymTable_T) ?
+        NULL : (SymTable_T*) malloc(uShardCount * sizeof(SymTable_T));
+    if (oSymTable->shards == NULL){
+        free(oSymTable);
+        return NULL;
+    }
+
+    /* one stripe per shard: the shards themselves spread the locks */
+    for (i = 0; i < uShardCount; i++){
+        oSymTable->shards[i] =
+            SymTable_newStriped(SYMTABLE_HASH_MULTIPLICATIVE, 1,
+                                INIT_BUCKETS_PER_STRIPE);
+        if (oSymTable->shards[i] == NULL){
+            while (i-- > 0)
+                SymTable_free(oSymTable->shards[i]);
+            free(oSymTable->shards);
+            free(oSymTable);
+            return NULL;
+        }
+    }
+
+    oSymTable->stripes = NULL;
+    oSymTable->stripeCount = 0;
+    oSymTable->buckets = NULL;
+#ifdef SYMTABLE_LOCKFREE_READS
+    oSymTable->resizeSequence = 0;
+    oSymTable->retiredBuckets = NULL;
+#endif
+    oSymTable->hashFunction = SYMTABLE_HASH_MULTIPLICATIVE;
+    oSymTable->shardCount = uShardCount;
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable){
+    size_t i;
+#ifdef SYMTABLE_MALLOC
+    size_t index;
+#endif
+    assert(oSymTable != NULL);
+
+    if (oSymTable->shards != NULL){
+        for (i = 0; i < oSymTable->shardCount; i++)
+            SymTable_free(oSymTable->shards[i]);
+        free(oSymTable->shards);
+        free(oSymTable);
+        return;
+    }
+
+#ifdef SYMTABLE_MALLOC
+    for (index = 0; index < oSymTable->buckets->count; index++){
+        struct Binding *currentBind = oSymTable->buckets->first[index];
+        while (currentBind != NULL){
+            struct Binding *pCurrent = currentBind;
+            currentBind = currentBind->pNextBinding;
+            free(pCurrent);
+        }
+    }
+#ifdef SYMTABLE_LOCKFREE_READS
+    for (i = 0; i < oSymTable->stripeCount; i++){
+        struct Binding *currentBind = oSymTable->stripes[i].retired;
+        while (currentBind != NULL){
+            struct Binding *pCurrent = currentBind;
+            currentBind = currentBind->pNextRetired;
+            free(pCurrent);
+        }
+    }
+#endif
+#endif
+    /* every other binding lives in the pool of its stripe */
+    for (i = 0; i < oSymTable->stripeCount; i++){
+#ifndef SYMTABLE_MALLOC
+        SymPool_free(oSymTable->stripes[i].pool);
+#endif
+        pthread_rwlock_destroy(&oSymTable->stripes[i].lock);
+    }
+#ifdef SYMTABLE_LOCKFREE_READS
+    while (oSymTable->retiredBuckets != NULL){
+        struct Buckets *psRetired = oSymTable->retiredBuckets;
+        oSymTable->retiredBuckets = psRetired->pNextRetired;
+        free(psRetired);
+    }
+#endif
+    free(oSymTable->stripes);
+    free(oSymTable->buckets);
+    free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity){
+    struct Buckets *newBuckets;
+    size_t uBucketCount;
+    size_t i;
+    int iSuccessful = 1;
+
+    assert(oSymTable != NULL);
+
+    /* each shard reserves its share, rounded up, like it grows */
+    if (oSymTable->shards != NULL){
+        size_t uShare = uCapacity / oSymTable->shardCount +
+            (uCapacity % oSymTable->shardCount != 0);
+        for (i = 0; i < oSymTable->shardCount; i++)
+            if (!SymTable_reserve(oSymTable->shards[i], uShare))
+                iSuccessful = 0;
+        return iSuccessful;
+    }
+
+    /* tables never shrink, so only the bucket array needs to grow */
+    uBucketCount = SymTable_capacityBucketCount(oSymTable->stripeCount,
+                                                uCapacity);
+    SymTable_lockAll(oSymTable, 1);
+    if (uBucketCount > oSymTable->buckets->count){
+        newBuckets = SymTable_newBuckets(uBucketCount);
+        if (newBuckets == NULL)
+            iSuccessful = 0;
+        else SymTable_moveBindings(oSymTable, newBuckets);
+    }
+    SymTable_unlockAll(oSymTable);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_compact(SymTable_T oSymTable){
+    struct Buckets *newBuckets;
+    size_t uSize = 0;
+    size_t uBucketCount;
+    size_t i;
+    int iSuccessful = 1;
+
+    assert(oSymTable != NULL);
+
+    /* shards are compacted one at a time, like they grow */
+    if (oSymTable->shards != NULL){
+        for (i = 0; i < oSymTable->shardCount; i++)
+            if (!SymTable_compact(oSymTable->shards[i]))
+                iSuccessful = 0;
+        return iSuccessful;
+    }
+
+    /* the bucket count that putting the bindings would have reached.
+       The Bindings stay where they are, since a lock-free lookup may
+       be reading any of them. */
+    SymTable_lockAll(oSymTable, 1);
+    for (i = 0; i < oSymTable->stripeCount; i++)
+        uSize += oSymTable->stripes[i].size;
+    uBucketCount = oSymTable->stripeCount * INIT_BUCKETS_PER_STRIPE;
+    while (uBucketCount < uSize)
+        uBucketCount *= 2;
+    if (uBucketCount != oSymTable->buckets->count){
+        newBuckets = SymTable_newBuckets(uBucketCount);
+        if (newBuckets == NULL)
+            iSuccessful = 0;
+        else SymTable_moveBindings(oSymTable, newBuckets);
+    }
+    SymTable_unlockAll(oSymTable);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable){
+    size_t uLength = 0;
+    size_t i;
+
+    assert(oSymTable != NULL);
+
+    for (i = 0; i < oSymTable->shardCount; i++)
+        uLength += SymTable_getLength(oSymTable->shards[i]);
+
+    /* with other threads updating oSymTable, the sum is only as
+       current as the stripe read last */
+    for (i = 0; i < oSymTable->stripeCount; i++){
+        struct Stripe *psStripe = &oSymTable->stripes[i];
+        pthread_rwlock_rdlock(&psStripe->lock);
+        uLength += psStripe->size;
+        pthread_rwlock_unlock(&psStripe->lock);
+    }
+    return uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_initKey(SymTable_Key *psKey, const char *pcKey,
+                      size_t uLength){
+    assert(psKey != NULL);
+    assert(pcKey != NULL);
+
+    psKey->pcKey = pcKey;
+    psKey->uLength = uLength;
+    psKey->uHashMask = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey,
+                 const void *pvValue){
+    assert(pcKey != NULL);
+
+    return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+                  size_t uLength, const void *pvValue){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_putKey(oSymTable, &sKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putKey(SymTable_T oSymTable, SymTable_Key *psKey,
+                    const void *pvValue){
+    struct Stripe *psStripe;
+    size_t uHash;
+    size_t uBucketCount;
+    int iSuccessful = 0;
+    int iGrow = 0;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    uHash = SymTable_hash(oSymTable, psKey);
+    oSymTable = SymTable_shard(oSymTable, &uHash);
+    psStripe = SymTable_stripe(oSymTable, uHash);
+
+    pthread_rwlock_wrlock(&psStripe->lock);
+    if (SymTable_findLink(oSymTable, psKey, uHash) == NULL &&
+        SymTable_addBinding(oSymTable, psStripe, psKey, uHash,
+                            pvValue) != NULL){
+        iSuccessful = 1;
+        iGrow = SymTable_stripeIsFull(oSymTable, psStripe);
+    }
+    uBucketCount = oSymTable->buckets->count;
+    pthread_rwlock_unlock(&psStripe->lock);
+
+    /* growing needs every lock, so it waits until this one is free */
+    if (iGrow)
+        SymTable_grow(oSymTable, uBucketCount);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
+    const void *pvValue){
+    SymTable_Key sKey;
+
+    assert(pcKey != NULL);
+
+    SymTable_initKey(&sKey, pcKey, strlen(pcKey));
+    return SymTable_replaceKey(oSymTable, &sKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceKey(SymTable_T oSymTable, SymTable_Key *psKey,
+    const void *pvValue){
+    struct Stripe *psStripe;
+    struct Binding **ppLink;
+    size_t uHash;
+    void *oldValue = NULL;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    uHash = SymTable_hash(oSymTable, psKey);
+    oSymTable = SymTable_shard(oSymTable, &uHash);
+    psStripe = SymTable_stripe(oSymTable, uHash);
+
+    pthread_rwlock_wrlock(&psStripe->lock);
+    ppLink = SymTable_findLink(oSymTable, psKey, uHash);
+    if (ppLink != NULL){
+        oldValue = (*ppLink)->value;
+        STORE_SHARED((*ppLink)->value, (void*) pvValue);
+    }
+    pthread_rwlock_unlock(&psStripe->lock);
+    return oldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey,
+                    const void *pvValue){
+    SymTable_Key sKey;
+    struct Stripe *psStripe;
+    struct Binding **ppLink;
+    size_t uHash;
+    size_t uBucketCount;
+    int iSuccessful = 1;
+    int iGrow = 0;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    SymTable_initKey(&sKey, pcKey, strlen(pcKey));
+    uHash = SymTable_hash(oSymTable, &sKey);
+    oSymTable = SymTable_shard(oSymTable, &uHash);
+    psStripe = SymTable_stripe(oSymTable, uHash);
+
+    /* unlike SymTable_getOrInsert, the value is stored while the
+       stripe is still locked */
+    pthread_rwlock_wrlock(&psStripe->lock);
+    ppLink = SymTable_findLink(oSymTable, &sKey, uHash);
+    if (ppLink != NULL)
+        STORE_SHARED((*ppLink)->value, (void*) pvValue);
+    else if (SymTable_addBinding(oSymTable, psStripe, &sKey, uHash,
+                                 pvValue) != NULL)
+        iGrow = SymTable_stripeIsFull(oSymTable, psStripe);
+    else iSuccessful = 0;
+    uBucketCount = oSymTable->buckets->count;
+    pthread_rwlock_unlock(&psStripe->lock);
+
+    if (iGrow)
+        SymTable_grow(oSymTable, uBucketCount);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable, const char *pcKey,
+                            const void *pvValue){
+    SymTable_Key sKey;
+    struct Stripe *psStripe;
+    struct Binding **ppLink;
+    struct Binding *psBinding = NULL;
+    size_t uHash;
+    size_t uBucketCount;
+    int iGrow = 0;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    SymTable_initKey(&sKey, pcKey, strlen(pcKey));
+    uHash = SymTable_hash(oSymTable, &sKey);
+    oSymTable = SymTable_shard(oSymTable, &uHash);
+    psStripe = SymTable_stripe(oSymTable, uHash);
+
+    /* the binding does not move when the table grows, but another
+       thread may remove it: the caller must rule that out for as
+       long as it uses the address, and must not store through it
+       while other threads may be reading the key */
+    pthread_rwlock_wrlock(&psStripe->lock);
+    ppLink = SymTable_findLink(oSymTable, &sKey, uHash);
+    if (ppLink != NULL)
+        psBinding = *ppLink;
+    else {
+        psBinding = SymTable_addBinding(oSymTable, psStripe, &sKey, uHash,
+                                        pvValue);
+        if (psBinding != NULL)
+            iGrow = SymTable_stripeIsFull(oSymTable, psStripe);
+    }
+    uBucketCount = oSymTable->buckets->count;
+    pthread_rwlock_unlock(&psStripe->lock);
+
+    if (iGrow)
+        SymTable_grow(oSymTable, uBucketCount);
+    if (psBinding == NULL)
+        return NULL;
+    return &psBinding->value;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_containsKey(oSymTable, &sKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    struct Stripe *psStripe;
+    size_t uHash;
+    int iFound;
+#ifdef SYMTABLE_LOCKFREE_READS
+    struct Reader *psReader;
+#endif
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    uHash = SymTable_hash(oSymTable, psKey);
+    oSymTable = SymTable_shard(oSymTable, &uHash);
+
+#ifdef SYMTABLE_LOCKFREE_READS
+    psReader = SymTable_enterRead();
+    if (psReader != NULL){
+        iFound = SymTable_findLockFree(oSymTable, psKey, uHash) != NULL;
+        SymTable_exitRead(psReader);
+        return iFound;
+    }
+#endif
+
+    psStripe = SymTable_stripe(oSymTable, uHash);
+    pthread_rwlock_rdlock(&psStripe->lock);
+    iFound = SymTable_findLink(oSymTable, psKey, uHash) != NULL;
+    pthread_rwlock_unlock(&psStripe->lock);
+    return iFound;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+                    size_t uLength){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_getKey(oSymTable, &sKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    struct Stripe *psStripe;
+    struct Binding **ppLink;
+    size_t uHash;
+    void *pvValue = NULL;
+#ifdef SYMTABLE_LOCKFREE_READS
+    struct Reader *psReader;
+#endif
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    uHash = SymTable_hash(oSymTable, psKey);
+    oSymTable = SymTable_shard(oSymTable, &uHash);
+
+#ifdef SYMTABLE_LOCKFREE_READS
+    psReader = SymTable_enterRead();
+    if (psReader != NULL){
+        struct Binding *psBinding =
+            SymTable_findLockFree(oSymTable, psKey, uHash);
+        if (psBinding != NULL)
+            pvValue = LOAD_SHARED(psBinding->value);
+        SymTable_exitRead(psReader);
+        return pvValue;
+    }
+#endif
+
+    psStripe = SymTable_stripe(oSymTable, uHash);
+    pthread_rwlock_rdlock(&psStripe->lock);
+    ppLink = SymTable_findLink(oSymTable, psKey, uHash);
+    if (ppLink != NULL)
+        pvValue = (*ppLink)->value;
+    pthread_rwlock_unlock(&psStripe->lock);
+    return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_removeKey(oSymTable, &sKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    struct Stripe *psStripe;
+    struct Binding **ppLink;
+    size_t uHash;
+    void *returnValue = NULL;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    uHash = SymTable_hash(oSymTable, psKey);
+    oSymTable = SymTable_shard(oSymTable, &uHash);
+    psStripe = SymTable_stripe(oSymTable, uHash);
+
+    pthread_rwlock_wrlock(&psStripe->lock);
+    ppLink = SymTable_findLink(oSymTable, psKey, uHash);
+    if (ppLink != NULL){
+        struct Binding *currBinding = *ppLink;
+        /* currBinding keeps its link, for lookups still reading it */
+        STORE_SHARED(*ppLink, currBinding->pNextBinding);
+        returnValue = currBinding->value;
+        psStripe->size--;
+#ifdef SYMTABLE_LOCKFREE_READS
+        SymTable_retireBinding(psStripe, currBinding);
+#else
+        SymTable_freeBinding(psStripe, currBinding);
+#endif
+    }
+    pthread_rwlock_unlock(&psStripe->lock);
+    return returnValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable, const char *const apcKeys[],
+                       size_t uCount, void *apvValues[]){
+    size_t u;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL || uCount == 0);
+    assert(apvValues != NULL || uCount == 0);
+
+    /* every lookup takes its own stripe lock */
+    for (u = 0; u < uCount; u++)
+        apvValues[u] = SymTable_get(oSymTable, apcKeys[u]);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable,
+                         const char *const apcKeys[], size_t uCount,
+                         const void *const apvValues[]){
+    size_t u;
+    size_t uAdded = 0;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL || uCount == 0);
+    assert(apvValues != NULL || uCount == 0);
+
+    for (u = 0; u < uCount; u++)
+        uAdded += (size_t)SymTable_put(oSymTable, apcKeys[u], apvValues[u]);
+    return uAdded;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply *pfApply to each binding of oSymTable (of each shard, if it
+   is sharded), passing pvExtra as an extra parameter. The caller must
+   hold every stripe lock. */
+
+static void SymTable_mapLocked(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra)
+{
+    size_t index;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    for (index = 0; index < oSymTable->shardCount; index++)
+        SymTable_mapLocked(oSymTable->shards[index], pfApply, pvExtra);
+    if (oSymTable->buckets == NULL)
+        return;
+
+    for (index = 0; index < oSymTable->buckets->count; index++){
+        struct Binding *currBinding = oSymTable->buckets->first[index];
+        while (currBinding != NULL){
+            (*pfApply)(currBinding->key, currBinding->value,
+                       (void*)pvExtra);
+            currBinding = currBinding->pNextBinding;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    /* read-lock every stripe (of every shard), so that pfApply sees
+       one state of the table; pfApply must therefore not update
+       oSymTable */
+    SymTable_lockAll(oSymTable, 0);
+    SymTable_mapLocked(oSymTable, pfApply, pvExtra);
+    SymTable_unlockAll(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a call to SymTable_mapParallel, shared by the
+   workers that run it. */
+struct MapTask {
+    /* The table */
+    SymTable_T oSymTable;
+    /* The function to apply, and its extra parameter */
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot);
+    const void *pvExtra;
+    /* The slot of each worker, or NULL */
+    void *const *apvSlots;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of *psTask to the bindings of buckets uStart to
+   uEnd-1 of oSymTable, which is not sharded, passing pvSlot. The
+   caller must hold every stripe lock. */
+
+static void SymTable_mapBuckets(SymTable_T oSymTable, size_t uStart,
+                                size_t uEnd, struct MapTask *psTask,
+                                void *pvSlot)
+{
+    size_t index;
+
+    assert(oSymTable != NULL);
+    assert(psTask != NULL);
+
+    for (index = uStart; index < uEnd; index++){
+        struct Binding *currBinding = oSymTable->buckets->first[index];
+        while (currBinding != NULL){
+            (*psTask->pfApply)(currBinding->key, currBinding->value,
+                               (void*)psTask->pvExtra, pvSlot);
+            currBinding = currBinding->pNextBinding;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the MapTask that pvTask points to, for worker
+   uWorker, to items uStart to uEnd-1 of its table: its buckets, or
+   whole shards if it is sharded. */
+
+static void SymTable_mapRange(size_t uStart, size_t uEnd, size_t uWorker,
+                              void *pvTask)
+{
+    struct MapTask *psTask = (struct MapTask*)pvTask;
+    SymTable_T oSymTable;
+    void *pvSlot;
+    size_t index;
+
+    assert(psTask != NULL);
+
+    oSymTable = psTask->oSymTable;
+    pvSlot = psTask->apvSlots == NULL ? NULL : psTask->apvSlots[uWorker];
+    if (oSymTable->shards == NULL)
+        SymTable_mapBuckets(oSymTable, uStart, uEnd, psTask, pvSlot);
+    else for (index = uStart; index < uEnd; index++){
+        SymTable_T oShard = oSymTable->shards[index];
+        SymTable_mapBuckets(oShard, 0, oShard->buckets->count, psTask,
+                            pvSlot);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot),
+    const void *pvExtra, size_t uThreadCount, void *const apvSlots[]){
+    struct MapTask sTask;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    assert(uThreadCount > 0);
+
+    sTask.oSymTable = oSymTable;
+    sTask.pfApply = pfApply;
+    sTask.pvExtra = pvExtra;
+    sTask.apvSlots = apvSlots;
+
+    /* as in SymTable_map, the table is read-locked throughout; the
+       workers of a sharded table share out whole shards */
+    SymTable_lockAll(oSymTable, 0);
+    SymPar_run(oSymTable->shards == NULL ?
+               oSymTable->buckets->count : oSymTable->shardCount,
+               uThreadCount, SymTable_mapRange, &sTask);
+    SymTable_unlockAll(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter){
+    assert(oSymTable != NULL);
+    assert(psIter != NULL);
+
+    /* as in SymTable_map, the table is read-locked until the traversal
+       ends, so that it sees one state of the table; the thread that 
+       traverses must therefore not update oSymTable meanwhile */
+    SymTable_lockAll(oSymTable, 0);
+    psIter->oSymTable = oSymTable;
+    psIter->uPart = 0;
+    psIter->uIndex = 0;
+    psIter->pvNext = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTable_Iter *psIter, const char **ppcKey,
+                      void **ppvValue){
+    SymTable_T oSymTable;
+    SymTable_T oShard;
+    struct Binding *currBinding;
+
+    assert(psIter != NULL);
+    assert(psIter->oSymTable != NULL);
+
+    /* the rest of the current chain, or else the next non-empty bucket
+       of the current shard (uPart), or of the shards after it */
+    oSymTable = psIter->oSymTable;
+    currBinding = (struct Binding*)psIter->pvNext;
+    while (currBinding == NULL){
+        if (oSymTable->shards == NULL)
+            oShard = oSymTable;
+        else if (psIter->uPart < oSymTable->shardCount)
+            oShard = oSymTable->shards[psIter->uPart];
+        else return 0;
+
+        if (psIter->uIndex < oShard->buckets->count)
+            currBinding = oShard->buckets->first[psIter->uIndex++];
+        else if (oSymTable->shards == NULL)
+            return 0;
+        else {
+            psIter->uPart++;
+            psIter->uIndex = 0;
+        }
+    }
+    psIter->pvNext = currBinding->pNextBinding;
+
+    if (ppcKey != NULL)
+        *ppcKey = currBinding->key;
+    if (ppvValue != NULL)
+        *ppvValue = currBinding->value;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTable_Iter *psIter){
+    assert(psIter != NULL);
+    assert(psIter->oSymTable != NULL);
+
+    SymTable_unlockAll(psIter->oSymTable);
+    psIter->oSymTable = NULL;
+}
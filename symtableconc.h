@@ -0,0 +1,31 @@
+/*--------------------------------------------------------------------*/
+/* symtableconc.h                                                     */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLECONC_INCLUDED
+#define SYMTABLECONC_INCLUDED
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include "symtable.h"
+
+/*--------------------------------------------------------------------*/
+
+/* Extensions of the SymTable interface that only the implementation
+   for concurrent use (symtableconc.c) provides. */
+
+/*--------------------------------------------------------------------*/
+
+/* Returns a new SymTable object that contains no bindings and splits
+   its keys among uShardCount independent tables (shards) by the high
+   bits of their hash codes, or NULL if insufficient memory. Each
+   shard has its own lock and grows on its own, so that threads
+   putting keys into different shards never wait for each other, and
+   growing one shard does not block the others. Keys are hashed as by
+   SymTable_new. uShardCount must be positive. */
+
+SymTable_T SymTable_newSharded(size_t uShardCount);
+
+/*--------------------------------------------------------------------*/
+#endif
@@ -7,20 +7,54 @@
 #include <stdlib.h>
 #include <string.h>
 #include "symtable.h"
+#include "symhash.h"
+#include "sympar.h"
+#ifndef SYMTABLE_MALLOC
+#include "sympool.h"
+#endif
 
 /*--------------------------------------------------------------------*/
-/* Array containing bucket counts for the hash table as it grow */
+/* Array containing the first bucket counts for the hash table as it 
+   grows. Past the last entry, the next bucket count is computed as the
+   smallest prime greater than twice the current one. */
 static const size_t auBucketCounts[] = {509, 1021, 2039, 4093, 8191, 
                                         16381, 32749, 65521};
 
-/* Each key-value pair is stored in a Binding, and points to next Binding */
+/* Number of entries in auBucketCounts */
+static const size_t uBucketCountsLength = 
+    sizeof(auBucketCounts) / sizeof(auBucketCounts[0]);
+
+/* A table holding at most LIST_CAPACITY bindings needs no bucket 
+   array: it has LIST_BUCKET_COUNT bucket, stored in the SymTable 
+   itself, whose chain is a list of all its bindings. The first bucket
+   array is allocated when a binding is added past LIST_CAPACITY, and
+   freed once fewer than LIST_CAPACITY / 4 bindings remain. */
+enum {LIST_BUCKET_COUNT = 1};
+enum {LIST_CAPACITY = 16};
+
+/* A table shrinks to the previous bucket count once it holds fewer
+   than one binding per SHRINK_LOAD_DIVISOR buckets. It grows at one
+   binding per bucket, so after shrinking it must lose half of its 
+   bindings again, or quadruple them, before it resizes again. */
+enum {SHRINK_LOAD_DIVISOR = 8};
+
+/* Each key-value pair is stored in a Binding, and points to next Binding.
+   The key is stored at the end of the Binding itself, so a binding is
+   a single allocation. */
 struct Binding {
-    /* The key. */
-    const char *key;
      /* The value. */
     void *value;
+    /* The full hash code of the key (before reduction modulo the 
+       bucket count). Moving the Binding to a bucket array of another
+       size does not rehash the key, and probes only compare keys whose
+       hash codes match. */
+    size_t hash;
+    /* The length of the key, compared before the key itself. */
+    size_t keyLength;
     /* The address of the next Binding (with same Hash). */
     struct Binding *pNextBinding;
+    /* The key (a defensive copy of the client's key). */
+    char key[];
 };
 
 /* A SymTable structure symbol table implemented with hash buckets that
@@ -32,114 +66,693 @@ struct SymTable {
     size_t size;
     /* Number of buckets*/
     size_t bucketCount;
+    /* Bucket count reserved by SymTable_reserve, below which removing
+       bindings does not shrink the table (0 if none) */
+    size_t reservedBucketCount;
+    /* Occupancy bitmap of buckets: bit i % OCCUPIED_WORD_BITS of word
+       i / OCCUPIED_WORD_BITS is set if and only if buckets[i] is not
+       empty, so that traversals skip empty buckets 64 at a time
+       without loading them */
+    unsigned long long *occupied;
+    /* Smaller bucket array still being drained into buckets during an
+       incremental resize, or NULL if no resize is in progress */
+    struct Binding **oldBuckets;
+    /* Number of buckets in oldBuckets */
+    size_t oldBucketCount;
+    /* Index of the next bucket in oldBuckets to be moved; all buckets 
+       before it are empty */
+    size_t rehashIndex;
+    /* The number of traversals (iterators) in progress, during which
+       lookups move no binding out of oldBuckets */
+    size_t traversals;
+    /* Hash function applied to keys */
+    enum SymTable_HashFunction hashFunction;
+    /* The bucket array and occupancy bitmap of the table (or of the
+       old bucket array, until it is drained) while its bucket count
+       is LIST_BUCKET_COUNT */
+    struct Binding *listBucket;
+    unsigned long long listOccupied;
+#ifndef SYMTABLE_MALLOC
+    /* Allocator of the Bindings of this SymTable (unless built with
+       SYMTABLE_MALLOC, which allocates each Binding with malloc), or
+       NULL until the first Binding is allocated */
+    SymPool_T pool;
+#endif
 };
 
+/* Number of non-empty chains moved from oldBuckets into buckets by 
+   every operation while an incremental resize is in progress. Resizes
+   are only incremental when compiled with -DSYMTABLE_INCREMENTAL. */
+enum {REHASH_STEP = 4};
+
+/* Number of empty old buckets that may be skipped for every chain 
+   that REHASH_STEP allows to be moved, bounding the work done by a
+   single operation on a sparse table. */
+enum {REHASH_EMPTY_VISITS = 16};
+
+/* Number of keys that SymTable_getBatch and SymTable_putBatch hash,
+   and whose buckets they prefetch, before resolving any of them. */
+enum {BATCH_BLOCK = 16};
+
+/* Number of buckets whose occupancy one word of the bitmap records. */
+enum {OCCUPIED_WORD_BITS = 64};
+
+/* Number of buckets ahead of the one it enters at which an iterator
+   prefetches the first binding. */
+enum {ITER_PREFETCH_DISTANCE = 8};
+
 /*--------------------------------------------------------------------*/
 
-/* Return a hash code for pcKey that is between 0 and uBucketCount-1,
-        inclusive. */
+/* Return a hash code for the key of the handle *psKey, computed with
+   the hash function of oSymTable (or taken from the handle if it has
+   been computed before). SymTable_bucketIndex maps it to a bucket. */
         
-static size_t SymTable_hash(const char *pcKey, size_t uBucketCount)
+static size_t SymTable_hash(SymTable_T oSymTable, SymTable_Key *psKey)
     {
-    const size_t HASH_MULTIPLIER = 65599;        
-    size_t u;
-    size_t uHash = 0;
-    
-    assert(pcKey != NULL);
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
 
-    for (u = 0; pcKey[u] != '\0'; u++)
-    uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
-        
-    return uHash % uBucketCount;
+    return SymHash_keyHash(psKey, oSymTable->hashFunction);
+    }
+
+/*--------------------------------------------------------------------*/
+
+/* Return the bucket, between 0 and uBucketCount-1 inclusive, of a key
+   of oSymTable whose hash code is uHash. The multiplicative hash is 
+   only well distributed in its low bits, so it is reduced modulo the 
+   (prime) bucket count; the wide hash is mapped with a multiply 
+   instead of a division. */
+
+static size_t SymTable_bucketIndex(SymTable_T oSymTable, size_t uHash,
+                                   size_t uBucketCount)
+    {
+    assert(oSymTable != NULL);
+
+    if (oSymTable->hashFunction == SYMTABLE_HASH_MULTIPLICATIVE)
+        return uHash % uBucketCount;
+    return SymHash_fastRange(uHash, uBucketCount);
+    }
+
+/*--------------------------------------------------------------------*/
+
+/* Store in *pppBuckets a bucket array of uBucketCount empty buckets
+   for oSymTable, and in *ppullOccupied its occupancy bitmap: the 
+   bucket stored in oSymTable itself if uBucketCount is 
+   LIST_BUCKET_COUNT, or else newly allocated ones. Return 1 (TRUE) if
+   successful, or 0 (FALSE) if insufficient memory is available. */
+
+static int SymTable_newBuckets(SymTable_T oSymTable, size_t uBucketCount,
+                               struct Binding ***pppBuckets,
+                               unsigned long long **ppullOccupied)
+    {
+    assert(oSymTable != NULL);
+    assert(pppBuckets != NULL);
+    assert(ppullOccupied != NULL);
+
+    if (uBucketCount == LIST_BUCKET_COUNT){
+        oSymTable->listBucket = NULL;
+        oSymTable->listOccupied = 0;
+        *pppBuckets = &oSymTable->listBucket;
+        *ppullOccupied = &oSymTable->listOccupied;
+        return 1;
+    }
+    *pppBuckets = 
+        (struct Binding**)calloc(uBucketCount, sizeof(struct Binding *));
+    *ppullOccupied = (unsigned long long*)calloc(
+        (uBucketCount + OCCUPIED_WORD_BITS - 1) / OCCUPIED_WORD_BITS,
+        sizeof(unsigned long long));
+    if (*pppBuckets == NULL || *ppullOccupied == NULL){
+        free(*pppBuckets);
+        free(*ppullOccupied);
+        return 0;
+    }
+    return 1;
+    }
+
+/*--------------------------------------------------------------------*/
+
+/* Free pvArray, a bucket array or occupancy bitmap of oSymTable, 
+   unless it is stored in oSymTable itself. */
+
+static void SymTable_freeArray(SymTable_T oSymTable, void *pvArray)
+    {
+    assert(oSymTable != NULL);
+
+    if (pvArray != (void*)&oSymTable->listBucket &&
+        pvArray != (void*)&oSymTable->listOccupied)
+        free(pvArray);
+    }
+
+/*--------------------------------------------------------------------*/
+
+/* Record in the occupancy bitmap of oSymTable that bucket index of its
+   current bucket array is not empty. */
+
+static void SymTable_markOccupied(SymTable_T oSymTable, size_t index)
+    {
+    assert(oSymTable != NULL);
+    assert(index < oSymTable->bucketCount);
+
+    oSymTable->occupied[index / OCCUPIED_WORD_BITS] |=
+        1ULL << (index % OCCUPIED_WORD_BITS);
+    }
+
+/*--------------------------------------------------------------------*/
+
+/* Record in the occupancy bitmap of oSymTable that bucket index of its
+   current bucket array is empty. */
+
+static void SymTable_markEmpty(SymTable_T oSymTable, size_t index)
+    {
+    assert(oSymTable != NULL);
+    assert(index < oSymTable->bucketCount);
+
+    oSymTable->occupied[index / OCCUPIED_WORD_BITS] &=
+        ~(1ULL << (index % OCCUPIED_WORD_BITS));
+    }
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if the occupancy bitmap of oSymTable records bucket
+   index of its current bucket array as not empty, or 0 (FALSE) 
+   otherwise. */
+
+static int SymTable_isOccupied(SymTable_T oSymTable, size_t index)
+    {
+    assert(oSymTable != NULL);
+    assert(index < oSymTable->bucketCount);
+
+    return (int)((oSymTable->occupied[index / OCCUPIED_WORD_BITS] >>
+                  (index % OCCUPIED_WORD_BITS)) & 1ULL);
+    }
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the first non-empty bucket of the current bucket
+   array of oSymTable from index to uEnd-1, or uEnd if there is none.
+   uEnd must not exceed the bucket count. Only the occupancy bitmap is
+   read, a word at a time. */
+
+static size_t SymTable_nextOccupied(SymTable_T oSymTable, size_t index,
+                                    size_t uEnd)
+    {
+    size_t uWord;
+    size_t uEndWord;
+    unsigned long long ullBits;
+    int iBit = 0;
+
+    assert(oSymTable != NULL);
+    assert(uEnd <= oSymTable->bucketCount);
+
+    if (index >= uEnd)
+        return uEnd;
+    uWord = index / OCCUPIED_WORD_BITS;
+    uEndWord = (uEnd - 1) / OCCUPIED_WORD_BITS;
+    /* ignore the buckets of the first word that come before index */
+    ullBits = oSymTable->occupied[uWord] &
+        (~0ULL << (index % OCCUPIED_WORD_BITS));
+    while (ullBits == 0){
+        if (uWord == uEndWord)
+            return uEnd;
+        ullBits = oSymTable->occupied[++uWord];
+    }
+#ifdef __GNUC__
+    iBit = __builtin_ctzll(ullBits);
+#else
+    while ((ullBits & 1ULL) == 0){
+        ullBits >>= 1;
+        iBit++;
+    }
+#endif
+    /* the bit found may belong to a bucket at or past uEnd */
+    index = uWord * OCCUPIED_WORD_BITS + (size_t)iBit;
+    return index < uEnd ? index : uEnd;
     }
 
 /*--------------------------------------------------------------------*/
 
+/* Return 1 (TRUE) if u is a prime number, or 0 (FALSE) otherwise. */
+
+static int SymTable_isPrime(size_t u){
+    size_t uDivisor;
+    if (u < 2)
+        return 0;
+    if (u % 2 == 0)
+        return u == 2;
+    for (uDivisor = 3; uDivisor <= u / uDivisor; uDivisor += 2){
+        if (u % uDivisor == 0)
+            return 0;
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Helper function that finds the next bucket count in the sequence 
-   based on current bucketC number of buckets, and returns the value. */
+   based on current bucketC number of buckets, and returns the value.
+   Returns 0 if a larger bucket array could not be addressed. */
 
 static size_t SymTable_growHelper(size_t bucketC){
-    const int POSS_BUCKETS = 8;
-    int i;
-    for (i = 0; i < POSS_BUCKETS - 1; i++){
+    const size_t MAX_BUCKET_COUNT = 
+        ((size_t)-1 / sizeof(struct Binding *)) / 2;
+    size_t i;
+    size_t uCandidate;
+    if (bucketC == LIST_BUCKET_COUNT)
+        return auBucketCounts[0];
+    for (i = 0; i < uBucketCountsLength - 1; i++){
         if (auBucketCounts[i] == bucketC)
             return auBucketCounts[i + 1];
     }
-    return 0;
+
+    /* beyond the precomputed sequence: next prime after 2 * bucketC */
+    if (bucketC >= MAX_BUCKET_COUNT)
+        return 0;
+    for (uCandidate = 2 * bucketC + 1; 
+         !SymTable_isPrime(uCandidate); uCandidate += 2)
+        ;
+    return uCandidate;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Helper function that finds the bucket count that comes before 
+   bucketC as the table grows: LIST_BUCKET_COUNT or the previous entry
+   of auBucketCounts, or past its last entry the largest prime that is
+   at most half of bucketC (but not below that entry). Returns 0 if 
+   bucketC is the smallest bucket count. */
+
+static size_t SymTable_shrinkHelper(size_t bucketC){
+    const size_t LAST_BUCKET_COUNT = 
+        auBucketCounts[uBucketCountsLength - 1];
+    size_t i;
+    size_t uCandidate;
+
+    if (bucketC == auBucketCounts[0])
+        return LIST_BUCKET_COUNT;
+    for (i = 1; i < uBucketCountsLength; i++){
+        if (auBucketCounts[i] == bucketC)
+            return auBucketCounts[i - 1];
+    }
+    if (bucketC <= LAST_BUCKET_COUNT)
+        return 0;
+
+    /* beyond the precomputed sequence: largest prime up to bucketC/2 */
+    if (bucketC / 2 <= LAST_BUCKET_COUNT)
+        return LAST_BUCKET_COUNT;
+    for (uCandidate = (bucketC / 2 - 1) | 1; 
+         !SymTable_isPrime(uCandidate); uCandidate -= 2)
+        ;
+    return uCandidate;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings that a table of bucketC buckets holds
+   before it grows. */
+
+static size_t SymTable_growSize(size_t bucketC){
+    return bucketC == LIST_BUCKET_COUNT ? LIST_CAPACITY : bucketC;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings below which a table of bucketC 
+   buckets shrinks. */
+
+static size_t SymTable_shrinkSize(size_t bucketC){
+    if (bucketC == auBucketCounts[0])
+        return LIST_CAPACITY / 4;
+    return bucketC / SHRINK_LOAD_DIVISOR;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Helper function that finds the smallest bucket count in the 
+   sequence of SymTable_growHelper that holds uCapacity bindings 
+   without growing, or the largest addressable one if none does. */
+
+static size_t SymTable_capacityHelper(size_t uCapacity){
+    size_t bucketC = LIST_BUCKET_COUNT;
+    size_t uNext;
+
+    while (SymTable_growSize(bucketC) < uCapacity && 
+           (uNext = SymTable_growHelper(bucketC)) != 0)
+        bucketC = uNext;
+    return bucketC;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Allocate a Binding for oSymTable with room for a key of uKeySize
+   bytes (including the terminating '\0'). Returns its address, or NULL
+   if memory not sufficient. */
+
+static struct Binding *SymTable_allocBinding(SymTable_T oSymTable,
+                                             size_t uKeySize){
+    assert(oSymTable != NULL);
+#ifdef SYMTABLE_MALLOC
+    (void)oSymTable;
+    return (struct Binding*)malloc(sizeof(struct Binding) + uKeySize);
+#else
+    /* the pool is only created with the first binding, so that a 
+       table that stays empty allocates nothing but itself */
+    if (oSymTable->pool == NULL){
+        oSymTable->pool = SymPool_new();
+        if (oSymTable->pool == NULL)
+            return NULL;
+    }
+    return (struct Binding*)SymPool_alloc(oSymTable->pool,
+                                          sizeof(struct Binding) + uKeySize);
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Release psBinding, allocated by SymTable_allocBinding for 
+   oSymTable. */
+
+static void SymTable_freeBinding(SymTable_T oSymTable, 
+                                 struct Binding *psBinding){
+    assert(oSymTable != NULL);
+    assert(psBinding != NULL);
+#ifdef SYMTABLE_MALLOC
+    (void)oSymTable;
+    free(psBinding);
+#else
+    SymPool_release(oSymTable->pool, psBinding, 
+                    sizeof(struct Binding) + psBinding->keyLength + 1);
+#endif
 }
 
 /*--------------------------------------------------------------------*/
 
 /* Helper function that allocates memory to an SymTable object with 
-   bucketC number of buckets. Returns reference to the SymTable object, 
-   and NULL if memory not sufficient. */
+   bucketC number of buckets that hashes keys with eHash. Returns 
+   reference to the SymTable object, and NULL if memory not 
+   sufficient. */
 
-static SymTable_T SymTable_newHelper(size_t bucketC){
+static SymTable_T SymTable_newHelper(size_t bucketC, 
+                                     enum SymTable_HashFunction eHash){
     SymTable_T oSymTable;
 
     oSymTable = (SymTable_T) malloc(sizeof(struct SymTable));
     if (oSymTable == NULL)
         return NULL;
 
-    oSymTable->buckets = 
-        (struct Binding**) calloc(bucketC, sizeof(struct Binding *));
-
-    if (oSymTable->buckets == NULL){
+    if (!SymTable_newBuckets(oSymTable, bucketC, &oSymTable->buckets,
+                             &oSymTable->occupied)){
         free(oSymTable);
         return NULL;
     }
+#ifndef SYMTABLE_MALLOC
+    oSymTable->pool = NULL;
+#endif
     
     oSymTable->size = 0;
     oSymTable->bucketCount = bucketC;
+    oSymTable->reservedBucketCount = 0;
+    oSymTable->oldBuckets = NULL;
+    oSymTable->oldBucketCount = 0;
+    oSymTable->rehashIndex = 0;
+    oSymTable->traversals = 0;
+    oSymTable->hashFunction = eHash;
     return oSymTable;
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Increase the bucket count of oSymTable by allocated new larger memory
-   and transferring over key-value pairs. Frees up old memory (smaller
-   SymTable).  Return 1 (TRUE) ifsuccessful, or 0 (FALSE) if insufficient 
-   memory is available. */
+/* Move the bindings of up to uChains non-empty buckets of the old 
+   bucket array of oSymTable into its current bucket array, relinking
+   the existing Bindings. Once the old array is drained, free it and
+   end the incremental resize. Does nothing if no resize is in 
+   progress. */
 
-static int SymTable_grow(SymTable_T oSymTable)
+static void SymTable_rehashStep(SymTable_T oSymTable, size_t uChains)
 {
+    size_t uEmptyVisits;
+    
+    assert(oSymTable != NULL);
+
+    if (oSymTable->oldBuckets == NULL)
+        return;
+    
+    /* bound the empty buckets skipped, avoiding overflow when the
+       caller asks for every chain */
+    if (uChains > (size_t)-1 / REHASH_EMPTY_VISITS)
+        uEmptyVisits = (size_t)-1;
+    else uEmptyVisits = uChains * REHASH_EMPTY_VISITS;
+
+    while (oSymTable->rehashIndex < oSymTable->oldBucketCount &&
+           uChains > 0){
+        struct Binding *currentBind = 
+            oSymTable->oldBuckets[oSymTable->rehashIndex];
+        if (currentBind == NULL){
+            oSymTable->rehashIndex++;
+            if (--uEmptyVisits == 0)
+                return;
+            continue;
+        }
+        /* prepend every binding of the chain to its new bucket */
+        while (currentBind != NULL){
+            struct Binding *pNext = currentBind->pNextBinding;
+            size_t index = SymTable_bucketIndex(oSymTable, 
+                currentBind->hash, oSymTable->bucketCount);
+            currentBind->pNextBinding = oSymTable->buckets[index];
+            oSymTable->buckets[index] = currentBind;
+            SymTable_markOccupied(oSymTable, index);
+            currentBind = pNext;
+        }
+        oSymTable->oldBuckets[oSymTable->rehashIndex] = NULL;
+        oSymTable->rehashIndex++;
+        uChains--;
+    }
+
+    if (oSymTable->rehashIndex == oSymTable->oldBucketCount){
+        SymTable_freeArray(oSymTable, oSymTable->oldBuckets);
+        oSymTable->oldBuckets = NULL;
+        oSymTable->oldBucketCount = 0;
+        oSymTable->rehashIndex = 0;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Change the bucket count of oSymTable to uNewBucketCount by 
+   allocating a new bucket array and relinking the existing Bindings 
+   into it, without copying keys or rehashing them. The previous array
+   is kept as oldBuckets and, when compiled with -DSYMTABLE_INCREMENTAL,
+   is drained a few chains at a time by SymTable_rehashStep; otherwise
+   it is drained at once. Finishes any resize still in progress first.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available. */
+
+static int SymTable_resize(SymTable_T oSymTable, size_t uNewBucketCount)
+{
+    struct Binding **newBuckets;
+    unsigned long long *newOccupied;
+
+    assert(oSymTable != NULL);
+    assert(uNewBucketCount > 0);
+
+    SymTable_rehashStep(oSymTable, (size_t)-1);
+
+    /* the bucket stored in the table is free again by now, if the new
+       array is to be that one */
+    if (!SymTable_newBuckets(oSymTable, uNewBucketCount, &newBuckets,
+                             &newOccupied))
+        return 0;
+
+    /* the old array is only ever drained, so its bitmap is not kept */
+    SymTable_freeArray(oSymTable, oSymTable->occupied);
+    oSymTable->occupied = newOccupied;
+    oSymTable->oldBuckets = oSymTable->buckets;
+    oSymTable->oldBucketCount = oSymTable->bucketCount;
+    oSymTable->rehashIndex = 0;
+    oSymTable->buckets = newBuckets;
+    oSymTable->bucketCount = uNewBucketCount;
+#ifndef SYMTABLE_INCREMENTAL
+    SymTable_rehashStep(oSymTable, (size_t)-1);
+#endif
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the link (bucket entry or pNextBinding field)
+   that points to the binding of oSymTable whose key is the uLength 
+   characters starting at pcKey, or NULL if no such binding exists.
+   uHash is the hash code of the key. Searches the old bucket array as
+   well while an incremental resize is in progress. */
+
+static struct Binding **SymTable_findLink(SymTable_T oSymTable, 
+                                          const char *pcKey, 
+                                          size_t uLength, size_t uHash)
+{
+    struct Binding **ppLink;
     size_t index;
-    size_t uNewBucketCount;
-    size_t oldBucketCount = oSymTable->bucketCount;
-    SymTable_T newSymTable;
 
     assert(oSymTable != NULL);
-    /* Creates empty newSymTable with larger bucket count */
-    uNewBucketCount = SymTable_growHelper(oldBucketCount);
-    newSymTable = SymTable_newHelper(uNewBucketCount);
+    assert(pcKey != NULL);
+
+    /* the binding is still in the old array if its bucket there has
+       not been moved yet. Keys are only compared (dereferencing the
+       key at the end of the node) when the full hash codes and the
+       lengths match. */
+    if (oSymTable->oldBuckets != NULL){
+        index = SymTable_bucketIndex(oSymTable, uHash, 
+                                     oSymTable->oldBucketCount);
+        if (index >= oSymTable->rehashIndex){
+            ppLink = &oSymTable->oldBuckets[index];
+            while (*ppLink != NULL){
+                if ((*ppLink)->hash == uHash && 
+                    (*ppLink)->keyLength == uLength &&
+                    memcmp(pcKey, (*ppLink)->key, uLength) == 0)
+                    return ppLink;
+                ppLink = &(*ppLink)->pNextBinding;
+            }
+        }
+    }
+
+    index = SymTable_bucketIndex(oSymTable, uHash, oSymTable->bucketCount);
+    ppLink = &oSymTable->buckets[index];
+    while (*ppLink != NULL){
+        if ((*ppLink)->hash == uHash && 
+            (*ppLink)->keyLength == uLength &&
+            memcmp(pcKey, (*ppLink)->key, uLength) == 0)
+            return ppLink;
+        ppLink = &(*ppLink)->pNextBinding;
+    }
+    return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a binding of the key of the handle *psKey, whose hash code is
+   uHash and which oSymTable does not contain, to oSymTable with value
+   pvValue, growing the table if needed. Return the new binding, or 
+   NULL if insufficient memory is available. */
+
+static struct Binding *SymTable_addBinding(SymTable_T oSymTable, 
+                                           SymTable_Key *psKey,
+                                           size_t uHash, 
+                                           const void *pvValue){
+    int iSuccessful;
+    struct Binding* newBinding;
+    size_t index;
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    /* Increase oSymTable bucket count once its size reaches the
+       number its bucketCount holds (as long as a larger count exists) */
     
-    if (newSymTable == NULL)
-        return 0;
+    if (oSymTable->size >= SymTable_growSize(oSymTable->bucketCount) && 
+        SymTable_growHelper(oSymTable->bucketCount) != 0)
+    {
+       iSuccessful = SymTable_resize(oSymTable, 
+           SymTable_growHelper(oSymTable->bucketCount));
+       if (!iSuccessful)
+          return NULL;
+    }
+    /* new bindings always go into the current bucket array */
+    index = SymTable_bucketIndex(oSymTable, uHash, oSymTable->bucketCount);
     
-    /* Traverses bindings of oSymTable and copies the key-value pairs
-       into newSymTable (re-hashed). Frees up bindings during traversal. */
-    for (index = 0; index < oldBucketCount; index++){
-        struct Binding* currentBind = oSymTable->buckets[index];
-        while (currentBind != NULL){
-            struct Binding* pCurrent = currentBind;
-            SymTable_put(newSymTable, currentBind->key, currentBind->value);
-            free((char*)pCurrent->key);
-            currentBind = currentBind->pNextBinding;
-            free(pCurrent);
-        }    
+    /* allocate the binding together with a defensive copy of the key */
+    newBinding = SymTable_allocBinding(oSymTable, psKey->uLength + 1);
+    if (newBinding == NULL)
+        return NULL;
+
+    memcpy(newBinding->key, psKey->pcKey, psKey->uLength);
+    newBinding->key[psKey->uLength] = '\0';
+    newBinding->value = (void*) pvValue;
+    newBinding->hash = uHash;
+    newBinding->keyLength = psKey->uLength;
+    
+    /* append new binding to beginning of hash bucket (since we know pcKey 
+       not already in SymTable so no additional traversal needed) */
+    newBinding->pNextBinding = oSymTable->buckets[index];
+    oSymTable->buckets[index] = newBinding;
+    SymTable_markOccupied(oSymTable, index);
+    (oSymTable->size)++;
+    return newBinding;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a binding of the key of the handle *psKey, whose hash code is
+   uHash, to oSymTable with value pvValue, as SymTable_put does: return
+   1 (TRUE) if successful, or 0 (FALSE) if oSymTable already contains
+   the key or insufficient memory is available. */
+
+static int SymTable_insert(SymTable_T oSymTable, SymTable_Key *psKey,
+                           size_t uHash, const void *pvValue){
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    /* traverse corresponding bucket(s) and return 0 if pcKey found */
+    if (SymTable_findLink(oSymTable, psKey->pcKey, psKey->uLength, 
+                          uHash) != NULL)
+        return 0;
+    return SymTable_addBinding(oSymTable, psKey, uHash, pvValue) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Ask the processor to start loading the cache line at pv, if the
+   compiler offers a way to. */
+
+static void SymTable_prefetch(const void *pv){
+#ifdef __GNUC__
+    __builtin_prefetch(pv);
+#else
+    (void)pv;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Prepare the uCount (at most BATCH_BLOCK) keys at apcKeys for a batch
+   operation on oSymTable: make a handle for each in asKeys, store its
+   hash code in auHash, and prefetch its bucket and then the first
+   binding of that bucket, so that the chains are (mostly) in cache by
+   the time the keys are resolved one by one. */
+
+static void SymTable_prepareBlock(SymTable_T oSymTable, 
+                                  const char *const apcKeys[],
+                                  size_t uCount, SymTable_Key asKeys[],
+                                  size_t auHash[]){
+    size_t auIndex[BATCH_BLOCK];
+    size_t u;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL);
+    assert(uCount <= BATCH_BLOCK);
+
+    for (u = 0; u < uCount; u++){
+        assert(apcKeys[u] != NULL);
+        SymTable_initKey(&asKeys[u], apcKeys[u], strlen(apcKeys[u]));
+        auHash[u] = SymTable_hash(oSymTable, &asKeys[u]);
+        auIndex[u] = SymTable_bucketIndex(oSymTable, auHash[u], 
+                                          oSymTable->bucketCount);
+        SymTable_prefetch(&oSymTable->buckets[auIndex[u]]);
+    }
+    for (u = 0; u < uCount; u++){
+        struct Binding *psFirst = oSymTable->buckets[auIndex[u]];
+        if (psFirst != NULL)
+            SymTable_prefetch(psFirst);
     }
-    free(oSymTable->buckets);
-    *oSymTable = *newSymTable;
-    free(newSymTable);
-    return 1;
 }
 
 /*--------------------------------------------------------------------*/
 
 SymTable_T SymTable_new(void) {
-    const size_t INIT_BUCKET_COUNT = auBucketCounts[0];
-    /* Create a SymTable of the default bucket size */
-    SymTable_T oSymTable = SymTable_newHelper(INIT_BUCKET_COUNT);
+    return SymTable_newWithHash(SYMTABLE_HASH_MULTIPLICATIVE);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithHash(enum SymTable_HashFunction eHash) {
+    /* Create a SymTable with no bucket array, as a list */
+    SymTable_T oSymTable = SymTable_newHelper(LIST_BUCKET_COUNT, eHash);
 
     if (oSymTable == NULL)
       return NULL;
@@ -148,28 +761,205 @@ SymTable_T SymTable_new(void) {
 
 /*--------------------------------------------------------------------*/
 
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+    size_t bucketC = SymTable_capacityHelper(uCapacity);
+    SymTable_T oSymTable = 
+        SymTable_newHelper(bucketC, SYMTABLE_HASH_MULTIPLICATIVE);
+
+    if (oSymTable == NULL)
+        return NULL;
+    oSymTable->reservedBucketCount = bucketC;
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity){
+    size_t bucketC;
+
+    assert(oSymTable != NULL);
+
+    bucketC = SymTable_capacityHelper(uCapacity);
+    if (bucketC > oSymTable->bucketCount &&
+        !SymTable_resize(oSymTable, bucketC))
+        return 0;
+    if (bucketC > oSymTable->reservedBucketCount)
+        oSymTable->reservedBucketCount = bucketC;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
 void SymTable_free(SymTable_T oSymTable){
+#ifdef SYMTABLE_MALLOC
     size_t index;
     size_t bucketC = oSymTable->bucketCount;
+#endif
     assert(oSymTable != NULL);
-    
+
+#ifndef SYMTABLE_MALLOC
+    /* every binding lives in the pool, which is released as a whole */
+    if (oSymTable->pool != NULL)
+        SymPool_free(oSymTable->pool);
+    SymTable_freeArray(oSymTable, oSymTable->oldBuckets);
+#else
     /* Traverses bindings of oSymTable and frees the memory occupied 
-       by every binding object */
-    for (index = 0; index < bucketC; index++){
+       by every binding object, skipping empty buckets through the 
+       occupancy bitmap */
+    for (index = SymTable_nextOccupied(oSymTable, 0, bucketC);
+         index < bucketC;
+         index = SymTable_nextOccupied(oSymTable, index + 1, bucketC)){
         struct Binding* currentBind = oSymTable->buckets[index];
         while (currentBind != NULL){
             struct Binding* pCurrent = currentBind;
-            free((char*)pCurrent->key);
             currentBind = currentBind->pNextBinding;
             free(pCurrent);
         }    
     }
-    free(oSymTable->buckets);
+    /* same for the bindings not yet moved out of the old array */
+    if (oSymTable->oldBuckets != NULL){
+        for (index = oSymTable->rehashIndex; 
+             index < oSymTable->oldBucketCount; index++){
+            struct Binding* currentBind = oSymTable->oldBuckets[index];
+            while (currentBind != NULL){
+                struct Binding* pCurrent = currentBind;
+                    currentBind = currentBind->pNextBinding;
+                free(pCurrent);
+            }
+        }
+        SymTable_freeArray(oSymTable, oSymTable->oldBuckets);
+    }
+#endif
+    SymTable_freeArray(oSymTable, oSymTable->occupied);
+    SymTable_freeArray(oSymTable, oSymTable->buckets);
     free(oSymTable);
 }
 
 /*--------------------------------------------------------------------*/
 
+/* Store in apsCopies, in the order of the buckets and of their chains,
+   a copy of each Binding of oSymTable (which no incremental resize is
+   draining), allocated by SymTable_allocBinding. Return the number of
+   copies made: oSymTable->size, or fewer if insufficient memory is 
+   available. */
+
+static size_t SymTable_copyBindings(SymTable_T oSymTable,
+                                    struct Binding **apsCopies)
+{
+    size_t index;
+    size_t u = 0;
+
+    assert(oSymTable != NULL);
+    assert(oSymTable->oldBuckets == NULL);
+    assert(apsCopies != NULL);
+
+    for (index = SymTable_nextOccupied(oSymTable, 0,
+                                       oSymTable->bucketCount);
+         index < oSymTable->bucketCount;
+         index = SymTable_nextOccupied(oSymTable, index + 1,
+                                       oSymTable->bucketCount)){
+        struct Binding *currBinding = oSymTable->buckets[index];
+        while (currBinding != NULL){
+            size_t uSize = sizeof(struct Binding) + 
+                currBinding->keyLength + 1;
+            apsCopies[u] = SymTable_allocBinding(oSymTable, 
+                currBinding->keyLength + 1);
+            if (apsCopies[u] == NULL)
+                return u;
+            memcpy(apsCopies[u], currBinding, uSize);
+            u++;
+            currBinding = currBinding->pNextBinding;
+        }
+    }
+    return u;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_compact(SymTable_T oSymTable){
+    struct Binding **apsCopies;
+    size_t uBucketCount;
+    size_t index;
+    size_t u;
+#ifndef SYMTABLE_MALLOC
+    SymPool_T oldPool;
+#endif
+
+    assert(oSymTable != NULL);
+
+    /* the bucket count that putting the bindings would have reached */
+    oSymTable->reservedBucketCount = 0;
+    uBucketCount = SymTable_capacityHelper(oSymTable->size + 1);
+    if (uBucketCount != oSymTable->bucketCount &&
+        !SymTable_resize(oSymTable, uBucketCount))
+        return 0;
+    SymTable_rehashStep(oSymTable, (size_t)-1);
+#ifndef SYMTABLE_MALLOC
+    /* an empty table gives its pool back */
+    if (oSymTable->size == 0){
+        if (oSymTable->pool != NULL)
+            SymPool_free(oSymTable->pool);
+        oSymTable->pool = NULL;
+        return 1;
+    }
+#endif
+
+    /* copy the bindings into fresh memory (a new pool, which leaves
+       behind the free lists of the old one) first, so that running 
+       out of memory halfway leaves every binding where it was */
+    apsCopies = (struct Binding**)
+        malloc((oSymTable->size + 1) * sizeof(struct Binding *));
+    if (apsCopies == NULL)
+        return 0;
+#ifndef SYMTABLE_MALLOC
+    oldPool = oSymTable->pool;
+    oSymTable->pool = SymPool_new();
+    if (oSymTable->pool == NULL){
+        oSymTable->pool = oldPool;
+        free(apsCopies);
+        return 0;
+    }
+#endif
+    u = SymTable_copyBindings(oSymTable, apsCopies);
+    if (u < oSymTable->size){
+#ifdef SYMTABLE_MALLOC
+        while (u > 0)
+            free(apsCopies[--u]);
+#else
+        SymPool_free(oSymTable->pool);
+        oSymTable->pool = oldPool;
+#endif
+        free(apsCopies);
+        return 0;
+    }
+
+    /* then link each copy in place of its original, in the same 
+       order. A copy still points to the original next Binding, whose
+       link it is, so that is replaced in turn. */
+    u = 0;
+    for (index = SymTable_nextOccupied(oSymTable, 0,
+                                       oSymTable->bucketCount);
+         index < oSymTable->bucketCount;
+         index = SymTable_nextOccupied(oSymTable, index + 1,
+                                       oSymTable->bucketCount)){
+        struct Binding **ppLink = &oSymTable->buckets[index];
+        while (*ppLink != NULL){
+#ifdef SYMTABLE_MALLOC
+            free(*ppLink);
+#endif
+            *ppLink = apsCopies[u++];
+            ppLink = &(*ppLink)->pNextBinding;
+        }
+    }
+#ifndef SYMTABLE_MALLOC
+    SymPool_free(oldPool);
+#endif
+    free(apsCopies);
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
 size_t SymTable_getLength(SymTable_T oSymTable){
     assert(oSymTable != NULL);
     
@@ -178,178 +968,324 @@ size_t SymTable_getLength(SymTable_T oSymTable){
 
 /*--------------------------------------------------------------------*/
 
+void SymTable_initKey(SymTable_Key *psKey, const char *pcKey,
+                      size_t uLength){
+    assert(psKey != NULL);
+    assert(pcKey != NULL);
+
+    psKey->pcKey = pcKey;
+    psKey->uLength = uLength;
+    psKey->uHashMask = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
 int SymTable_put(SymTable_T oSymTable, const char *pcKey, 
                  const void *pvValue){
-    const size_t MAX_BUCKET_COUNT = auBucketCounts[7];
-    int iSuccessful;
-    int resized = 0; /* 0 if SymTable not grown, 1 if grown */
-    struct Binding* binding;
-    struct Binding* newBinding;
-    size_t index;
-    assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    
-    index = SymTable_hash(pcKey, oSymTable->bucketCount);
-    binding = oSymTable->buckets[index];
-    /* traverse corresponding bucket until finding pcKey and return 0
-       if found */
-    while (binding != NULL){
-        if (strcmp(pcKey, binding->key) == 0)
-            return 0;
-        binding = binding->pNextBinding;
-    }
-    
-    /* Increase oSymTable bucket count once its size reaches 
-       current bucketCount */
-    
-    if (oSymTable->size == oSymTable->bucketCount && 
-        oSymTable->bucketCount != MAX_BUCKET_COUNT)
-    {
-       iSuccessful = SymTable_grow(oSymTable);
-       resized = 1;
-       if (!iSuccessful)
-          return 0;
-    }
-    /* only compute hash again if SymTable has changed */
-    if (resized)
-        index = SymTable_hash(pcKey, oSymTable->bucketCount);
-    
-    newBinding = (struct Binding*)malloc(sizeof(struct Binding));
-    if (newBinding == NULL)
-        return 0;
 
-    /* create defensive copy */
-    newBinding->key = (const char*)malloc(strlen(pcKey) + 1);
-    strcpy((char*)newBinding->key, pcKey);
-    newBinding->value = (void*) pvValue;
+    return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey, 
+                  size_t uLength, const void *pvValue){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_putKey(oSymTable, &sKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putKey(SymTable_T oSymTable, SymTable_Key *psKey,
+                    const void *pvValue){
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
     
-    /* append new binding to beginning of hash bucket (since we know pcKey 
-       not already in SymTable so no additional traversal needed) */
-    newBinding->pNextBinding = oSymTable->buckets[index];
-    oSymTable->buckets[index] = newBinding;
-    (oSymTable->size)++;
-    return 1;
+    SymTable_rehashStep(oSymTable, REHASH_STEP);
 
+    return SymTable_insert(oSymTable, psKey, 
+                           SymTable_hash(oSymTable, psKey), pvValue);
 }
 
 /*--------------------------------------------------------------------*/
 
 void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
     const void *pvValue){
-    size_t index;
-    struct Binding* binding;
+    SymTable_Key sKey;
 
-    assert(oSymTable != NULL);
     assert(pcKey != NULL);
 
-    index = SymTable_hash(pcKey, oSymTable->bucketCount);
-    binding = (oSymTable->buckets)[index];
+    SymTable_initKey(&sKey, pcKey, strlen(pcKey));
+    return SymTable_replaceKey(oSymTable, &sKey, pvValue);
+    }
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceKey(SymTable_T oSymTable, SymTable_Key *psKey,
+    const void *pvValue){
+    struct Binding** ppLink;
+    void *oldValue;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    SymTable_rehashStep(oSymTable, REHASH_STEP);
 
     /* traverse corresponding bucket until finding pcKey and replace */
-    while (binding != NULL){
-        if (strcmp(pcKey, binding->key) == 0){
-            void *oldValue = binding->value;
-            binding->value = (void*) pvValue; 
-            return oldValue;
-        }
-        binding = binding->pNextBinding;
-    }
-    return NULL;
-    
+    ppLink = SymTable_findLink(oSymTable, psKey->pcKey, psKey->uLength,
+                               SymTable_hash(oSymTable, psKey));
+    if (ppLink == NULL)
+        return NULL;
+    oldValue = (*ppLink)->value;
+    (*ppLink)->value = (void*) pvValue; 
+    return oldValue;
     }
 
 /*--------------------------------------------------------------------*/
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
-    size_t index;
-    struct Binding* binding;
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey,
+                    const void *pvValue){
+    void **ppvValue;
+
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
 
-    index = SymTable_hash(pcKey, oSymTable->bucketCount);
-    binding = oSymTable->buckets[index];
+    ppvValue = SymTable_getOrInsert(oSymTable, pcKey, pvValue);
+    if (ppvValue == NULL)
+        return 0;
+    *ppvValue = (void*) pvValue;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable, const char *pcKey,
+                            const void *pvValue){
+    SymTable_Key sKey;
+    struct Binding **ppLink;
+    struct Binding *newBinding;
+    size_t uHash;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    SymTable_rehashStep(oSymTable, REHASH_STEP);
+
+    /* one traversal of the chain(s); a new binding is prepended */
+    SymTable_initKey(&sKey, pcKey, strlen(pcKey));
+    uHash = SymTable_hash(oSymTable, &sKey);
+    ppLink = SymTable_findLink(oSymTable, sKey.pcKey, sKey.uLength, uHash);
+    if (ppLink != NULL)
+        return &(*ppLink)->value;
+    newBinding = SymTable_addBinding(oSymTable, &sKey, uHash, pvValue);
+    if (newBinding == NULL)
+        return NULL;
+    return &newBinding->value;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_containsKey(oSymTable, &sKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    if (oSymTable->traversals == 0)
+        SymTable_rehashStep(oSymTable, REHASH_STEP);
 
     /* traverse corresponding bucket until finding pcKey and return 1
        if found */
-    while (binding != NULL){
-        if (strcmp(pcKey, binding->key) == 0)
-            return 1;
-        binding = binding->pNextBinding;
-    }
-    return 0;
+    return SymTable_findLink(oSymTable, psKey->pcKey, psKey->uLength,
+        SymTable_hash(oSymTable, psKey)) != NULL;
 }
 
 /*--------------------------------------------------------------------*/
 
 void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
-    size_t index;
-    struct Binding* binding;
-    assert(oSymTable != NULL);
     assert(pcKey != NULL);
 
-    index = SymTable_hash(pcKey, oSymTable->bucketCount);
-    binding = oSymTable->buckets[index];
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
 
-    /* traverse corresponding bucket until finding pcKey and return 1
-       if found */
-    while (binding != NULL){
-        if (strcmp(pcKey, binding->key) == 0)
-            return binding->value;
-        binding = binding->pNextBinding;
-    }
-    return NULL;
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey, 
+                    size_t uLength){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_getKey(oSymTable, &sKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    struct Binding** ppLink;
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    if (oSymTable->traversals == 0)
+        SymTable_rehashStep(oSymTable, REHASH_STEP);
+
+    /* traverse corresponding bucket until finding pcKey and return its
+       value if found */
+    ppLink = SymTable_findLink(oSymTable, psKey->pcKey, psKey->uLength,
+                               SymTable_hash(oSymTable, psKey));
+    if (ppLink == NULL)
+        return NULL;
+    return (*ppLink)->value;
 }
 
 /*--------------------------------------------------------------------*/
  
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
-    size_t index;
-    int found = 0;
-    struct Binding* currBinding = NULL;
-    struct Binding* prevBinding = NULL;
+    assert(pcKey != NULL);
+
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_removeKey(oSymTable, &sKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    struct Binding** ppLink;
+    struct Binding* currBinding;
     void *returnValue;
+    size_t index;
     assert(oSymTable != NULL);
-    assert(pcKey != NULL);
-    
-    index = SymTable_hash(pcKey, oSymTable->bucketCount);
-    if (oSymTable->buckets[index] == NULL)
-        return NULL;
-    else currBinding = oSymTable->buckets[index];
+    assert(psKey != NULL);
     
-    /* traverse through bindings and locate it if exists */
-    while (currBinding != NULL){
-        if (strcmp(pcKey, currBinding->key) == 0){
-            found = 1;
-            break;
-        }
-        prevBinding = currBinding;
-        currBinding = currBinding->pNextBinding;
-    }
+    SymTable_rehashStep(oSymTable, REHASH_STEP);
 
-    if (!found || currBinding == NULL)
+    /* traverse through bindings and locate it if exists */
+    ppLink = SymTable_findLink(oSymTable, psKey->pcKey, psKey->uLength,
+                               SymTable_hash(oSymTable, psKey));
+    if (ppLink == NULL)
         return NULL;
 
-    /* case where first binding is binding with key */
-    if (prevBinding == NULL){
-        if (currBinding == NULL)
-            oSymTable->buckets[index] = NULL;
-        else oSymTable->buckets[index] = currBinding->pNextBinding;
-    }
-    else {
-        if (currBinding == NULL)
-            prevBinding->pNextBinding  = NULL;
-        else prevBinding->pNextBinding = currBinding->pNextBinding;
-    }
+    /* unlink the binding from its bucket (or predecessor) */
+    currBinding = *ppLink;
+    *ppLink = currBinding->pNextBinding;
+    /* whichever array the binding was in, its bucket of the current
+       array is now marked empty exactly when it is */
+    index = SymTable_bucketIndex(oSymTable, currBinding->hash,
+                                 oSymTable->bucketCount);
+    if (oSymTable->buckets[index] == NULL)
+        SymTable_markEmpty(oSymTable, index);
 
     returnValue = currBinding->value;
-    free((char*) currBinding->key);
-    free(currBinding);
+    SymTable_freeBinding(oSymTable, currBinding);
     oSymTable->size--;
+
+    /* give back most of the buckets of a table that has shrunk; if 
+       they cannot be reallocated, the table stays as it is; a table 
+       never shrinks below its reserved bucket count, and one already 
+       there skips the search for a smaller count */
+    if (oSymTable->size < SymTable_shrinkSize(oSymTable->bucketCount) &&
+        oSymTable->bucketCount > oSymTable->reservedBucketCount){
+        size_t uNewBucketCount = 
+            SymTable_shrinkHelper(oSymTable->bucketCount);
+        if (uNewBucketCount < oSymTable->reservedBucketCount)
+            uNewBucketCount = oSymTable->reservedBucketCount;
+        if (uNewBucketCount != 0)
+            (void)SymTable_resize(oSymTable, uNewBucketCount);
+    }
     return returnValue;
 }
 
 /*--------------------------------------------------------------------*/
 
+void SymTable_getBatch(SymTable_T oSymTable, const char *const apcKeys[],
+                       size_t uCount, void *apvValues[]){
+    SymTable_Key asKeys[BATCH_BLOCK];
+    size_t auHash[BATCH_BLOCK];
+    size_t uStart;
+    size_t uBlock;
+    size_t u;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL || uCount == 0);
+    assert(apvValues != NULL || uCount == 0);
+
+    for (uStart = 0; uStart < uCount; uStart += uBlock){
+        uBlock = uCount - uStart < BATCH_BLOCK ? 
+            uCount - uStart : BATCH_BLOCK;
+        if (oSymTable->traversals == 0)
+            SymTable_rehashStep(oSymTable, REHASH_STEP * uBlock);
+
+        SymTable_prepareBlock(oSymTable, apcKeys + uStart, uBlock, 
+                              asKeys, auHash);
+        for (u = 0; u < uBlock; u++){
+            struct Binding **ppLink = SymTable_findLink(oSymTable,
+                asKeys[u].pcKey, asKeys[u].uLength, auHash[u]);
+            apvValues[uStart + u] = ppLink == NULL ? NULL : (*ppLink)->value;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable, 
+                         const char *const apcKeys[], size_t uCount,
+                         const void *const apvValues[]){
+    SymTable_Key asKeys[BATCH_BLOCK];
+    size_t auHash[BATCH_BLOCK];
+    size_t uStart;
+    size_t uBlock;
+    size_t u;
+    size_t uAdded = 0;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL || uCount == 0);
+    assert(apvValues != NULL || uCount == 0);
+
+    for (uStart = 0; uStart < uCount; uStart += uBlock){
+        uBlock = uCount - uStart < BATCH_BLOCK ? 
+            uCount - uStart : BATCH_BLOCK;
+        SymTable_rehashStep(oSymTable, REHASH_STEP * uBlock);
+
+        /* a put that grows the table makes the remaining prefetches
+           useless, but not wrong */
+        SymTable_prepareBlock(oSymTable, apcKeys + uStart, uBlock, 
+                              asKeys, auHash);
+        for (u = 0; u < uBlock; u++)
+            uAdded += (size_t)SymTable_insert(oSymTable, &asKeys[u], 
+                auHash[u], apvValues[uStart + u]);
+    }
+    return uAdded;
+}
+
+/*--------------------------------------------------------------------*/
+
 void SymTable_map(SymTable_T oSymTable,
     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
     const void *pvExtra){
@@ -360,12 +1296,191 @@ void SymTable_map(SymTable_T oSymTable,
    assert(pfApply != NULL);
    bucketC = oSymTable->bucketCount;
    
-   /* traverse all bindings and apply pfApply to all key-value pairs */
-   for (index = 0; index < bucketC; index++){
+   /* traverse all bindings and apply pfApply to all key-value pairs,
+      jumping from one non-empty bucket to the next through the
+      occupancy bitmap */
+   for (index = SymTable_nextOccupied(oSymTable, 0, bucketC);
+        index < bucketC;
+        index = SymTable_nextOccupied(oSymTable, index + 1, bucketC)){
         struct Binding* currBinding = oSymTable->buckets[index];
         while (currBinding != NULL){
             (*pfApply)((void*)currBinding->key,(void*)currBinding->value, (void*)pvExtra);
             currBinding = currBinding->pNextBinding;
         }
     }
+   /* including those not yet moved out of the old array */
+   if (oSymTable->oldBuckets != NULL){
+        for (index = oSymTable->rehashIndex; 
+             index < oSymTable->oldBucketCount; index++){
+            struct Binding* currBinding = oSymTable->oldBuckets[index];
+            while (currBinding != NULL){
+                (*pfApply)((void*)currBinding->key,(void*)currBinding->value, (void*)pvExtra);
+                currBinding = currBinding->pNextBinding;
+            }
+        }
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a call to SymTable_mapParallel, shared by the
+   workers that run it. */
+struct MapTask {
+    /* The table */
+    SymTable_T oSymTable;
+    /* The function to apply, and its extra parameter */
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot);
+    const void *pvExtra;
+    /* The slot of each worker, or NULL */
+    void *const *apvSlots;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the MapTask that pvTask points to to the
+   bindings of buckets uStart to uEnd-1, for worker uWorker. Buckets
+   are numbered through buckets and then, during an incremental
+   resize, oldBuckets. */
+
+static void SymTable_mapRange(size_t uStart, size_t uEnd, size_t uWorker,
+                              void *pvTask)
+{
+    struct MapTask *psTask = (struct MapTask*)pvTask;
+    SymTable_T oSymTable;
+    void *pvSlot;
+    size_t index;
+
+    assert(psTask != NULL);
+
+    oSymTable = psTask->oSymTable;
+    pvSlot = psTask->apvSlots == NULL ? NULL : psTask->apvSlots[uWorker];
+    for (index = uStart; index < uEnd; index++){
+        struct Binding *currBinding;
+        /* within the current array, skip to the next non-empty bucket
+           of the range through the occupancy bitmap */
+        if (index < oSymTable->bucketCount){
+            index = SymTable_nextOccupied(oSymTable, index,
+                uEnd < oSymTable->bucketCount ? 
+                uEnd : oSymTable->bucketCount);
+            if (index == uEnd)
+                break;
+        }
+        if (index < oSymTable->bucketCount)
+            currBinding = oSymTable->buckets[index];
+        else if (index - oSymTable->bucketCount >= oSymTable->rehashIndex)
+            currBinding =
+                oSymTable->oldBuckets[index - oSymTable->bucketCount];
+        else currBinding = NULL;
+        while (currBinding != NULL){
+            (*psTask->pfApply)(currBinding->key, currBinding->value,
+                               (void*)psTask->pvExtra, pvSlot);
+            currBinding = currBinding->pNextBinding;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot),
+    const void *pvExtra, size_t uThreadCount, void *const apvSlots[]){
+    struct MapTask sTask;
+    size_t uItemCount;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    assert(uThreadCount > 0);
+
+    sTask.oSymTable = oSymTable;
+    sTask.pfApply = pfApply;
+    sTask.pvExtra = pvExtra;
+    sTask.apvSlots = apvSlots;
+
+    /* the buckets, then those not yet moved out of the old array */
+    uItemCount = oSymTable->bucketCount;
+    if (oSymTable->oldBuckets != NULL)
+        uItemCount += oSymTable->oldBucketCount;
+    SymPar_run(uItemCount, uThreadCount, SymTable_mapRange, &sTask);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter){
+    assert(oSymTable != NULL);
+    assert(psIter != NULL);
+
+    /* an incremental resize in progress is left as it is: the 
+       traversal visits the current bucket array and then the buckets
+       of the old one not yet moved, which lookups leave in place until
+       the traversal ends */
+    oSymTable->traversals++;
+
+    psIter->oSymTable = oSymTable;
+    psIter->uPart = 0;
+    psIter->uIndex = 0;
+    psIter->pvNext = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTable_Iter *psIter, const char **ppcKey,
+                      void **ppvValue){
+    SymTable_T oSymTable;
+    struct Binding *currBinding;
+    size_t index;
+
+    assert(psIter != NULL);
+    assert(psIter->oSymTable != NULL);
+
+    /* the rest of the current chain, or else the next non-empty 
+       bucket after it: in the current array (part 0), then in the old
+       one (part 1) */
+    oSymTable = psIter->oSymTable;
+    currBinding = (struct Binding*)psIter->pvNext;
+    if (currBinding == NULL && psIter->uPart == 0){
+        index = SymTable_nextOccupied(oSymTable, psIter->uIndex,
+                                      oSymTable->bucketCount);
+        if (index == oSymTable->bucketCount){
+            psIter->uPart = 1;
+            psIter->uIndex = oSymTable->rehashIndex;
+        }
+        else {
+            currBinding = oSymTable->buckets[index];
+            psIter->uIndex = index + 1;
+            /* the caller's loop body between calls keeps the processor
+               from running far enough ahead to overlap the cache 
+               misses of many chains, as SymTable_map does, so start 
+               loading a chain a few buckets ahead */
+            index += ITER_PREFETCH_DISTANCE;
+            if (index < oSymTable->bucketCount && 
+                SymTable_isOccupied(oSymTable, index))
+                SymTable_prefetch(oSymTable->buckets[index]);
+        }
+    }
+    /* the old array has no bitmap, and is 0 buckets long when no 
+       resize is in progress */
+    while (currBinding == NULL && 
+           psIter->uIndex < oSymTable->oldBucketCount)
+        currBinding = oSymTable->oldBuckets[psIter->uIndex++];
+    if (currBinding == NULL)
+        return 0;
+    psIter->pvNext = currBinding->pNextBinding;
+
+    if (ppcKey != NULL)
+        *ppcKey = currBinding->key;
+    if (ppvValue != NULL)
+        *ppvValue = currBinding->value;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTable_Iter *psIter){
+    assert(psIter != NULL);
+    assert(psIter->oSymTable != NULL);
+
+    psIter->oSymTable->traversals--;
+    psIter->oSymTable = NULL;
 }
@@ -7,18 +7,37 @@
 #include <string.h>
 #include <stdlib.h>
 #include "symtable.h"
+#include "sympar.h"
+#ifndef SYMTABLE_MALLOC
+#include "sympool.h"
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /*--------------------------------------------------------------------*/
 
-/* Each key-value pair is stored in a node, and points to next Node */
+/* A SymTable holding at most SMALL_CAPACITY bindings also indexes them
+   in an array, where a one-byte tag of each key rules out most
+   non-matching Nodes (with one SSE2 compare where available) before
+   any key is read. */
+enum {SMALL_CAPACITY = 8};
+
+/*--------------------------------------------------------------------*/
+
+/* Each key-value pair is stored in a node, and points to next Node.
+   The key is stored at the end of the node itself, so a binding is a
+   single allocation. */
 struct Node
 {
-   /* The key. */
-   const char *key;
    /* The value. */
    void* value;
+   /* The length of the key, compared before the key itself. */
+   size_t keyLength;
    /* The address of the next Node. */
    struct Node *psNextNode;
+   /* The key (a defensive copy of the client's key). */
+   char key[];
 };
 
 /*--------------------------------------------------------------------*/
@@ -32,142 +51,555 @@ struct SymTable
    size_t size;
    /* The address of the first node. */
    struct Node *psFirstNode;
+   /* While size is at most SMALL_CAPACITY, every node, in no
+      particular order, and the tag of its key (see SymTable_tagOf) */
+   struct Node *apsSmall[SMALL_CAPACITY];
+   unsigned char aucTags[SMALL_CAPACITY];
+   /* The number of traversals (iterators and calls of the map
+      functions) in progress, during which lookups leave the order of
+      the list alone */
+   size_t traversals;
+#ifndef SYMTABLE_MALLOC
+   /* Allocator of the Nodes of this SymTable (unless built with
+      SYMTABLE_MALLOC, which allocates each Node with malloc) */
+   SymPool_T pool;
+#endif
 };
 
 /*--------------------------------------------------------------------*/
 
+/* Allocate a Node for oSymTable with room for a key of uKeySize bytes
+   (including the terminating '\0'). Returns its address, or NULL if
+   insufficient memory. */
+
+static struct Node *SymTable_allocNode(SymTable_T oSymTable,
+                                       size_t uKeySize){
+   assert(oSymTable != NULL);
+#ifdef SYMTABLE_MALLOC
+   (void)oSymTable;
+   return (struct Node*)malloc(sizeof(struct Node) + uKeySize);
+#else
+   return (struct Node*)SymPool_alloc(oSymTable->pool,
+                                      sizeof(struct Node) + uKeySize);
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Release psNode, allocated by SymTable_allocNode for oSymTable. */
+
+static void SymTable_freeNode(SymTable_T oSymTable, struct Node *psNode){
+   assert(oSymTable != NULL);
+   assert(psNode != NULL);
+#ifdef SYMTABLE_MALLOC
+   (void)oSymTable;
+   free(psNode);
+#else
+   SymPool_release(oSymTable->pool, psNode,
+                   sizeof(struct Node) + psNode->keyLength + 1);
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the tag of the key that is the uLength characters starting at
+   pcKey: a mix of its length and its first and last characters, which
+   tell apart most identifiers of a scope. */
+
+static unsigned char SymTable_tagOf(const char *pcKey, size_t uLength){
+   assert(pcKey != NULL);
+
+   if (uLength == 0)
+      return 0;
+   return (unsigned char)(uLength * 31u +
+                          (unsigned char)pcKey[0] * 7u +
+                          (unsigned char)pcKey[uLength - 1]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a bit mask with bit i set if tag i of the SMALL_CAPACITY tags
+   at pucTags equals ucTag. */
+
+static unsigned SymTable_matchTag(const unsigned char *pucTags,
+                                  unsigned char ucTag){
+#ifdef __SSE2__
+   __m128i tags = _mm_loadl_epi64((const __m128i *)pucTags);
+   __m128i match = _mm_cmpeq_epi8(tags, _mm_set1_epi8((char)ucTag));
+   return (unsigned)_mm_movemask_epi8(match) & 0xFFu;
+#else
+   unsigned uMask = 0;
+   int i;
+   for (i = 0; i < SMALL_CAPACITY; i++){
+      if (pucTags[i] == ucTag)
+         uMask |= 1u << i;
+   }
+   return uMask;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the lowest set bit of the nonzero uMask. */
+
+static int SymTable_lowestBit(unsigned uMask){
+   int i = 0;
+   assert(uMask != 0);
+#ifdef __GNUC__
+   i = __builtin_ctz(uMask);
+#else
+   while ((uMask & 1u) == 0){
+      uMask >>= 1;
+      i++;
+   }
+#endif
+   return i;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Index every node of oSymTable, which holds at most SMALL_CAPACITY,
+   in its small array, in list order. */
+
+static void SymTable_indexSmall(SymTable_T oSymTable){
+   struct Node *current;
+   size_t u = 0;
+
+   assert(oSymTable != NULL);
+   assert(oSymTable->size <= SMALL_CAPACITY);
+
+   for (current = oSymTable->psFirstNode; current != NULL;
+        current = current->psNextNode){
+      oSymTable->apsSmall[u] = current;
+      oSymTable->aucTags[u] = SymTable_tagOf(current->key,
+                                             current->keyLength);
+      u++;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the node of oSymTable whose key is the uLength characters
+   starting at pcKey, or NULL if no such node exists. A node found in
+   the list is moved to its front, so that the symbols looked up most
+   often are found soonest. */
+
+static struct Node *SymTable_findNode(SymTable_T oSymTable,
+                                      const char *pcKey, size_t uLength){
+   struct Node* current;
+   struct Node* prevNode = NULL;
+   unsigned uMatches;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   if (oSymTable->size <= SMALL_CAPACITY){
+      /* read only the keys whose tags match */
+      uMatches = SymTable_matchTag(oSymTable->aucTags,
+                                   SymTable_tagOf(pcKey, uLength)) &
+                 ((1u << oSymTable->size) - 1u);
+      while (uMatches != 0){
+         current = oSymTable->apsSmall[SymTable_lowestBit(uMatches)];
+         if (current->keyLength == uLength &&
+             memcmp(pcKey, current->key, uLength) == 0)
+            return current;
+         uMatches &= uMatches - 1u;
+      }
+      return NULL;
+   }
+
+   for (current = oSymTable->psFirstNode; current != NULL;
+        prevNode = current, current = current->psNextNode){
+      if (current->keyLength == uLength &&
+          memcmp(pcKey, current->key, uLength) == 0){
+         /* a traversal in progress would skip or revisit a node that
+            moves, so then the list stays as it is */
+         if (prevNode != NULL && oSymTable->traversals == 0){
+            prevNode->psNextNode = current->psNextNode;
+            current->psNextNode = oSymTable->psFirstNode;
+            oSymTable->psFirstNode = current;
+         }
+         return current;
+      }
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a node with key the uLength characters starting at pcKey, which
+   oSymTable does not contain, and value pvValue to the front of 
+   oSymTable. Return the new node, or NULL if insufficient memory. */
+
+static struct Node *SymTable_addNode(SymTable_T oSymTable,
+                                     const char *pcKey, size_t uLength,
+                                     const void *pvValue){
+   struct Node *psNewNode;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   /* allocate the node together with a defensive copy of key */
+   psNewNode = SymTable_allocNode(oSymTable, uLength + 1);
+   if (psNewNode == NULL)
+      return NULL;
+   memcpy(psNewNode->key, pcKey, uLength);
+   psNewNode->key[uLength] = '\0';
+   psNewNode->keyLength = uLength;
+   psNewNode->value = (void*) pvValue;
+
+   /* append new Node to beginning of the list (since we know pcKey 
+      not already in SymTable so no additional traversal needed) */
+   psNewNode->psNextNode = oSymTable->psFirstNode;
+   oSymTable->psFirstNode = psNewNode;
+   oSymTable->size++;
+   if (oSymTable->size <= SMALL_CAPACITY){
+      oSymTable->apsSmall[oSymTable->size - 1] = psNewNode;
+      oSymTable->aucTags[oSymTable->size - 1] =
+         SymTable_tagOf(pcKey, uLength);
+   }
+   return psNewNode;
+}
+
+/*--------------------------------------------------------------------*/
+
 SymTable_T SymTable_new(void){
    SymTable_T oSymTable;
    oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
    if (oSymTable == NULL)
       return NULL;
+#ifndef SYMTABLE_MALLOC
+   oSymTable->pool = SymPool_new();
+   if (oSymTable->pool == NULL){
+      free(oSymTable);
+      return NULL;
+   }
+#endif
 
    oSymTable->psFirstNode = NULL;
    oSymTable->size = 0;
+   memset(oSymTable->aucTags, 0, sizeof(oSymTable->aucTags));
+   oSymTable->traversals = 0;
    return oSymTable;
 }
 
 /*--------------------------------------------------------------------*/
 
+SymTable_T SymTable_newWithHash(enum SymTable_HashFunction eHash){
+   /* keys are never hashed */
+   (void)eHash;
+   return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity){
+   /* a list holds any number of bindings without resizing */
+   (void)uCapacity;
+   return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity){
+   assert(oSymTable != NULL);
+   (void)uCapacity;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
 void SymTable_free(SymTable_T oSymTable){
+#ifdef SYMTABLE_MALLOC
    struct Node *psCurrentNode;
    struct Node *psNextNode;
+#endif
 
    assert(oSymTable != NULL);
 
+#ifndef SYMTABLE_MALLOC
+   /* every node lives in the pool, which is released as a whole */
+   SymPool_free(oSymTable->pool);
+#else
    for (psCurrentNode = oSymTable->psFirstNode;
         psCurrentNode != NULL;
         psCurrentNode = psNextNode)
    {
       psNextNode = psCurrentNode->psNextNode;
-      free((char*)psCurrentNode->key);
       free(psCurrentNode);
    }
+#endif
 
    free(oSymTable);
 }
 
 /*--------------------------------------------------------------------*/
 
+int SymTable_compact(SymTable_T oSymTable){
+   struct Node **apsCopies;
+   struct Node **ppsLink;
+   struct Node *psCurrentNode;
+   size_t u = 0;
+#ifndef SYMTABLE_MALLOC
+   SymPool_T oldPool;
+#endif
+
+   assert(oSymTable != NULL);
+
+   /* copy the nodes into fresh memory (a new pool, which leaves behind
+      the free lists of the old one) first, so that running out of
+      memory halfway leaves every node where it was */
+   apsCopies = (struct Node**)
+      malloc((oSymTable->size + 1) * sizeof(struct Node *));
+   if (apsCopies == NULL)
+      return 0;
+#ifndef SYMTABLE_MALLOC
+   oldPool = oSymTable->pool;
+   oSymTable->pool = SymPool_new();
+   if (oSymTable->pool == NULL)
+   {
+      oSymTable->pool = oldPool;
+      free(apsCopies);
+      return 0;
+   }
+#endif
+   for (psCurrentNode = oSymTable->psFirstNode;
+        psCurrentNode != NULL;
+        psCurrentNode = psCurrentNode->psNextNode)
+   {
+      apsCopies[u] = SymTable_allocNode(oSymTable,
+                                        psCurrentNode->keyLength + 1);
+      if (apsCopies[u] == NULL)
+         break;
+      memcpy(apsCopies[u], psCurrentNode,
+             sizeof(struct Node) + psCurrentNode->keyLength + 1);
+      u++;
+   }
+   if (u < oSymTable->size)
+   {
+#ifdef SYMTABLE_MALLOC
+      while (u > 0)
+         free(apsCopies[--u]);
+#else
+      SymPool_free(oSymTable->pool);
+      oSymTable->pool = oldPool;
+#endif
+      free(apsCopies);
+      return 0;
+   }
+
+   /* then link each copy in place of its original, in list order */
+   u = 0;
+   for (ppsLink = &oSymTable->psFirstNode; *ppsLink != NULL;
+        ppsLink = &(*ppsLink)->psNextNode)
+   {
+#ifdef SYMTABLE_MALLOC
+      free(*ppsLink);
+#endif
+      *ppsLink = apsCopies[u++];
+   }
+#ifndef SYMTABLE_MALLOC
+   SymPool_free(oldPool);
+#endif
+   free(apsCopies);
+   if (oSymTable->size <= SMALL_CAPACITY)
+      SymTable_indexSmall(oSymTable);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
 size_t SymTable_getLength(SymTable_T oSymTable){
    return oSymTable->size;
 }
 
 /*--------------------------------------------------------------------*/
 
+void SymTable_initKey(SymTable_Key *psKey, const char *pcKey,
+    size_t uLength){
+   assert(psKey != NULL);
+   assert(pcKey != NULL);
+
+   /* keys are never hashed, so no hash code is ever cached */
+   psKey->pcKey = pcKey;
+   psKey->uLength = uLength;
+   psKey->uHashMask = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
 int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue){
-   struct Node *psNewNode;
+   assert(pcKey != NULL);
+
+   return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
 
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, const void *pvValue){
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
 
    /* traverse list just once to check if pcKey already in the SymTable */
-   if (SymTable_contains(oSymTable, pcKey)) 
+   if (SymTable_findNode(oSymTable, pcKey, uLength) != NULL) 
       return 0;
-   
-   psNewNode = (struct Node*)malloc(sizeof(struct Node));
-   if (psNewNode == NULL)
-      return 0;
-   
-   /* create a defensive copy of key */
-   psNewNode->key = (const char*)malloc(strlen(pcKey) + 1);
-   strcpy((char*)psNewNode->key, pcKey);
-   psNewNode->value = (void*) pvValue;
+   return SymTable_addNode(oSymTable, pcKey, uLength, pvValue) != NULL;
+}
 
-   /* append new Node to beginning of the list (since we know pcKey 
-      not already in SymTable so no additional traversal needed) */
-   psNewNode->psNextNode = oSymTable->psFirstNode;
-   oSymTable->psFirstNode = psNewNode;
-   oSymTable->size++;
-   return 1;
+/*--------------------------------------------------------------------*/
+
+int SymTable_putKey(SymTable_T oSymTable, SymTable_Key *psKey,
+    const void *pvValue){
+   assert(psKey != NULL);
+
+   return SymTable_putN(oSymTable, psKey->pcKey, psKey->uLength, pvValue);
 }
 
 /*--------------------------------------------------------------------*/
 
 void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
+    const void *pvValue){
+   SymTable_Key sKey;
+
+   assert(pcKey != NULL);
+
+   SymTable_initKey(&sKey, pcKey, strlen(pcKey));
+   return SymTable_replaceKey(oSymTable, &sKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceKey(SymTable_T oSymTable, SymTable_Key *psKey,
     const void *pvValue){
       struct Node* current;
+      void *oldValue;
 
       assert(oSymTable != NULL);
-      assert(pcKey != NULL);
-
-      /* traverse list until finding pcKey and replace */
-      current = oSymTable->psFirstNode;
-      while (current != NULL){
-         if (strcmp(pcKey, current->key) == 0){
-            void *oldValue = current->value;
-            current->value = (void*) pvValue;
-            return oldValue; 
-         }
-         current = current->psNextNode;
-      }
-      return NULL;
+      assert(psKey != NULL);
+
+      /* find pcKey and replace */
+      current = SymTable_findNode(oSymTable, psKey->pcKey, psKey->uLength);
+      if (current == NULL)
+         return NULL;
+      oldValue = current->value;
+      current->value = (void*) pvValue;
+      return oldValue;
     }
 
 /*--------------------------------------------------------------------*/
 
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey,
+    const void *pvValue){
+   void **ppvValue;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   ppvValue = SymTable_getOrInsert(oSymTable, pcKey, pvValue);
+   if (ppvValue == NULL)
+      return 0;
+   *ppvValue = (void*) pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable, const char *pcKey,
+    const void *pvValue){
+   struct Node *psNode;
+   size_t uLength;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   /* traverse list once; a new node goes to its front */
+   uLength = strlen(pcKey);
+   psNode = SymTable_findNode(oSymTable, pcKey, uLength);
+   if (psNode == NULL){
+      psNode = SymTable_addNode(oSymTable, pcKey, uLength, pvValue);
+      if (psNode == NULL)
+         return NULL;
+   }
+   return &psNode->value;
+}
+
+/*--------------------------------------------------------------------*/
+
 int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
-   struct Node* current;
-   
+   assert(pcKey != NULL);
+
+   return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength){
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
    
-   /* traverse list until finding pcKey and return 1 if found */
-   current = oSymTable->psFirstNode;
-   while (current != NULL){
-      if (strcmp(pcKey, current->key) == 0)
-         return 1; 
-      current = current->psNextNode;
-   }
-   return 0;
+   /* return 1 if pcKey is found */
+   return SymTable_findNode(oSymTable, pcKey, uLength) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsKey(SymTable_T oSymTable, SymTable_Key *psKey){
+   assert(psKey != NULL);
+
+   return SymTable_containsN(oSymTable, psKey->pcKey, psKey->uLength);
 }
 
 /*--------------------------------------------------------------------*/
 
 void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
+   assert(pcKey != NULL);
+
+   return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength){
    struct Node* current;
 
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
 
-   /* traverse list until finding pcKey and return its value */
-   current = oSymTable->psFirstNode;
-   while (current != NULL){
-      if (strcmp(pcKey, current->key) == 0){
-         return current->value; 
-      }
-      current = current->psNextNode;
-   }
-   return NULL;
+   /* find pcKey and return its value */
+   current = SymTable_findNode(oSymTable, pcKey, uLength);
+   if (current == NULL)
+      return NULL;
+   return current->value;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getKey(SymTable_T oSymTable, SymTable_Key *psKey){
+   assert(psKey != NULL);
+
+   return SymTable_getN(oSymTable, psKey->pcKey, psKey->uLength);
 }
 
 /*--------------------------------------------------------------------*/
  
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
+   assert(pcKey != NULL);
+
+   return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength){
    struct Node* current;
    struct Node* prevNode = NULL;
    void *returnValue;
    int found = 0;
+   size_t u;
 
    assert(oSymTable != NULL);
    assert(pcKey != NULL);
@@ -175,7 +607,8 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
    /* traverse thru Nodes until found */
    current = oSymTable->psFirstNode;
    while (current != NULL){
-      if (strcmp(pcKey, current->key) == 0){
+      if (current->keyLength == uLength &&
+          memcmp(pcKey, current->key, uLength) == 0){
          found = 1;
          break;
       }
@@ -189,15 +622,65 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
       oSymTable->psFirstNode = current->psNextNode;
    else prevNode->psNextNode = current->psNextNode;
    
+   /* the last indexed node takes the place of a removed one, and the
+      list is indexed anew once it is small enough */
+   if (oSymTable->size <= SMALL_CAPACITY){
+      for (u = 0; oSymTable->apsSmall[u] != current; u++)
+         assert(u + 1 < oSymTable->size);
+      oSymTable->apsSmall[u] = oSymTable->apsSmall[oSymTable->size - 1];
+      oSymTable->aucTags[u] = oSymTable->aucTags[oSymTable->size - 1];
+   }
+
    returnValue = current->value;
-   free((char*) current->key);
-   free(current);
+   SymTable_freeNode(oSymTable, current);
    oSymTable->size--;
+   if (oSymTable->size == SMALL_CAPACITY)
+      SymTable_indexSmall(oSymTable);
    return returnValue;
 }
 
 /*--------------------------------------------------------------------*/
 
+void *SymTable_removeKey(SymTable_T oSymTable, SymTable_Key *psKey){
+   assert(psKey != NULL);
+
+   return SymTable_removeN(oSymTable, psKey->pcKey, psKey->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable, const char *const apcKeys[],
+    size_t uCount, void *apvValues[]){
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0);
+   assert(apvValues != NULL || uCount == 0);
+
+   /* every lookup walks the same list, so there is nothing to overlap */
+   for (u = 0; u < uCount; u++)
+      apvValues[u] = SymTable_get(oSymTable, apcKeys[u]);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable, 
+    const char *const apcKeys[], size_t uCount, 
+    const void *const apvValues[]){
+   size_t u;
+   size_t uAdded = 0;
+
+   assert(oSymTable != NULL);
+   assert(apcKeys != NULL || uCount == 0);
+   assert(apvValues != NULL || uCount == 0);
+
+   for (u = 0; u < uCount; u++)
+      uAdded += (size_t)SymTable_put(oSymTable, apcKeys[u], apvValues[u]);
+   return uAdded;
+}
+
+/*--------------------------------------------------------------------*/
+
 void SymTable_map(SymTable_T oSymTable,
     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
     const void *pvExtra){
@@ -207,8 +690,141 @@ void SymTable_map(SymTable_T oSymTable,
    assert(pfApply != NULL);
 
    /* traverse list and apply pfApply to all key-value pairs */
+   oSymTable->traversals++;
    for (psCurrentNode = oSymTable->psFirstNode;
         psCurrentNode != NULL;
         psCurrentNode = psCurrentNode->psNextNode)
       (*pfApply)((void*)psCurrentNode->key,(void*)psCurrentNode->value, (void*)pvExtra);
+   oSymTable->traversals--;
     }
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a call to SymTable_mapParallel, shared by the
+   workers that run it. */
+struct MapTask
+{
+   /* The Nodes of the table, in list order */
+   struct Node **apsNodes;
+   /* The function to apply, and its extra parameter */
+   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                   void *pvSlot);
+   const void *pvExtra;
+   /* The slot of each worker, or NULL */
+   void *const *apvSlots;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the MapTask that pvTask points to to Nodes
+   uStart to uEnd-1 of its array, for worker uWorker. */
+
+static void SymTable_mapRange(size_t uStart, size_t uEnd, size_t uWorker,
+                              void *pvTask)
+{
+   struct MapTask *psTask = (struct MapTask*)pvTask;
+   void *pvSlot;
+   size_t u;
+
+   assert(psTask != NULL);
+
+   pvSlot = psTask->apvSlots == NULL ? NULL : psTask->apvSlots[uWorker];
+   for (u = uStart; u < uEnd; u++)
+      (*psTask->pfApply)(psTask->apsNodes[u]->key,
+                         psTask->apsNodes[u]->value,
+                         (void*)psTask->pvExtra, pvSlot);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot),
+    const void *pvExtra, size_t uThreadCount, void *const apvSlots[]){
+   struct MapTask sTask;
+   struct Node *psCurrentNode;
+   size_t u = 0;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+   assert(uThreadCount > 0);
+
+   /* a list cannot be split without walking it, so the Nodes are
+      first gathered into an array; pfApply may look bindings up from
+      several threads, which must then leave the list alone */
+   oSymTable->traversals++;
+   sTask.apsNodes = NULL;
+   if (uThreadCount > 1 && oSymTable->size > 1 &&
+       oSymTable->size <= (size_t)-1 / sizeof(struct Node *))
+      sTask.apsNodes = (struct Node**)
+         malloc(oSymTable->size * sizeof(struct Node *));
+   if (sTask.apsNodes == NULL)
+   {
+      /* work alone */
+      for (psCurrentNode = oSymTable->psFirstNode;
+           psCurrentNode != NULL;
+           psCurrentNode = psCurrentNode->psNextNode)
+         (*pfApply)(psCurrentNode->key, psCurrentNode->value,
+                    (void*)pvExtra,
+                    apvSlots == NULL ? NULL : apvSlots[0]);
+      oSymTable->traversals--;
+      return;
+   }
+
+   for (psCurrentNode = oSymTable->psFirstNode;
+        psCurrentNode != NULL;
+        psCurrentNode = psCurrentNode->psNextNode)
+      sTask.apsNodes[u++] = psCurrentNode;
+   sTask.pfApply = pfApply;
+   sTask.pvExtra = pvExtra;
+   sTask.apvSlots = apvSlots;
+   SymPar_run(u, uThreadCount, SymTable_mapRange, &sTask);
+   free(sTask.apsNodes);
+   oSymTable->traversals--;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter){
+   assert(oSymTable != NULL);
+   assert(psIter != NULL);
+
+   oSymTable->traversals++;
+   psIter->oSymTable = oSymTable;
+   psIter->uPart = 0;
+   psIter->uIndex = 0;
+   psIter->pvNext = oSymTable->psFirstNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTable_Iter *psIter, const char **ppcKey,
+                      void **ppvValue){
+   struct Node *psCurrentNode;
+
+   assert(psIter != NULL);
+   assert(psIter->oSymTable != NULL);
+
+   psCurrentNode = (struct Node*)psIter->pvNext;
+   if (psCurrentNode == NULL)
+      return 0;
+   psIter->pvNext = psCurrentNode->psNextNode;
+
+   if (ppcKey != NULL)
+      *ppcKey = psCurrentNode->key;
+   if (ppvValue != NULL)
+      *ppvValue = psCurrentNode->value;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTable_Iter *psIter){
+   assert(psIter != NULL);
+
+   assert(psIter->oSymTable != NULL);
+
+   /* lookups may reorder the list again */
+   psIter->oSymTable->traversals--;
+   psIter->oSymTable = NULL;
+}
@@ -0,0 +1,1046 @@
+/*--------------------------------------------------------------------*/
+/* symtableopen.c                                                     */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "symhash.h"
+#include "sympar.h"
+#include "sympool.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The table is a flat, open-addressed array of slots together with a
+   parallel array of control bytes, one per slot. Slots are probed a
+   group of GROUP_SIZE control bytes at a time (with one SSE2 compare
+   where available), so most lookups touch one control cache line and
+   one slot. */
+
+/* Number of control bytes examined at once. */
+enum {GROUP_SIZE = 16};
+
+/* Number of slots in a new SymTable (one group). */
+enum {INIT_CAPACITY = GROUP_SIZE};
+
+/* Control byte values. A full slot's control byte holds the low 7 bits
+   of its key's hash code (0 to 127), so that a single byte comparison
+   rules out most non-matching slots. An empty slot ends every probe
+   sequence; a deleted slot (tombstone) does not. */
+enum {CTRL_EMPTY = 0x80, CTRL_DELETED = 0xFE};
+
+/* Number of keys that SymTable_getBatch and SymTable_putBatch hash,
+   and whose first probe group they prefetch, before resolving any of
+   them. */
+enum {BATCH_BLOCK = 16};
+
+/* Each key-value pair is stored in a Slot of the slot array */
+struct Slot {
+    /* The full hash code of the key, checked before comparing keys
+       and reused when the table is rebuilt. */
+    size_t hash;
+    /* The value. */
+    void *value;
+    /* The address of a defensive copy of the key, allocated from the
+       pool of the table. Slots move whenever the table is rebuilt,
+       but the copy stays put, so it is the key handed to clients. */
+    const char *pcKey;
+    /* The length of the key, checked (after the hash code) before the
+       copy is loaded. */
+    size_t keyLength;
+};
+
+/* A SymTable structure symbol table implemented as an open-addressed
+   hash table with control bytes. */
+struct SymTable {
+    /* Array of capacity control bytes */
+    unsigned char *ctrl;
+    /* Array of capacity slots */
+    struct Slot *slots;
+    /* Number of slots, a power of 2 that is at least GROUP_SIZE */
+    size_t capacity;
+    /* The size (number of bindings) in SymTable */
+    size_t size;
+    /* Number of empty slots that may still be filled before the table
+       must be rebuilt, keeping the load (including tombstones) at or
+       below 7/8 */
+    size_t growthLeft;
+    /* Hash function applied to keys */
+    enum SymTable_HashFunction hashFunction;
+    /* Allocator of the key copies of this SymTable, or NULL until the
+       first one is allocated */
+    SymPool_T pool;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a hash code for the key of the handle *psKey, computed with
+   the hash function of oSymTable (which the handle may have cached).
+   Both the low 7 bits (the control byte) and the high bits
+   (the group) must be well distributed, so the multiplicative hash is
+   followed by a finalizer; the wide hash already is. */
+
+static size_t SymTable_hash(SymTable_T oSymTable, SymTable_Key *psKey)
+{
+    unsigned long long ullHash;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    ullHash = SymHash_keyHash(psKey, oSymTable->hashFunction);
+    if (oSymTable->hashFunction != SYMTABLE_HASH_MULTIPLICATIVE)
+        return (size_t)ullHash;
+
+    /* 64-bit finalizer from MurmurHash3 */
+    ullHash ^= ullHash >> 33;
+    ullHash *= 0xff51afd7ed558ccdULL;
+    ullHash ^= ullHash >> 33;
+    ullHash *= 0xc4ceb9fe1a85ec53ULL;
+    ullHash ^= ullHash >> 33;
+    return (size_t)ullHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the key of psSlot, which remains at the same address until
+   the binding is removed. */
+
+static const char *SymTable_slotKey(const struct Slot *psSlot)
+{
+    assert(psSlot != NULL);
+    return psSlot->pcKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if the key of psSlot is the uLength characters
+   starting at pcKey, or 0 (FALSE) otherwise. The copy of the key is
+   only loaded if the lengths match. */
+
+static int SymTable_keyEquals(const struct Slot *psSlot, 
+                              const char *pcKey, size_t uLength)
+{
+    assert(psSlot != NULL);
+    assert(pcKey != NULL);
+
+    return psSlot->keyLength == uLength &&
+        memcmp(psSlot->pcKey, pcKey, uLength) == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Store a defensive copy of the key made of the uLength characters
+   starting at pcKey, allocated from the pool of oSymTable, in psSlot.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available. */
+
+static int SymTable_setSlotKey(SymTable_T oSymTable, struct Slot *psSlot,
+                               const char *pcKey, size_t uLength)
+{
+    char *pcCopy;
+
+    assert(oSymTable != NULL);
+    assert(psSlot != NULL);
+    assert(pcKey != NULL);
+
+    if (oSymTable->pool == NULL){
+        oSymTable->pool = SymPool_new();
+        if (oSymTable->pool == NULL)
+            return 0;
+    }
+    pcCopy = (char*)SymPool_alloc(oSymTable->pool, uLength + 1);
+    if (pcCopy == NULL)
+        return 0;
+    memcpy(pcCopy, pcKey, uLength);
+    pcCopy[uLength] = '\0';
+    psSlot->pcKey = pcCopy;
+    psSlot->keyLength = uLength;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the key copy of psSlot to the pool of oSymTable. */
+
+static void SymTable_freeSlotKey(SymTable_T oSymTable, struct Slot *psSlot)
+{
+    assert(oSymTable != NULL);
+    assert(psSlot != NULL);
+
+    SymPool_release(oSymTable->pool, (char*)psSlot->pcKey,
+                    psSlot->keyLength + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the control byte of a full slot whose key has hash code
+   uHash. */
+
+static unsigned char SymTable_h2(size_t uHash)
+{
+    return (unsigned char)(uHash & 0x7F);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of the group at which the probe sequence for hash
+   code uHash starts, in a table with uGroupMask + 1 groups. */
+
+static size_t SymTable_h1(size_t uHash, size_t uGroupMask)
+{
+    return (uHash >> 7) & uGroupMask;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a bit mask with bit i set if byte i of the group of
+   GROUP_SIZE control bytes at pucGroup equals ucByte. */
+
+static unsigned SymTable_matchByte(const unsigned char *pucGroup,
+                                   unsigned char ucByte)
+{
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128((const __m128i *)pucGroup);
+    __m128i match = _mm_cmpeq_epi8(group, _mm_set1_epi8((char)ucByte));
+    return (unsigned)_mm_movemask_epi8(match);
+#else
+    unsigned uMask = 0;
+    int i;
+    for (i = 0; i < GROUP_SIZE; i++){
+        if (pucGroup[i] == ucByte)
+            uMask |= 1u << i;
+    }
+    return uMask;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a bit mask with bit i set if byte i of the group of
+   GROUP_SIZE control bytes at pucGroup marks an empty or deleted
+   slot. */
+
+static unsigned SymTable_matchFree(const unsigned char *pucGroup)
+{
+#ifdef __SSE2__
+    /* exactly the free control bytes have their high bit set */
+    __m128i group = _mm_loadu_si128((const __m128i *)pucGroup);
+    return (unsigned)_mm_movemask_epi8(group);
+#else
+    unsigned uMask = 0;
+    int i;
+    for (i = 0; i < GROUP_SIZE; i++){
+        if (pucGroup[i] & 0x80)
+            uMask |= 1u << i;
+    }
+    return uMask;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the lowest set bit of the nonzero uMask. */
+
+static int SymTable_lowestBit(unsigned uMask)
+{
+    int i = 0;
+    assert(uMask != 0);
+#ifdef __GNUC__
+    i = __builtin_ctz(uMask);
+#else
+    while ((uMask & 1u) == 0){
+        uMask >>= 1;
+        i++;
+    }
+#endif
+    return i;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of full slots a table of uCapacity slots may hold
+   (including tombstones) before it must be rebuilt. */
+
+static size_t SymTable_maxLoad(size_t uCapacity)
+{
+    return uCapacity - uCapacity / 8;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the smallest capacity, a power of two times GROUP_SIZE, 
+   whose maximum load is at least uCount, or 0 if no such capacity 
+   could be addressed. */
+
+static size_t SymTable_capacityFor(size_t uCount)
+{
+    size_t uCapacity = INIT_CAPACITY;
+
+    while (SymTable_maxLoad(uCapacity) < uCount){
+        if (uCapacity > ((size_t)-1 / sizeof(struct Slot)) / 2)
+            return 0;
+        uCapacity *= 2;
+    }
+    return uCapacity;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the slot of oSymTable that holds the binding
+   whose key is the uLength characters starting at pcKey, or 
+   oSymTable->capacity if no such binding exists. uHash is the hash
+   code of the key. */
+
+static size_t SymTable_find(SymTable_T oSymTable, const char *pcKey,
+                            size_t uLength, size_t uHash)
+{
+    size_t uGroupMask = oSymTable->capacity / GROUP_SIZE - 1;
+    size_t uGroup = SymTable_h1(uHash, uGroupMask);
+    size_t uProbe = 0;
+    unsigned char ucH2 = SymTable_h2(uHash);
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /* probe group after group (triangular sequence, which visits
+       every group) until a group with an empty slot is seen */
+    for (;;){
+        const unsigned char *pucGroup =
+            oSymTable->ctrl + uGroup * GROUP_SIZE;
+        unsigned uMatches = SymTable_matchByte(pucGroup, ucH2);
+        while (uMatches != 0){
+            size_t index =
+                uGroup * GROUP_SIZE + (size_t)SymTable_lowestBit(uMatches);
+            struct Slot *psSlot = &oSymTable->slots[index];
+            if (psSlot->hash == uHash &&
+                SymTable_keyEquals(psSlot, pcKey, uLength))
+                return index;
+            uMatches &= uMatches - 1;
+        }
+        if (SymTable_matchByte(pucGroup, CTRL_EMPTY) != 0)
+            return oSymTable->capacity;
+        uProbe++;
+        if (uProbe > uGroupMask)
+            return oSymTable->capacity;
+        uGroup = (uGroup + uProbe) & uGroupMask;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the first empty or deleted slot on the probe
+   sequence for hash code uHash in the ctrl array of uCapacity
+   control bytes. The table must have such a slot. */
+
+static size_t SymTable_findFree(const unsigned char *ctrl,
+                                size_t uCapacity, size_t uHash)
+{
+    size_t uGroupMask = uCapacity / GROUP_SIZE - 1;
+    size_t uGroup = SymTable_h1(uHash, uGroupMask);
+    size_t uProbe = 0;
+
+    assert(ctrl != NULL);
+
+    for (;;){
+        unsigned uFree = SymTable_matchFree(ctrl + uGroup * GROUP_SIZE);
+        if (uFree != 0)
+            return uGroup * GROUP_SIZE + (size_t)SymTable_lowestBit(uFree);
+        uProbe++;
+        assert(uProbe <= uGroupMask);
+        uGroup = (uGroup + uProbe) & uGroupMask;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Rebuild oSymTable with uNewCapacity slots, moving every binding
+   (without copying keys or rehashing them) and dropping tombstones.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available, in which case oSymTable is unchanged. */
+
+static int SymTable_rebuild(SymTable_T oSymTable, size_t uNewCapacity)
+{
+    unsigned char *newCtrl;
+    struct Slot *newSlots;
+    size_t index;
+
+    assert(oSymTable != NULL);
+    assert(uNewCapacity >= GROUP_SIZE);
+    assert(SymTable_maxLoad(uNewCapacity) > oSymTable->size);
+
+    newCtrl = (unsigned char*) malloc(uNewCapacity);
+    if (newCtrl == NULL)
+        return 0;
+    newSlots = (struct Slot*) malloc(uNewCapacity * sizeof(struct Slot));
+    if (newSlots == NULL){
+        free(newCtrl);
+        return 0;
+    }
+    memset(newCtrl, CTRL_EMPTY, uNewCapacity);
+
+    for (index = 0; index < oSymTable->capacity; index++){
+        size_t uNewIndex;
+        if (oSymTable->ctrl[index] & 0x80)
+            continue;
+        uNewIndex = SymTable_findFree(newCtrl, uNewCapacity,
+                                      oSymTable->slots[index].hash);
+        newCtrl[uNewIndex] = oSymTable->ctrl[index];
+        newSlots[uNewIndex] = oSymTable->slots[index];
+    }
+
+    free(oSymTable->ctrl);
+    free(oSymTable->slots);
+    oSymTable->ctrl = newCtrl;
+    oSymTable->slots = newSlots;
+    oSymTable->capacity = uNewCapacity;
+    oSymTable->growthLeft = SymTable_maxLoad(uNewCapacity) - oSymTable->size;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make room in oSymTable for one more binding: rebuild at the same
+   capacity if tombstones take up most of the load, or at twice the
+   capacity otherwise. Return 1 (TRUE) if successful, or 0 (FALSE) if
+   insufficient memory is available. */
+
+static int SymTable_grow(SymTable_T oSymTable)
+{
+    size_t uCapacity = oSymTable->capacity;
+
+    assert(oSymTable != NULL);
+
+    if (oSymTable->size < SymTable_maxLoad(uCapacity) / 2)
+        return SymTable_rebuild(oSymTable, uCapacity);
+    if (uCapacity > ((size_t)-1 / sizeof(struct Slot)) / 2)
+        return 0;
+    return SymTable_rebuild(oSymTable, uCapacity * 2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a binding of the key of the handle *psKey, whose hash code is
+   uHash and which oSymTable does not contain, to oSymTable with value
+   pvValue, rebuilding the table if needed. Return the index of its 
+   slot, or oSymTable->capacity if insufficient memory is available. */
+
+static size_t SymTable_addSlot(SymTable_T oSymTable, SymTable_Key *psKey,
+                               size_t uHash, const void *pvValue)
+{
+    size_t index;
+    struct Slot sNewSlot;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    /* create defensive copy before changing the table, so that
+       running out of memory leaves it unchanged */
+    if (!SymTable_setSlotKey(oSymTable, &sNewSlot, psKey->pcKey,
+                             psKey->uLength))
+        return oSymTable->capacity;
+    sNewSlot.value = (void*) pvValue;
+    sNewSlot.hash = uHash;
+
+    index = SymTable_findFree(oSymTable->ctrl, oSymTable->capacity, uHash);
+    /* filling an empty slot uses up growth; reusing a tombstone
+       does not */
+    if (oSymTable->ctrl[index] == CTRL_EMPTY){
+        if (oSymTable->growthLeft == 0){
+            if (!SymTable_grow(oSymTable)){
+                SymTable_freeSlotKey(oSymTable, &sNewSlot);
+                return oSymTable->capacity;
+            }
+            index = SymTable_findFree(oSymTable->ctrl,
+                                      oSymTable->capacity, uHash);
+        }
+        if (oSymTable->ctrl[index] == CTRL_EMPTY)
+            oSymTable->growthLeft--;
+    }
+
+    oSymTable->ctrl[index] = SymTable_h2(uHash);
+    oSymTable->slots[index] = sNewSlot;
+    oSymTable->size++;
+    return index;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a binding of the key of the handle *psKey, whose hash code is
+   uHash, to oSymTable with value pvValue, as SymTable_put does: return
+   1 (TRUE) if successful, or 0 (FALSE) if oSymTable already contains
+   the key or insufficient memory is available. */
+
+static int SymTable_insert(SymTable_T oSymTable, SymTable_Key *psKey,
+                           size_t uHash, const void *pvValue)
+{
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    if (SymTable_find(oSymTable, psKey->pcKey, psKey->uLength, uHash) != 
+        oSymTable->capacity)
+        return 0;
+    return SymTable_addSlot(oSymTable, psKey, uHash, pvValue) != 
+        oSymTable->capacity;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Ask the processor to start loading the cache line at pv, if the
+   compiler offers a way to. */
+
+static void SymTable_prefetch(const void *pv)
+{
+#ifdef __GNUC__
+    __builtin_prefetch(pv);
+#else
+    (void)pv;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Prepare the uCount (at most BATCH_BLOCK) keys at apcKeys for a batch
+   operation on oSymTable: make a handle for each in asKeys, store its
+   hash code in auHash, and prefetch the control bytes and the first
+   slot of the group where its probe sequence starts. */
+
+static void SymTable_prepareBlock(SymTable_T oSymTable,
+                                  const char *const apcKeys[],
+                                  size_t uCount, SymTable_Key asKeys[],
+                                  size_t auHash[])
+{
+    size_t uGroupMask = oSymTable->capacity / GROUP_SIZE - 1;
+    size_t u;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL);
+    assert(uCount <= BATCH_BLOCK);
+
+    for (u = 0; u < uCount; u++){
+        size_t uFirst;
+        assert(apcKeys[u] != NULL);
+        SymTable_initKey(&asKeys[u], apcKeys[u], strlen(apcKeys[u]));
+        auHash[u] = SymTable_hash(oSymTable, &asKeys[u]);
+        uFirst = SymTable_h1(auHash[u], uGroupMask) * GROUP_SIZE;
+        SymTable_prefetch(oSymTable->ctrl + uFirst);
+        SymTable_prefetch(oSymTable->slots + uFirst);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void){
+    return SymTable_newWithHash(SYMTABLE_HASH_MULTIPLICATIVE);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithHash(enum SymTable_HashFunction eHash){
+    SymTable_T oSymTable;
+
+    oSymTable = (SymTable_T) malloc(sizeof(struct SymTable));
+    if (oSymTable == NULL)
+        return NULL;
+
+    oSymTable->ctrl = (unsigned char*) malloc(INIT_CAPACITY);
+    oSymTable->slots =
+        (struct Slot*) malloc(INIT_CAPACITY * sizeof(struct Slot));
+    if (oSymTable->ctrl == NULL || oSymTable->slots == NULL){
+        free(oSymTable->ctrl);
+        free(oSymTable->slots);
+        free(oSymTable);
+        return NULL;
+    }
+    memset(oSymTable->ctrl, CTRL_EMPTY, INIT_CAPACITY);
+
+    oSymTable->capacity = INIT_CAPACITY;
+    oSymTable->size = 0;
+    oSymTable->growthLeft = SymTable_maxLoad(INIT_CAPACITY);
+    oSymTable->hashFunction = eHash;
+    oSymTable->pool = NULL;
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity){
+    SymTable_T oSymTable;
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+        return NULL;
+    if (!SymTable_reserve(oSymTable, uCapacity)){
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity){
+    size_t uNewCapacity;
+
+    assert(oSymTable != NULL);
+
+    /* the table never shrinks, so only growing needs to be avoided */
+    uNewCapacity = SymTable_capacityFor(uCapacity);
+    if (uNewCapacity == 0)
+        return 0;
+    if (uNewCapacity <= oSymTable->capacity)
+        return 1;
+    return SymTable_rebuild(oSymTable, uNewCapacity);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    /* every key copy lives in the pool, which is released as a whole */
+    if (oSymTable->pool != NULL)
+        SymPool_free(oSymTable->pool);
+    free(oSymTable->ctrl);
+    free(oSymTable->slots);
+    free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_compact(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    /* the smallest capacity that holds the bindings within the maximum
+       load; rebuilding also clears every tombstone. The key copies
+       stay where they are. */
+    return SymTable_rebuild(oSymTable, 
+                            SymTable_capacityFor(oSymTable->size + 1));
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable){
+    assert(oSymTable != NULL);
+
+    return oSymTable->size;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_initKey(SymTable_Key *psKey, const char *pcKey,
+                      size_t uLength){
+    assert(psKey != NULL);
+    assert(pcKey != NULL);
+
+    psKey->pcKey = pcKey;
+    psKey->uLength = uLength;
+    psKey->uHashMask = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey,
+                 const void *pvValue){
+    assert(pcKey != NULL);
+
+    return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+                  size_t uLength, const void *pvValue){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_putKey(oSymTable, &sKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putKey(SymTable_T oSymTable, SymTable_Key *psKey,
+                    const void *pvValue){
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    return SymTable_insert(oSymTable, psKey, 
+                           SymTable_hash(oSymTable, psKey), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
+    const void *pvValue){
+    SymTable_Key sKey;
+
+    assert(pcKey != NULL);
+
+    SymTable_initKey(&sKey, pcKey, strlen(pcKey));
+    return SymTable_replaceKey(oSymTable, &sKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replaceKey(SymTable_T oSymTable, SymTable_Key *psKey,
+    const void *pvValue){
+    size_t index;
+    void *oldValue;
+
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    index = SymTable_find(oSymTable, psKey->pcKey, psKey->uLength,
+                          SymTable_hash(oSymTable, psKey));
+    if (index == oSymTable->capacity)
+        return NULL;
+    oldValue = oSymTable->slots[index].value;
+    oSymTable->slots[index].value = (void*) pvValue;
+    return oldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsert(SymTable_T oSymTable, const char *pcKey,
+                    const void *pvValue){
+    void **ppvValue;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    ppvValue = SymTable_getOrInsert(oSymTable, pcKey, pvValue);
+    if (ppvValue == NULL)
+        return 0;
+    *ppvValue = (void*) pvValue;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable, const char *pcKey,
+                            const void *pvValue){
+    SymTable_Key sKey;
+    size_t uHash;
+    size_t index;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /* one probe sequence over the key's groups, then (for a new key)
+       one over their control bytes to find a free slot */
+    SymTable_initKey(&sKey, pcKey, strlen(pcKey));
+    uHash = SymTable_hash(oSymTable, &sKey);
+    index = SymTable_find(oSymTable, sKey.pcKey, sKey.uLength, uHash);
+    if (index == oSymTable->capacity){
+        index = SymTable_addSlot(oSymTable, &sKey, uHash, pvValue);
+        if (index == oSymTable->capacity)
+            return NULL;
+    }
+    return &oSymTable->slots[index].value;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_containsKey(oSymTable, &sKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    return SymTable_find(oSymTable, psKey->pcKey, psKey->uLength,
+                         SymTable_hash(oSymTable, psKey))
+        != oSymTable->capacity;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+                    size_t uLength){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_getKey(oSymTable, &sKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    size_t index;
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    index = SymTable_find(oSymTable, psKey->pcKey, psKey->uLength,
+                          SymTable_hash(oSymTable, psKey));
+    if (index == oSymTable->capacity)
+        return NULL;
+    return oSymTable->slots[index].value;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey){
+    assert(pcKey != NULL);
+
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength){
+    SymTable_Key sKey;
+
+    SymTable_initKey(&sKey, pcKey, uLength);
+    return SymTable_removeKey(oSymTable, &sKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_removeKey(SymTable_T oSymTable, SymTable_Key *psKey){
+    size_t index;
+    size_t uGroupStart;
+    void *returnValue;
+    assert(oSymTable != NULL);
+    assert(psKey != NULL);
+
+    index = SymTable_find(oSymTable, psKey->pcKey, psKey->uLength,
+                          SymTable_hash(oSymTable, psKey));
+    if (index == oSymTable->capacity)
+        return NULL;
+
+    /* A group that still has an empty slot has never been full since
+       the last rebuild, so no probe sequence has continued past it and
+       the slot can become empty again. Otherwise leave a tombstone. */
+    uGroupStart = index - index % GROUP_SIZE;
+    if (SymTable_matchByte(oSymTable->ctrl + uGroupStart, CTRL_EMPTY) != 0){
+        oSymTable->ctrl[index] = CTRL_EMPTY;
+        oSymTable->growthLeft++;
+    }
+    else oSymTable->ctrl[index] = CTRL_DELETED;
+
+    returnValue = oSymTable->slots[index].value;
+    SymTable_freeSlotKey(oSymTable, &oSymTable->slots[index]);
+    oSymTable->size--;
+    return returnValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable, const char *const apcKeys[],
+                       size_t uCount, void *apvValues[]){
+    SymTable_Key asKeys[BATCH_BLOCK];
+    size_t auHash[BATCH_BLOCK];
+    size_t uStart;
+    size_t uBlock;
+    size_t u;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL || uCount == 0);
+    assert(apvValues != NULL || uCount == 0);
+
+    for (uStart = 0; uStart < uCount; uStart += uBlock){
+        uBlock = uCount - uStart < BATCH_BLOCK ?
+            uCount - uStart : BATCH_BLOCK;
+        SymTable_prepareBlock(oSymTable, apcKeys + uStart, uBlock,
+                              asKeys, auHash);
+        for (u = 0; u < uBlock; u++){
+            size_t index = SymTable_find(oSymTable, asKeys[u].pcKey,
+                asKeys[u].uLength, auHash[u]);
+            apvValues[uStart + u] = index == oSymTable->capacity ?
+                NULL : oSymTable->slots[index].value;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_putBatch(SymTable_T oSymTable,
+                         const char *const apcKeys[], size_t uCount,
+                         const void *const apvValues[]){
+    SymTable_Key asKeys[BATCH_BLOCK];
+    size_t auHash[BATCH_BLOCK];
+    size_t uStart;
+    size_t uBlock;
+    size_t u;
+    size_t uAdded = 0;
+
+    assert(oSymTable != NULL);
+    assert(apcKeys != NULL || uCount == 0);
+    assert(apvValues != NULL || uCount == 0);
+
+    for (uStart = 0; uStart < uCount; uStart += uBlock){
+        uBlock = uCount - uStart < BATCH_BLOCK ?
+            uCount - uStart : BATCH_BLOCK;
+        /* a put that grows the table makes the remaining prefetches
+           useless, but not wrong */
+        SymTable_prepareBlock(oSymTable, apcKeys + uStart, uBlock,
+                              asKeys, auHash);
+        for (u = 0; u < uBlock; u++)
+            uAdded += (size_t)SymTable_insert(oSymTable, &asKeys[u],
+                auHash[u], apvValues[uStart + u]);
+    }
+    return uAdded;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra){
+    size_t index;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    /* apply pfApply to the key-value pair of every full slot */
+    for (index = 0; index < oSymTable->capacity; index++){
+        if ((oSymTable->ctrl[index] & 0x80) == 0)
+            (*pfApply)(SymTable_slotKey(&oSymTable->slots[index]),
+                       oSymTable->slots[index].value, (void*)pvExtra);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a call to SymTable_mapParallel, shared by the
+   workers that run it. */
+struct MapTask {
+    /* The table */
+    SymTable_T oSymTable;
+    /* The function to apply, and its extra parameter */
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot);
+    const void *pvExtra;
+    /* The slot of each worker, or NULL */
+    void *const *apvSlots;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the MapTask that pvTask points to to the
+   full slots from uStart to uEnd-1, for worker uWorker. */
+
+static void SymTable_mapRange(size_t uStart, size_t uEnd, size_t uWorker,
+                              void *pvTask)
+{
+    struct MapTask *psTask = (struct MapTask*)pvTask;
+    SymTable_T oSymTable;
+    void *pvSlot;
+    size_t index;
+
+    assert(psTask != NULL);
+
+    oSymTable = psTask->oSymTable;
+    pvSlot = psTask->apvSlots == NULL ? NULL : psTask->apvSlots[uWorker];
+    for (index = uStart; index < uEnd; index++){
+        if ((oSymTable->ctrl[index] & 0x80) == 0)
+            (*psTask->pfApply)(SymTable_slotKey(&oSymTable->slots[index]),
+                               oSymTable->slots[index].value,
+                               (void*)psTask->pvExtra, pvSlot);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra,
+                    void *pvSlot),
+    const void *pvExtra, size_t uThreadCount, void *const apvSlots[]){
+    struct MapTask sTask;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    assert(uThreadCount > 0);
+
+    sTask.oSymTable = oSymTable;
+    sTask.pfApply = pfApply;
+    sTask.pvExtra = pvExtra;
+    sTask.apvSlots = apvSlots;
+    SymPar_run(oSymTable->capacity, uThreadCount, SymTable_mapRange,
+               &sTask);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *psIter){
+    assert(oSymTable != NULL);
+    assert(psIter != NULL);
+
+    psIter->oSymTable = oSymTable;
+    psIter->uPart = 0;
+    psIter->uIndex = 0;
+    psIter->pvNext = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTable_Iter *psIter, const char **ppcKey,
+                      void **ppvValue){
+    SymTable_T oSymTable;
+    size_t uGroup;
+    size_t index;
+    unsigned uFull;
+
+    assert(psIter != NULL);
+    assert(psIter->oSymTable != NULL);
+
+    /* the control bytes serve as the occupancy bitmap: each group of
+       them yields the mask of its full slots, from which the slots 
+       before uIndex are cleared */
+    oSymTable = psIter->oSymTable;
+    while (psIter->uIndex < oSymTable->capacity){
+        uGroup = psIter->uIndex & ~(size_t)(GROUP_SIZE - 1);
+        uFull = ~SymTable_matchFree(&oSymTable->ctrl[uGroup]) &
+            ((1u << GROUP_SIZE) - 1) &
+            (~0u << (psIter->uIndex - uGroup));
+        if (uFull != 0){
+            index = uGroup + (size_t)SymTable_lowestBit(uFull);
+            psIter->uIndex = index + 1;
+            if (ppcKey != NULL)
+                *ppcKey = SymTable_slotKey(&oSymTable->slots[index]);
+            if (ppvValue != NULL)
+                *ppvValue = oSymTable->slots[index].value;
+            return 1;
+        }
+        psIter->uIndex = uGroup + GROUP_SIZE;
+    }
+    return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTable_Iter *psIter){
+    assert(psIter != NULL);
+
+    /* nothing was acquired */
+    psIter->oSymTable = NULL;
+}
@@ -0,0 +1,48 @@
+/*--------------------------------------------------------------------*/
+/* symtableordered.h                                                  */
+/* Author: Mahmudul Rapi                                              */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLEORDERED_INCLUDED
+#define SYMTABLEORDERED_INCLUDED
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+
+/*--------------------------------------------------------------------*/
+
+/* Extensions of the SymTable interface that only the ordered
+   implementations (the B+tree of symtablebtree.c and the radix tree of
+   symtableart.c) provide. They keep their bindings sorted by key, in
+   the order of strcmp, so SymTable_map and SymTable_iterNext visit
+   them in that order too. */
+
+/*--------------------------------------------------------------------*/
+
+/* Applies function *pfApply to each binding of oSymTable whose key is
+   at least pcLow and less than pcHigh, in order of their keys, passing
+   pvExtra as an extra parameter. A NULL pcLow or pcHigh leaves the
+   range unbounded on that side. Takes time proportional to the log of
+   the number of bindings of oSymTable (or, for the radix tree, the
+   length of the bounds) plus the number of bindings in the range.
+   pfApply must not update oSymTable. */
+
+void SymTable_range(SymTable_T oSymTable, const char *pcLow,
+    const char *pcHigh,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra);
+
+/*--------------------------------------------------------------------*/
+
+/* Applies function *pfApply to each binding of oSymTable whose key
+   begins with pcPrefix, in order of their keys, passing pvExtra as an
+   extra parameter, in time proportional to the log of the number of
+   bindings of oSymTable (or the length of pcPrefix) plus the number
+   of bindings visited. pfApply must not update oSymTable. */
+
+void SymTable_prefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra);
+
+/*--------------------------------------------------------------------*/
+#endif
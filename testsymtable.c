@@ -4,6 +4,9 @@
 /*--------------------------------------------------------------------*/
 
 #include "symtable.h"
+#ifdef SYMTABLE_ORDERED
+#include "symtableordered.h"
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -83,6 +86,23 @@ static void printBindingSimple(const char *pcKey, void *pvValue,
 
 /*--------------------------------------------------------------------*/
 
+/* Store the key pcKey in the next element of the array of keys that
+   pvExtra points to the address of. pvValue is unused. */
+
+static void keepKey(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   const char ***pppcNext = (const char***)pvExtra;
+
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+   (void)pvValue;
+
+   **pppcNext = pcKey;
+   (*pppcNext)++;
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the most basic SymTable functions. */
 
 static void testBasics(void)
@@ -383,6 +403,64 @@ static void testRemove(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Test a table that grows to two dozen bindings and shrinks back to
+   none, one binding at a time, when its keys agree in their lengths
+   and their first and last characters, as many names of a scope do. */
+
+static void testLookalikeKeys(void)
+{
+   enum {KEY_COUNT = 24};
+   enum {MAX_KEY_LENGTH = 8};
+
+   SymTable_T oSymTable;
+   char aacKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   int aiRemoved[KEY_COUNT] = {0};
+   int i;
+   int j;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing keys that look alike.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (i = 0; i < KEY_COUNT; i++)
+      sprintf(aacKeys[i], "t%02dt", i);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* After each put, exactly the keys put so far are found. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+      ASSURE(iSuccessful);
+      ASSURE(! SymTable_put(oSymTable, aacKeys[i], aacKeys[0]));
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)i + 1);
+      for (j = 0; j < KEY_COUNT; j++)
+         ASSURE(SymTable_get(oSymTable, aacKeys[j]) ==
+            (j <= i ? aacKeys[j] : NULL));
+   }
+
+   /* After each removal, the odd keys first and then the even ones
+      from the last, exactly the rest are found. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      int iRemoved = i < KEY_COUNT / 2 ? 2 * i + 1 : 2 * (KEY_COUNT - i) - 2;
+      ASSURE(SymTable_remove(oSymTable, aacKeys[iRemoved]) ==
+         aacKeys[iRemoved]);
+      ASSURE(SymTable_remove(oSymTable, aacKeys[iRemoved]) == NULL);
+      aiRemoved[iRemoved] = 1;
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)(KEY_COUNT - i - 1));
+      for (j = 0; j < KEY_COUNT; j++)
+         ASSURE(SymTable_contains(oSymTable, aacKeys[j]) == ! aiRemoved[j]);
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the SymTable_map() function. */
 
 static void testMap(void)
@@ -397,6 +475,14 @@ static void testMap(void)
    char acFirstBase[] = "First Base";
    char acRightField[] = "Right Field";
 
+   enum {PLAYER_COUNT = 4};
+   enum {GROWTH_COUNT = 1000};
+   enum {MAX_KEY_LENGTH = 12};
+
+   const char *apcKeys[PLAYER_COUNT];
+   const char **ppcNext;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
    int iSuccessful;
 
    printf("------------------------------------------------------\n");
@@ -426,6 +512,26 @@ static void testMap(void)
    fflush(stdout);
    SymTable_map(oSymTable, printBindingSimple, NULL);
 
+   /* The keys that SymTable_map passes stay valid as the table 
+      grows. */
+   ppcNext = apcKeys;
+   SymTable_map(oSymTable, keepKey, &ppcNext);
+   ASSURE(ppcNext == apcKeys + PLAYER_COUNT);
+   for (i = 0; i < GROWTH_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, NULL);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < PLAYER_COUNT; i++)
+   {
+      ASSURE(strcmp(apcKeys[i], acJeter) == 0 ||
+         strcmp(apcKeys[i], acMantle) == 0 ||
+         strcmp(apcKeys[i], acGehrig) == 0 ||
+         strcmp(apcKeys[i], acRuth) == 0);
+      ASSURE(SymTable_contains(oSymTable, apcKeys[i]));
+   }
+
    SymTable_free(oSymTable);
 }
 
@@ -572,240 +678,1421 @@ static void testNullValue(void)
 
 /*--------------------------------------------------------------------*/
 
-/* Test the ability of a SymTable object to contain long keys. */
+/* Test SymTable_putN, SymTable_containsN, SymTable_getN, and
+   SymTable_removeN, whose keys are slices of a larger buffer that
+   are not followed by '\0'. */
 
-static void testLongKey(void)
+static void testKeySlices(void)
 {
-   enum {KEY_SIZE = 1000};
+   enum {LONG_KEY_SIZE = 40};
 
    SymTable_T oSymTable;
-   char acKeyA[KEY_SIZE];
-   char acKeyB[KEY_SIZE];
-   char *pcValue;
+   const char acText[] = "Ruth Gehrig Ruthless";
+   char acLongKey[LONG_KEY_SIZE];
    char acShortstop[] = "Shortstop";
+   char acCatcher[] = "Catcher";
+   char *pcValue;
    int iFound;
-   int i;
-   size_t uLength;
    int iSuccessful;
+   size_t uLength;
 
    printf("------------------------------------------------------\n");
-   printf("Testing a SymTable object that contains long keys.\n");
+   printf("Testing the functions whose keys have a length.\n");
    printf("No output should appear here:\n");
    fflush(stdout);
 
-   for (i = 0; i < KEY_SIZE - 1; i++)
-      acKeyA[i] = 'a';
-   acKeyA[KEY_SIZE - 1] = '\0';
-
-   for (i = 0; i < KEY_SIZE - 1; i++)
-      acKeyB[i] = 'b';
-   acKeyB[KEY_SIZE - 1] = '\0';
-
    oSymTable = SymTable_new();
    ASSURE(oSymTable != NULL);
 
-   iSuccessful = SymTable_put(oSymTable, acKeyA, acShortstop);
+   /* "Ruth", the first 4 characters of acText. */
+   iSuccessful = SymTable_putN(oSymTable, acText, 4, acShortstop);
    ASSURE(iSuccessful);
-   iSuccessful = SymTable_put(oSymTable, acKeyB, acShortstop);
-   ASSURE(iSuccessful);
-   iSuccessful = SymTable_put(oSymTable, acKeyB, acShortstop);
+   iSuccessful = SymTable_putN(oSymTable, acText + 12, 4, acShortstop);
+   ASSURE(! iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", acShortstop);
    ASSURE(! iSuccessful);
 
+   /* "Gehrig", in the middle of acText. */
+   iSuccessful = SymTable_putN(oSymTable, acText + 5, 6, acCatcher);
+   ASSURE(iSuccessful);
+
+   /* The empty key. */
+   iSuccessful = SymTable_putN(oSymTable, acText, 0, acCatcher);
+   ASSURE(iSuccessful);
+
    uLength = SymTable_getLength(oSymTable);
-   ASSURE(uLength == 2);
+   ASSURE(uLength == 3);
 
-   iFound = SymTable_contains(oSymTable, acKeyA);
+   iFound = SymTable_contains(oSymTable, "Ruth");
    ASSURE(iFound);
-   iFound = SymTable_contains(oSymTable, acKeyB);
+   iFound = SymTable_contains(oSymTable, "Gehrig");
    ASSURE(iFound);
+   iFound = SymTable_contains(oSymTable, "");
+   ASSURE(iFound);
+   iFound = SymTable_containsN(oSymTable, acText + 12, 4);
+   ASSURE(iFound);
+   iFound = SymTable_containsN(oSymTable, acText + 12, 8);
+   ASSURE(! iFound);
+   iFound = SymTable_containsN(oSymTable, acText, 3);
+   ASSURE(! iFound);
 
-   pcValue = (char*)SymTable_get(oSymTable, acKeyA);
-   ASSURE(pcValue == acShortstop);
-   pcValue = (char*)SymTable_get(oSymTable, acKeyB);
+   pcValue = (char*)SymTable_getN(oSymTable, acText + 5, 6);
+   ASSURE(pcValue == acCatcher);
+   pcValue = (char*)SymTable_getN(oSymTable, acText + 5, 5);
+   ASSURE(pcValue == NULL);
+   pcValue = (char*)SymTable_getN(oSymTable, "Ruthless", 4);
    ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_getN(oSymTable, "", 0);
+   ASSURE(pcValue == acCatcher);
 
-   pcValue = (char*)SymTable_remove(oSymTable, acKeyB);
+   /* A long key, not stored inline by every implementation. */
+   memset(acLongKey, 'z', LONG_KEY_SIZE);
+   iSuccessful = SymTable_putN(oSymTable, acLongKey, LONG_KEY_SIZE - 1,
+      acShortstop);
+   ASSURE(iSuccessful);
+   iFound = SymTable_containsN(oSymTable, acLongKey, LONG_KEY_SIZE);
+   ASSURE(! iFound);
+   iFound = SymTable_containsN(oSymTable, acLongKey, LONG_KEY_SIZE - 2);
+   ASSURE(! iFound);
+   acLongKey[LONG_KEY_SIZE - 1] = '\0';
+   pcValue = (char*)SymTable_get(oSymTable, acLongKey);
    ASSURE(pcValue == acShortstop);
-   pcValue = (char*)SymTable_remove(oSymTable, acKeyB);
+
+   pcValue = (char*)SymTable_removeN(oSymTable, acText + 12, 8);
    ASSURE(pcValue == NULL);
-   pcValue = (char*)SymTable_remove(oSymTable, acKeyA);
+   pcValue = (char*)SymTable_removeN(oSymTable, acText + 12, 4);
    ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_removeN(oSymTable, acLongKey, 
+      LONG_KEY_SIZE - 1);
+   ASSURE(pcValue == acShortstop);
+   iFound = SymTable_contains(oSymTable, "Ruth");
+   ASSURE(! iFound);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 2);
 
    SymTable_free(oSymTable);
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Test the ability of SymTable object to have values that are
-   other SymTable objects. */
+/* Test the functions that take a key handle, using one handle with
+   SymTable objects that hash keys with different hash functions. */
 
-static void testTableOfTables(void)
+static void testKeyHandles(void)
 {
-   SymTable_T oSymTable;
    SymTable_T oSymTable1;
    SymTable_T oSymTable2;
-   SymTable_T oSymTableRet;
+   SymTable_Key sRuth;
+   SymTable_Key sGehrig;
+   const char acText[] = "Ruth Gehrig";
    char acShortstop[] = "Shortstop";
-   char acCenterField[] = "CenterField";
+   char acCatcher[] = "Catcher";
    char *pcValue;
+   int iFound;
    int iSuccessful;
+   size_t uLength;
 
    printf("------------------------------------------------------\n");
-   printf("Testing a SymTable object that contains other\n");
-   printf("SymTable objects.\n");
+   printf("Testing the functions whose keys are key handles.\n");
    printf("No output should appear here:\n");
    fflush(stdout);
 
    oSymTable1 = SymTable_new();
    ASSURE(oSymTable1 != NULL);
-
-   iSuccessful = SymTable_put(oSymTable1, "Jeter", acShortstop);
-   ASSURE(iSuccessful);
-
-   oSymTable2 = SymTable_new();
+   oSymTable2 = SymTable_newWithHash(SYMTABLE_HASH_WIDE);
    ASSURE(oSymTable2 != NULL);
 
-   iSuccessful = SymTable_put(oSymTable2, "Mantle", acCenterField);
-   ASSURE(iSuccessful);
-
-   oSymTable = SymTable_new();
-   ASSURE(oSymTable != NULL);
+   SymTable_initKey(&sRuth, acText, 4);
+   SymTable_initKey(&sGehrig, acText + 5, 6);
 
-   iSuccessful = SymTable_put(oSymTable, "first table", oSymTable1);
+   iSuccessful = SymTable_putKey(oSymTable1, &sRuth, acShortstop);
    ASSURE(iSuccessful);
-
-   iSuccessful = SymTable_put(oSymTable, "second table", oSymTable2);
+   iSuccessful = SymTable_putKey(oSymTable2, &sRuth, acCatcher);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putKey(oSymTable2, &sRuth, acCatcher);
+   ASSURE(! iSuccessful);
+   iSuccessful = SymTable_put(oSymTable2, "Gehrig", acShortstop);
    ASSURE(iSuccessful);
 
-   oSymTableRet = (SymTable_T)SymTable_get(oSymTable, "first table");
-   ASSURE(oSymTableRet == oSymTable1);
+   /* The handles agree with the functions that take strings. */
+   pcValue = (char*)SymTable_get(oSymTable1, "Ruth");
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_get(oSymTable2, "Ruth");
+   ASSURE(pcValue == acCatcher);
+   pcValue = (char*)SymTable_getKey(oSymTable1, &sRuth);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_getKey(oSymTable2, &sRuth);
+   ASSURE(pcValue == acCatcher);
+   pcValue = (char*)SymTable_getKey(oSymTable1, &sGehrig);
+   ASSURE(pcValue == NULL);
+   pcValue = (char*)SymTable_getKey(oSymTable2, &sGehrig);
+   ASSURE(pcValue == acShortstop);
+   iFound = SymTable_containsKey(oSymTable1, &sGehrig);
+   ASSURE(! iFound);
+   iFound = SymTable_containsKey(oSymTable2, &sGehrig);
+   ASSURE(iFound);
 
-   pcValue = (char*)SymTable_get(oSymTableRet, "Jeter");
+   pcValue = (char*)SymTable_replaceKey(oSymTable1, &sRuth, acCatcher);
    ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_replaceKey(oSymTable1, &sGehrig, acCatcher);
+   ASSURE(pcValue == NULL);
+   pcValue = (char*)SymTable_get(oSymTable1, "Ruth");
+   ASSURE(pcValue == acCatcher);
 
-   oSymTableRet = (SymTable_T)SymTable_get(oSymTable, "second table");
-   ASSURE(oSymTableRet == oSymTable2);
+   pcValue = (char*)SymTable_removeKey(oSymTable2, &sRuth);
+   ASSURE(pcValue == acCatcher);
+   pcValue = (char*)SymTable_removeKey(oSymTable2, &sRuth);
+   ASSURE(pcValue == NULL);
+   iFound = SymTable_contains(oSymTable2, "Ruth");
+   ASSURE(! iFound);
+   iFound = SymTable_containsKey(oSymTable1, &sRuth);
+   ASSURE(iFound);
 
-   pcValue = (char*)SymTable_get(oSymTableRet, "Mantle");
-   ASSURE(pcValue == acCenterField);
+   uLength = SymTable_getLength(oSymTable1);
+   ASSURE(uLength == 1);
+   uLength = SymTable_getLength(oSymTable2);
+   ASSURE(uLength == 1);
 
-   SymTable_free(oSymTable2);
    SymTable_free(oSymTable1);
-   SymTable_free(oSymTable);
+   SymTable_free(oSymTable2);
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Test the ability of a SymTable object to handle collisions.  This
-   test assumes that a SymTable object is implemented as a hash table,
-   that there are 509 buckets in the hash table, and that the
-   implementation uses the hash function provided in the assignment
-   specification. */
-
-static void testCollisions(void)
-{
-   SymTable_T oSymTable;
-   int iSuccessful;
-   char acCenterField[] = "pitcher";
-   char acCatcher[] = "catcher";
-   char acFirstBase[] = "first base";
-   char acRightField[] = "second base";
-   char *pcValue;
-
-   printf("------------------------------------------------------\n");
-   printf("Testing the collision handling of a SymTable object\n");
-   printf("assuming a hash table implementation, and assuming that\n");
-   printf("the implementation uses the hash function from the\n");
-   printf("assignment specification.\n");
-   printf("No output should appear here:\n");
-   fflush(stdout);
+/* The pvExtra argument that testMapParallel passes. */
 
-   oSymTable = SymTable_new();
-   ASSURE(oSymTable != NULL);
+static char acMapExtra[] = "extra";
 
-   /* Note that strings "250", "469", "947", "1303", and "2016" hash
-      to the same bucket -- bucket 123. */
+/*--------------------------------------------------------------------*/
 
-   iSuccessful = SymTable_put(oSymTable, "250", acCenterField);
-   ASSURE(iSuccessful);
+/* Count a visit of a binding whose value pvValue points to an int
+   counter, and add it to the size_t counter that pvSlot points to, if
+   any. Check that pvExtra is the one testMapParallel passes. */
 
-   iSuccessful = SymTable_put(oSymTable, "469", acCatcher);
-   ASSURE(iSuccessful);
+static void countVisit(const char *pcKey, void *pvValue, void *pvExtra,
+   void *pvSlot)
+{
+   ASSURE(pcKey != NULL);
+   ASSURE(pvExtra == acMapExtra);
+   (*(int*)pvValue)++;
+   if (pvSlot != NULL)
+      (*(size_t*)pvSlot)++;
+}
 
-   iSuccessful = SymTable_put(oSymTable, "947", acFirstBase);
-   ASSURE(iSuccessful);
+/*--------------------------------------------------------------------*/
 
-   iSuccessful = SymTable_put(oSymTable, "1303", acRightField);
-   ASSURE(iSuccessful);
+/* Count a visit of a binding as countVisit does, without a slot. */
 
-   iSuccessful = SymTable_put(oSymTable, "2016", acRightField);
-   ASSURE(iSuccessful);
+static void countVisitSerially(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   countVisit(pcKey, pvValue, pvExtra, NULL);
+}
 
-   pcValue = SymTable_get(oSymTable, "250");
-   ASSURE(pcValue == acCenterField);
+/*--------------------------------------------------------------------*/
 
-   pcValue = SymTable_get(oSymTable, "469");
-   ASSURE(pcValue == acCatcher);
+/* Test SymTable_mapParallel with a table of iBindingCount bindings. */
 
-   pcValue = SymTable_get(oSymTable, "947");
-   ASSURE(pcValue == acFirstBase);
+static void testMapParallel(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {THREAD_COUNT = 4};
 
-   pcValue = SymTable_get(oSymTable, "1303");
-   ASSURE(pcValue == acRightField);
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int *aiVisits;
+   size_t auCounts[THREAD_COUNT];
+   void *apvSlots[THREAD_COUNT];
+   size_t uThreads;
+   size_t uTotal;
+   size_t u;
+   int i;
+   int iSuccessful;
 
-   pcValue = SymTable_get(oSymTable, "2016");
-   ASSURE(pcValue == acRightField);
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_mapParallel.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
 
-   pcValue = SymTable_remove(oSymTable, "947");
-   ASSURE(pcValue == acFirstBase);
+   aiVisits = (int*)calloc((size_t)iBindingCount + 1, sizeof(int));
+   ASSURE(aiVisits != NULL);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
 
-   pcValue = SymTable_remove(oSymTable, "2016");
-   ASSURE(pcValue == acRightField);
+   /* An empty table is never visited. */
+   SymTable_mapParallel(oSymTable, countVisit, acMapExtra, THREAD_COUNT,
+      NULL);
 
-   pcValue = SymTable_remove(oSymTable, "250");
-   ASSURE(pcValue == acCenterField);
+   /* The value of key i counts the visits of its binding. */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiVisits[i]);
+      ASSURE(iSuccessful);
+   }
 
-   pcValue = SymTable_get(oSymTable, "469");
-   ASSURE(pcValue == acCatcher);
+   /* Each binding is visited once, and the slots count every visit. */
+   for (uThreads = 1; uThreads <= THREAD_COUNT; uThreads *= 2)
+   {
+      for (u = 0; u < THREAD_COUNT; u++)
+      {
+         auCounts[u] = 0;
+         apvSlots[u] = &auCounts[u];
+      }
+      SymTable_mapParallel(oSymTable, countVisit, acMapExtra, uThreads,
+         apvSlots);
+      uTotal = 0;
+      for (u = 0; u < THREAD_COUNT; u++)
+      {
+         ASSURE(u < uThreads || auCounts[u] == 0);
+         uTotal += auCounts[u];
+      }
+      ASSURE(uTotal == (size_t)iBindingCount);
+      for (i = 0; i < iBindingCount; i++)
+      {
+         ASSURE(aiVisits[i] == 1);
+         aiVisits[i] = 0;
+      }
+   }
 
-   pcValue = SymTable_get(oSymTable, "1303");
-   ASSURE(pcValue == acRightField);
+   /* Without slots. */
+   SymTable_mapParallel(oSymTable, countVisit, acMapExtra, THREAD_COUNT,
+      NULL);
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(aiVisits[i] == 1);
 
    SymTable_free(oSymTable);
+   free(aiVisits);
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Test the ability of a SymTable object to be large, that is, to
-   contain iBindingCount bindings. Write the time consumed to stdout. */
+/* Test SymTable_iterBegin, SymTable_iterNext and SymTable_iterEnd with
+   a table of iBindingCount bindings. */
 
-static void testLargeTable(int iBindingCount)
+static void testIterator(int iBindingCount)
 {
-   enum {MAX_KEY_LENGTH = 10};
+   enum {MAX_KEY_LENGTH = 12};
+   enum {GROWTH_COUNT = 1000};
 
    SymTable_T oSymTable;
-   SymTable_T oSymTableSmall;
+   SymTable_Iter sIter;
    char acKey[MAX_KEY_LENGTH];
-   char *pcValue;
+   int *aiVisits;
+   const char *pcKey;
+   void *pvValue;
+   size_t uCount;
    int i;
-   int iSmall;
-   int iLarge;
    int iSuccessful;
-   clock_t iInitialClock;
-   clock_t iFinalClock;
-   size_t uLength = 0;
-   size_t uLength2;
 
    printf("------------------------------------------------------\n");
-   printf("Testing a potentially large SymTable object.\n");
-   printf("No output except CPU time consumed should appear here:\n");
+   printf("Testing SymTable_iterBegin, SymTable_iterNext, and "
+      "SymTable_iterEnd.\n");
+   printf("No output should appear here:\n");
    fflush(stdout);
 
-   /* Note the current time. */
-   iInitialClock = clock();
+   aiVisits = (int*)calloc((size_t)iBindingCount + 1, sizeof(int));
+   ASSURE(aiVisits != NULL);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
 
-   /* Create oSymTableSmall, and put a couple of bindings into it. */
-   oSymTableSmall = SymTable_new();
+   /* An empty table has no binding to visit, however often asked. */
+   SymTable_iterBegin(oSymTable, &sIter);
+   ASSURE(! SymTable_iterNext(&sIter, &pcKey, &pvValue));
+   ASSURE(! SymTable_iterNext(&sIter, &pcKey, &pvValue));
+   SymTable_iterEnd(&sIter);
+
+   /* The value of key i counts the visits of its binding. */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiVisits[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* Each binding is visited once, with its own key and value, even
+      when the loop body looks bindings up, and even when reserving
+      room has left bindings to be moved to a larger bucket array. */
+   iSuccessful = SymTable_reserve(oSymTable, 2 * (size_t)iBindingCount);
+   ASSURE(iSuccessful);
+   uCount = 0;
+   SymTable_iterBegin(oSymTable, &sIter);
+   while (SymTable_iterNext(&sIter, &pcKey, &pvValue))
+   {
+      i = (int)((int*)pvValue - aiVisits);
+      ASSURE(i >= 0 && i < iBindingCount);
+      sprintf(acKey, "%d", i);
+      ASSURE(strcmp(pcKey, acKey) == 0);
+      aiVisits[i]++;
+      uCount++;
+      sprintf(acKey, "%d", (int)(((long)i * 7 + 1) % iBindingCount));
+      ASSURE(SymTable_contains(oSymTable, acKey));
+   }
+   ASSURE(! SymTable_iterNext(&sIter, &pcKey, &pvValue));
+   SymTable_iterEnd(&sIter);
+   ASSURE(uCount == (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      ASSURE(aiVisits[i] == 1);
+      aiVisits[i] = 0;
+   }
+
+   /* A key returned by SymTable_iterNext stays valid after puts that
+      grow the table and a reservation, until its binding is 
+      removed. */
+   SymTable_iterBegin(oSymTable, &sIter);
+   iSuccessful = SymTable_iterNext(&sIter, &pcKey, &pvValue);
+   SymTable_iterEnd(&sIter);
+   ASSURE(iSuccessful == (iBindingCount > 0));
+   for (i = 0; i < GROWTH_COUNT; i++)
+   {
+      sprintf(acKey, "x%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, NULL);
+      ASSURE(iSuccessful);
+   }
+   iSuccessful = SymTable_reserve(oSymTable,
+      2 * ((size_t)iBindingCount + GROWTH_COUNT));
+   ASSURE(iSuccessful);
+   if (iBindingCount > 0)
+   {
+      i = (int)((int*)pvValue - aiVisits);
+      sprintf(acKey, "%d", i);
+      ASSURE(strcmp(pcKey, acKey) == 0);
+      ASSURE(SymTable_get(oSymTable, pcKey) == pvValue);
+   }
+   for (i = 0; i < GROWTH_COUNT; i++)
+   {
+      sprintf(acKey, "x%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == NULL);
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+
+   /* A traversal may stop early, and the table is usable after. */
+   uCount = 0;
+   SymTable_iterBegin(oSymTable, &sIter);
+   while (uCount < (size_t)iBindingCount / 2 &&
+      SymTable_iterNext(&sIter, NULL, NULL))
+      uCount++;
+   SymTable_iterEnd(&sIter);
+   ASSURE(uCount == (size_t)iBindingCount / 2);
+   iSuccessful = SymTable_put(oSymTable, "-1", &aiVisits[iBindingCount]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_remove(oSymTable, "-1") == &aiVisits[iBindingCount]);
+
+   /* Once every other binding is removed, only the rest are
+      visited. */
+   for (i = 0; i < iBindingCount; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &aiVisits[i]);
+   }
+   SymTable_iterBegin(oSymTable, &sIter);
+   while (SymTable_iterNext(&sIter, NULL, &pvValue))
+      (*(int*)pvValue)++;
+   SymTable_iterEnd(&sIter);
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(aiVisits[i] == i % 2);
+
+   /* So does SymTable_map, which also skips the emptied buckets. */
+   SymTable_map(oSymTable, countVisitSerially, acMapExtra);
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(aiVisits[i] == 2 * (i % 2));
+
+   /* Once every binding is removed, none is visited. */
+   for (i = 1; i < iBindingCount; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &aiVisits[i]);
+   }
+   SymTable_iterBegin(oSymTable, &sIter);
+   ASSURE(! SymTable_iterNext(&sIter, &pcKey, &pvValue));
+   SymTable_iterEnd(&sIter);
+
+   SymTable_free(oSymTable);
+   free(aiVisits);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that oSymTable contains exactly the bindings of the keys i 
+   from 0 to iBindingCount-1 for which i % iStride == 0, each with
+   value &aiValues[i]. */
+
+static void checkStrided(SymTable_T oSymTable, int iBindingCount,
+   int iStride, int aiValues[])
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   char acKey[MAX_KEY_LENGTH];
+   size_t uCount = 0;
+   int i;
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (i % iStride == 0)
+      {
+         ASSURE(SymTable_get(oSymTable, acKey) == &aiValues[i]);
+         uCount++;
+      }
+      else
+         ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+   ASSURE(SymTable_getLength(oSymTable) == uCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that a table of iBindingCount bindings keeps its bindings as 
+   most of them are removed (which may shrink it), and as it is
+   compacted with SymTable_compact. */
+
+static void testCompact(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {KEEP_STRIDE = 100};
+
+   SymTable_T oSymTable;
+   SymTable_Iter sIter;
+   char acKey[MAX_KEY_LENGTH];
+   int *aiValues;
+   const char *pcKey;
+   void *pvValue;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing shrinking and SymTable_compact.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   aiValues = (int*)calloc((size_t)iBindingCount + 1, sizeof(int));
+   ASSURE(aiValues != NULL);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* An empty table can be compacted. */
+   iSuccessful = SymTable_compact(oSymTable);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* Removing all but one in KEEP_STRIDE bindings keeps the rest. */
+   for (i = 0; i < iBindingCount; i++)
+      if (i % KEEP_STRIDE != 0)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+      }
+   checkStrided(oSymTable, iBindingCount, KEEP_STRIDE, aiValues);
+
+   /* So does compacting, after which the keys are still whole. */
+   iSuccessful = SymTable_compact(oSymTable);
+   ASSURE(iSuccessful);
+   checkStrided(oSymTable, iBindingCount, KEEP_STRIDE, aiValues);
+   SymTable_iterBegin(oSymTable, &sIter);
+   while (SymTable_iterNext(&sIter, &pcKey, &pvValue))
+   {
+      sprintf(acKey, "%d", (int)((int*)pvValue - aiValues));
+      ASSURE(strcmp(pcKey, acKey) == 0);
+   }
+   SymTable_iterEnd(&sIter);
+
+   /* The compacted table grows again as bindings are put back. */
+   for (i = 0; i < iBindingCount; i++)
+      if (i % KEEP_STRIDE != 0)
+      {
+         sprintf(acKey, "%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+         ASSURE(iSuccessful);
+      }
+   checkStrided(oSymTable, iBindingCount, 1, aiValues);
+   iSuccessful = SymTable_compact(oSymTable);
+   ASSURE(iSuccessful);
+   checkStrided(oSymTable, iBindingCount, 1, aiValues);
+
+   /* Removing every binding shrinks the table all the way. */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   iSuccessful = SymTable_compact(oSymTable);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "0", &aiValues[0]);
+   ASSURE(iSuccessful);
+   checkStrided(oSymTable, 1, 1, aiValues);
+
+   SymTable_free(oSymTable);
+   free(aiValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_newWithCapacity and SymTable_reserve: tables with
+   room reserved hold the same bindings as any other, and keep them
+   through reserving again, removing and compacting. */
+
+static void testCapacity(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {KEEP_STRIDE = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int *aiValues;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newWithCapacity and SymTable_reserve.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   aiValues = (int*)calloc((size_t)iBindingCount + 1, sizeof(int));
+   ASSURE(aiValues != NULL);
+
+   /* A table with no room reserved is an ordinary empty table. */
+   oSymTable = SymTable_newWithCapacity(0);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   iSuccessful = SymTable_put(oSymTable, "0", &aiValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "0") == &aiValues[0]);
+   SymTable_free(oSymTable);
+
+   /* A table created with room for every binding holds them all. */
+   oSymTable = SymTable_newWithCapacity((size_t)iBindingCount);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   checkStrided(oSymTable, iBindingCount, 1, aiValues);
+
+   /* Reserving less room than the table already has changes nothing,
+      and reserving more keeps every binding. */
+   iSuccessful = SymTable_reserve(oSymTable, 0);
+   ASSURE(iSuccessful);
+   checkStrided(oSymTable, iBindingCount, 1, aiValues);
+   iSuccessful = SymTable_reserve(oSymTable, 4 * (size_t)iBindingCount);
+   ASSURE(iSuccessful);
+   checkStrided(oSymTable, iBindingCount, 1, aiValues);
+
+   /* Removing most bindings of a table with room reserved, and then
+      compacting it, keeps the rest. */
+   for (i = 0; i < iBindingCount; i++)
+      if (i % KEEP_STRIDE != 0)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+      }
+   checkStrided(oSymTable, iBindingCount, KEEP_STRIDE, aiValues);
+   iSuccessful = SymTable_compact(oSymTable);
+   ASSURE(iSuccessful);
+   checkStrided(oSymTable, iBindingCount, KEEP_STRIDE, aiValues);
+   SymTable_free(oSymTable);
+
+   /* Room can be reserved in a table that already holds bindings,
+      and the bindings put afterwards join them. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount / 2; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   iSuccessful = SymTable_reserve(oSymTable, (size_t)iBindingCount);
+   ASSURE(iSuccessful);
+   for (; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   checkStrided(oSymTable, iBindingCount, 1, aiValues);
+   SymTable_free(oSymTable);
+
+   free(aiValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_putBatch and SymTable_getBatch with batches of
+   iBindingCount keys. */
+
+static void testBatch(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   char (*aacKeys)[MAX_KEY_LENGTH];
+   const char **apcKeys;
+   const void **apvValues;
+   void **apvFound;
+   char acShortstop[] = "Shortstop";
+   size_t uCount = (size_t)iBindingCount + 3;
+   size_t uAdded;
+   size_t uLength;
+   size_t u;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the batch functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   aacKeys = malloc(uCount * sizeof(*aacKeys));
+   apcKeys = malloc(uCount * sizeof(*apcKeys));
+   apvValues = malloc(uCount * sizeof(*apvValues));
+   apvFound = malloc(uCount * sizeof(*apvFound));
+   ASSURE(aacKeys != NULL && apcKeys != NULL && apvValues != NULL &&
+      apvFound != NULL);
+
+   /* Keys "0" to "iBindingCount-1", then "x" twice and "-1". */
+   for (u = 0; u < uCount; u++)
+   {
+      if (u < (size_t)iBindingCount)
+         sprintf(aacKeys[u], "%lu", (unsigned long)u);
+      else if (u < uCount - 1)
+         strcpy(aacKeys[u], "x");
+      else
+         strcpy(aacKeys[u], "-1");
+      apcKeys[u] = aacKeys[u];
+      apvValues[u] = aacKeys[u];
+   }
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* "-1" is already present; the second "x" repeats the first. */
+   iSuccessful = SymTable_put(oSymTable, "-1", acShortstop);
+   ASSURE(iSuccessful);
+   uAdded = SymTable_putBatch(oSymTable, apcKeys, uCount, apvValues);
+   ASSURE(uAdded == (size_t)iBindingCount + 1);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == (size_t)iBindingCount + 2);
+
+   uAdded = SymTable_putBatch(oSymTable, apcKeys, 0, apvValues);
+   ASSURE(uAdded == 0);
+
+   SymTable_getBatch(oSymTable, apcKeys, uCount, apvFound);
+   for (u = 0; u < (size_t)iBindingCount; u++)
+      ASSURE(apvFound[u] == aacKeys[u]);
+   ASSURE(apvFound[iBindingCount] == aacKeys[iBindingCount]);
+   ASSURE(apvFound[iBindingCount + 1] == aacKeys[iBindingCount]);
+   ASSURE(apvFound[iBindingCount + 2] == acShortstop);
+
+   /* Missing keys are found as NULL. */
+   SymTable_remove(oSymTable, "-1");
+   SymTable_getBatch(oSymTable, apcKeys + iBindingCount + 2, 1, 
+      apvFound);
+   ASSURE(apvFound[0] == NULL);
+
+   SymTable_free(oSymTable);
+   free(aacKeys);
+   free(apcKeys);
+   free(apvValues);
+   free(apvFound);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_upsert and SymTable_getOrInsert. */
+
+static void testUpsert(void)
+{
+   SymTable_T oSymTable;
+   char acShortstop[] = "Shortstop";
+   char acCatcher[] = "Catcher";
+   char acOutfielder[] = "Outfielder";
+   char *pcValue;
+   void **ppvValue;
+   void **ppvValue2;
+   int iSuccessful;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_upsert and SymTable_getOrInsert.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Upsert adds a new binding, then replaces its value. */
+   iSuccessful = SymTable_upsert(oSymTable, "Ruth", acShortstop);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(pcValue == acShortstop);
+   iSuccessful = SymTable_upsert(oSymTable, "Ruth", acCatcher);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(pcValue == acCatcher);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 1);
+
+   /* GetOrInsert finds an existing binding without changing it. */
+   ppvValue = SymTable_getOrInsert(oSymTable, "Ruth", acOutfielder);
+   ASSURE(ppvValue != NULL);
+   ASSURE(*ppvValue == acCatcher);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 1);
+
+   /* ... and the value may be stored through the returned address. */
+   *ppvValue = acShortstop;
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(pcValue == acShortstop);
+
+   /* GetOrInsert adds a missing binding with the given value. */
+   ppvValue = SymTable_getOrInsert(oSymTable, "Gehrig", acOutfielder);
+   ASSURE(ppvValue != NULL);
+   ASSURE(*ppvValue == acOutfielder);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 2);
+   ppvValue2 = SymTable_getOrInsert(oSymTable, "Gehrig", acCatcher);
+   ASSURE(ppvValue2 == ppvValue);
+
+   /* A NULL value is a value like any other. */
+   ppvValue = SymTable_getOrInsert(oSymTable, "Mantle", NULL);
+   ASSURE(ppvValue != NULL);
+   ASSURE(*ppvValue == NULL);
+   ASSURE(SymTable_contains(oSymTable, "Mantle"));
+   iSuccessful = SymTable_upsert(oSymTable, "Mantle", acCatcher);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, "Mantle");
+   ASSURE(pcValue == acCatcher);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 3);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ability of a SymTable object to contain long keys. */
+
+static void testLongKey(void)
+{
+   enum {KEY_SIZE = 1000};
+
+   SymTable_T oSymTable;
+   char acKeyA[KEY_SIZE];
+   char acKeyB[KEY_SIZE];
+   char *pcValue;
+   char acShortstop[] = "Shortstop";
+   int iFound;
+   int i;
+   size_t uLength;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object that contains long keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (i = 0; i < KEY_SIZE - 1; i++)
+      acKeyA[i] = 'a';
+   acKeyA[KEY_SIZE - 1] = '\0';
+
+   for (i = 0; i < KEY_SIZE - 1; i++)
+      acKeyB[i] = 'b';
+   acKeyB[KEY_SIZE - 1] = '\0';
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   iSuccessful = SymTable_put(oSymTable, acKeyA, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acKeyB, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acKeyB, acShortstop);
+   ASSURE(! iSuccessful);
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 2);
+
+   iFound = SymTable_contains(oSymTable, acKeyA);
+   ASSURE(iFound);
+   iFound = SymTable_contains(oSymTable, acKeyB);
+   ASSURE(iFound);
+
+   pcValue = (char*)SymTable_get(oSymTable, acKeyA);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_get(oSymTable, acKeyB);
+   ASSURE(pcValue == acShortstop);
+
+   pcValue = (char*)SymTable_remove(oSymTable, acKeyB);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_remove(oSymTable, acKeyB);
+   ASSURE(pcValue == NULL);
+   pcValue = (char*)SymTable_remove(oSymTable, acKeyA);
+   ASSURE(pcValue == acShortstop);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ability of SymTable object to have values that are
+   other SymTable objects. */
+
+static void testTableOfTables(void)
+{
+   SymTable_T oSymTable;
+   SymTable_T oSymTable1;
+   SymTable_T oSymTable2;
+   SymTable_T oSymTableRet;
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "CenterField";
+   char *pcValue;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object that contains other\n");
+   printf("SymTable objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable1 = SymTable_new();
+   ASSURE(oSymTable1 != NULL);
+
+   iSuccessful = SymTable_put(oSymTable1, "Jeter", acShortstop);
+   ASSURE(iSuccessful);
+
+   oSymTable2 = SymTable_new();
+   ASSURE(oSymTable2 != NULL);
+
+   iSuccessful = SymTable_put(oSymTable2, "Mantle", acCenterField);
+   ASSURE(iSuccessful);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   iSuccessful = SymTable_put(oSymTable, "first table", oSymTable1);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, "second table", oSymTable2);
+   ASSURE(iSuccessful);
+
+   oSymTableRet = (SymTable_T)SymTable_get(oSymTable, "first table");
+   ASSURE(oSymTableRet == oSymTable1);
+
+   pcValue = (char*)SymTable_get(oSymTableRet, "Jeter");
+   ASSURE(pcValue == acShortstop);
+
+   oSymTableRet = (SymTable_T)SymTable_get(oSymTable, "second table");
+   ASSURE(oSymTableRet == oSymTable2);
+
+   pcValue = (char*)SymTable_get(oSymTableRet, "Mantle");
+   ASSURE(pcValue == acCenterField);
+
+   SymTable_free(oSymTable2);
+   SymTable_free(oSymTable1);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ability of a SymTable object to handle collisions.  This
+   test assumes that a SymTable object is implemented as a hash table,
+   that there are 509 buckets in the hash table, and that the
+   implementation uses the hash function provided in the assignment
+   specification. */
+
+static void testCollisions(void)
+{
+   SymTable_T oSymTable;
+   int iSuccessful;
+   char acCenterField[] = "pitcher";
+   char acCatcher[] = "catcher";
+   char acFirstBase[] = "first base";
+   char acRightField[] = "second base";
+   char *pcValue;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the collision handling of a SymTable object\n");
+   printf("assuming a hash table implementation, and assuming that\n");
+   printf("the implementation uses the hash function from the\n");
+   printf("assignment specification.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Note that strings "250", "469", "947", "1303", and "2016" hash
+      to the same bucket -- bucket 123. */
+
+   iSuccessful = SymTable_put(oSymTable, "250", acCenterField);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, "469", acCatcher);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, "947", acFirstBase);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, "1303", acRightField);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, "2016", acRightField);
+   ASSURE(iSuccessful);
+
+   pcValue = SymTable_get(oSymTable, "250");
+   ASSURE(pcValue == acCenterField);
+
+   pcValue = SymTable_get(oSymTable, "469");
+   ASSURE(pcValue == acCatcher);
+
+   pcValue = SymTable_get(oSymTable, "947");
+   ASSURE(pcValue == acFirstBase);
+
+   pcValue = SymTable_get(oSymTable, "1303");
+   ASSURE(pcValue == acRightField);
+
+   pcValue = SymTable_get(oSymTable, "2016");
+   ASSURE(pcValue == acRightField);
+
+   pcValue = SymTable_remove(oSymTable, "947");
+   ASSURE(pcValue == acFirstBase);
+
+   pcValue = SymTable_remove(oSymTable, "2016");
+   ASSURE(pcValue == acRightField);
+
+   pcValue = SymTable_remove(oSymTable, "250");
+   ASSURE(pcValue == acCenterField);
+
+   pcValue = SymTable_get(oSymTable, "469");
+   ASSURE(pcValue == acCatcher);
+
+   pcValue = SymTable_get(oSymTable, "1303");
+   ASSURE(pcValue == acRightField);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable object that hashes its keys with the wide hash
+   function, putting, getting and removing iBindingCount numeric keys
+   and two long keys. */
+
+static void testWideHash(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {LONG_KEY_SIZE = 1000};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acLongKeyA[LONG_KEY_SIZE];
+   char acLongKeyB[LONG_KEY_SIZE];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object that uses the wide hash.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newWithHash(SYMTABLE_HASH_WIDE);
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == (size_t)iBindingCount);
+
+   /* Long keys differing only in their last character. */
+   memset(acLongKeyA, 'a', LONG_KEY_SIZE - 1);
+   acLongKeyA[LONG_KEY_SIZE - 1] = '\0';
+   memcpy(acLongKeyB, acLongKeyA, LONG_KEY_SIZE);
+   acLongKeyB[LONG_KEY_SIZE - 2] = 'b';
+   iSuccessful = SymTable_put(oSymTable, acLongKeyA, acLongKeyA);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acLongKeyB, acLongKeyB);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acLongKeyB, acLongKeyA);
+   ASSURE(! iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, acLongKeyA);
+   ASSURE(pcValue == acLongKeyA);
+   pcValue = (char*)SymTable_get(oSymTable, acLongKeyB);
+   ASSURE(pcValue == acLongKeyB);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+   pcValue = (char*)SymTable_get(oSymTable, "-1");
+   ASSURE(pcValue == NULL);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+   pcValue = (char*)SymTable_remove(oSymTable, acLongKeyA);
+   ASSURE(pcValue == acLongKeyA);
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 1);
+
+   SymTable_free(oSymTable);
+}
+
+#ifdef SYMTABLE_ORDERED
+/*--------------------------------------------------------------------*/
+
+/* What a traversal, range query or prefix query of testOrdered may
+   visit, and what it has visited so far. */
+
+struct OrderedQuery
+{
+   /* The bounds of the range (NULL if unbounded), and the prefix
+      (NULL if any) */
+   const char *pcLow;
+   const char *pcHigh;
+   const char *pcPrefix;
+   /* The key of the last binding visited, or NULL */
+   const char *pcLast;
+   /* Number of bindings visited */
+   size_t uCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Check that the binding whose key is pcKey and whose value pvValue
+   is a copy of the key, visited by the query that the OrderedQuery
+   pvExtra describes, follows the one visited before it in key order
+   and matches the query. */
+
+static void checkOrdered(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   struct OrderedQuery *psQuery = (struct OrderedQuery*)pvExtra;
+
+   assert(pcKey != NULL);
+   assert(psQuery != NULL);
+
+   ASSURE(strcmp(pcKey, (const char*)pvValue) == 0);
+   ASSURE((psQuery->pcLast == NULL) ||
+          (strcmp(psQuery->pcLast, pcKey) < 0));
+   ASSURE((psQuery->pcLow == NULL) ||
+          (strcmp(pcKey, psQuery->pcLow) >= 0));
+   ASSURE((psQuery->pcHigh == NULL) ||
+          (strcmp(pcKey, psQuery->pcHigh) < 0));
+   ASSURE((psQuery->pcPrefix == NULL) ||
+          (strncmp(pcKey, psQuery->pcPrefix,
+                   strlen(psQuery->pcPrefix)) == 0));
+   psQuery->pcLast = pcKey;
+   psQuery->uCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check SymTable_prefix(oSymTable, pcPrefix, ...) if pcPrefix is not
+   NULL, or else SymTable_range(oSymTable, pcLow, pcHigh, ...), where
+   oSymTable contains the bindings of every iStride-th key of the
+   iBindingCount keys apcKeys, each bound to itself. */
+
+static void checkQuery(SymTable_T oSymTable, const char *const apcKeys[],
+   int iBindingCount, int iStride, const char *pcLow,
+   const char *pcHigh, const char *pcPrefix)
+{
+   struct OrderedQuery sQuery;
+   size_t uExpected = 0;
+   int i;
+
+   for (i = 0; i < iBindingCount; i += iStride)
+   {
+      if (pcPrefix != NULL)
+         uExpected += strncmp(apcKeys[i], pcPrefix, strlen(pcPrefix)) == 0;
+      else
+         uExpected += ((pcLow == NULL) || (strcmp(apcKeys[i], pcLow) >= 0))
+            && ((pcHigh == NULL) || (strcmp(apcKeys[i], pcHigh) < 0));
+   }
+
+   sQuery.pcLow = pcLow;
+   sQuery.pcHigh = pcHigh;
+   sQuery.pcPrefix = pcPrefix;
+   sQuery.pcLast = NULL;
+   sQuery.uCount = 0;
+   if (pcPrefix != NULL)
+      SymTable_prefix(oSymTable, pcPrefix, checkOrdered, &sQuery);
+   else
+      SymTable_range(oSymTable, pcLow, pcHigh, checkOrdered, &sQuery);
+   ASSURE(sQuery.uCount == uExpected);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check every kind of ordered access to oSymTable, which contains the
+   bindings of every iStride-th key of the iBindingCount keys apcKeys,
+   each bound to itself. */
+
+static void checkOrderedTable(SymTable_T oSymTable,
+   const char *const apcKeys[], int iBindingCount, int iStride)
+{
+   struct OrderedQuery sQuery;
+   SymTable_Iter sIter;
+   const char *pcKey;
+   void *pvValue;
+
+   /* SymTable_map and the iterator visit every binding in order. */
+   sQuery.pcLow = NULL;
+   sQuery.pcHigh = NULL;
+   sQuery.pcPrefix = NULL;
+   sQuery.pcLast = NULL;
+   sQuery.uCount = 0;
+   SymTable_map(oSymTable, checkOrdered, &sQuery);
+   ASSURE(sQuery.uCount == SymTable_getLength(oSymTable));
+   sQuery.pcLast = NULL;
+   sQuery.uCount = 0;
+   SymTable_iterBegin(oSymTable, &sIter);
+   while (SymTable_iterNext(&sIter, &pcKey, &pvValue))
+      checkOrdered(pcKey, pvValue, &sQuery);
+   SymTable_iterEnd(&sIter);
+   ASSURE(sQuery.uCount == SymTable_getLength(oSymTable));
+
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      NULL, NULL, NULL);
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      "1", "2", NULL);
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      "5", NULL, NULL);
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      NULL, "3", NULL);
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      "2", "1", NULL);
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      "identifier_25", "identifier_7", NULL);
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      NULL, NULL, "");
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      NULL, NULL, "1");
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      NULL, NULL, "12");
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      NULL, NULL, "identifier_1");
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      NULL, NULL, "identifier_99");
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      NULL, NULL, "x");
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      "pkg_module_sub", "pkg_module_submodule_func_2", NULL);
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      "pkg_module_submodule_func_25", "pkg_module_submodule_g", NULL);
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      NULL, NULL, "pkg_mod");
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      NULL, NULL, "pkg_module_submodule_func_1");
+   checkQuery(oSymTable, apcKeys, iBindingCount, iStride,
+      NULL, NULL, "pkg_module_submodule_x");
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ordered access of symtablebtree.c and symtableart.c:
+   traversals in key order, SymTable_range and SymTable_prefix, with
+   iBindingCount short keys and then iBindingCount keys whose first
+   characters are all the same (a few, then many of them, as in
+   namespaced identifiers), through removes and SymTable_compact. */
+
+static void testOrdered(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 40};
+
+   static const char *const apcFormats[] =
+      {"%d", "identifier_%d", "pkg_module_submodule_func_%d"};
+   static const char *const apcNested[] =
+      {"pkg_module_submodule_func_a", "pkg_module_submodule_func_b",
+       "pkg_module_submodule_gunc", "pkg_module_sub",
+       "pkg_module_submodule_func_", "pkg_module_submodule", "pkg",
+       "pkg_module_submodule_func_abcdefghijklmnop",
+       "pkg_module_submodule_func_abcdefghijklmnoq",
+       "pkg_module_submodule_func_abcdefghijk", "p", "pkh", "identifier_1"};
+   enum {NESTED_KEY_COUNT = sizeof(apcNested) / sizeof(apcNested[0])};
+   SymTable_T oSymTable;
+   char (*aacKeys)[MAX_KEY_LENGTH];
+   const char **apcKeys;
+   size_t uFormat;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_range and SymTable_prefix.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   aacKeys = (char(*)[MAX_KEY_LENGTH])
+      malloc(((size_t)iBindingCount + 1) * sizeof(*aacKeys));
+   apcKeys = (const char**)
+      malloc(((size_t)iBindingCount + 1) * sizeof(const char *));
+   ASSURE((aacKeys != NULL) && (apcKeys != NULL));
+
+   for (uFormat = 0;
+        uFormat < sizeof(apcFormats) / sizeof(apcFormats[0]); uFormat++)
+   {
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(aacKeys[i], apcFormats[uFormat], i);
+         apcKeys[i] = aacKeys[i];
+      }
+
+      /* Put the even keys in ascending order and the odd ones in
+         descending order, each bound to itself. */
+      oSymTable = SymTable_new();
+      ASSURE(oSymTable != NULL);
+      for (i = 0; i < iBindingCount; i += 2)
+      {
+         iSuccessful = SymTable_put(oSymTable, apcKeys[i], apcKeys[i]);
+         ASSURE(iSuccessful);
+      }
+      for (i = iBindingCount - 1 - (iBindingCount % 2 == 0 ? 0 : 1);
+           i > 0; i -= 2)
+      {
+         iSuccessful = SymTable_put(oSymTable, apcKeys[i], apcKeys[i]);
+         ASSURE(iSuccessful);
+      }
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+      checkOrderedTable(oSymTable, apcKeys, iBindingCount, 1);
+
+      /* Remove all but every third key. */
+      for (i = 0; i < iBindingCount; i++)
+         if (i % 3 != 0)
+            ASSURE(SymTable_remove(oSymTable, apcKeys[i]) == apcKeys[i]);
+      checkOrderedTable(oSymTable, apcKeys, iBindingCount, 3);
+
+      /* Compact the table, and put the keys back. */
+      iSuccessful = SymTable_compact(oSymTable);
+      ASSURE(iSuccessful);
+      checkOrderedTable(oSymTable, apcKeys, iBindingCount, 3);
+      for (i = 0; i < iBindingCount; i++)
+         if (i % 3 != 0)
+         {
+            iSuccessful = SymTable_put(oSymTable, apcKeys[i], apcKeys[i]);
+            ASSURE(iSuccessful);
+         }
+      checkOrderedTable(oSymTable, apcKeys, iBindingCount, 1);
+
+      SymTable_free(oSymTable);
+   }
+
+   /* Keys that share long runs of characters, or are prefixes of one
+      another, put in an order that splits the runs far from their
+      start; then the odd ones removed and put back. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < NESTED_KEY_COUNT; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, apcNested[i], apcNested[i]);
+      ASSURE(iSuccessful);
+   }
+   checkOrderedTable(oSymTable, apcNested, NESTED_KEY_COUNT, 1);
+   for (i = 1; i < NESTED_KEY_COUNT; i += 2)
+      ASSURE(SymTable_remove(oSymTable, apcNested[i]) == apcNested[i]);
+   checkOrderedTable(oSymTable, apcNested, NESTED_KEY_COUNT, 2);
+   for (i = 0; i < NESTED_KEY_COUNT; i++)
+      ASSURE(SymTable_get(oSymTable, apcNested[i]) ==
+         (i % 2 == 0 ? apcNested[i] : NULL));
+   for (i = NESTED_KEY_COUNT - 1 - NESTED_KEY_COUNT % 2; i > 0; i -= 2)
+   {
+      iSuccessful = SymTable_put(oSymTable, apcNested[i], apcNested[i]);
+      ASSURE(iSuccessful);
+   }
+   checkOrderedTable(oSymTable, apcNested, NESTED_KEY_COUNT, 1);
+   for (i = 0; i < NESTED_KEY_COUNT; i++)
+      ASSURE(SymTable_get(oSymTable, apcNested[i]) == apcNested[i]);
+   SymTable_free(oSymTable);
+
+   free(apcKeys);
+   free(aacKeys);
+}
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings, whose keys are the decimal numbers from
+   0 to iBindingCount-1 and whose values are oSymTable, into 
+   oSymTable. */
+
+static void loadLargeTable(SymTable_T oSymTable, int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+   int iSuccessful;
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, oSymTable);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ability of a SymTable object to be large, that is, to
+   contain iBindingCount bindings. Write the time consumed to stdout,
+   in total and by phase (put, get, remove), so that per-binding costs
+   can be compared across binding counts, and then the time to load 
+   the keys into a table with and without room reserved for them. */
+
+static void testLargeTable(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableSmall;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValue;
+   int i;
+   int iSmall;
+   int iLarge;
+   int iSuccessful;
+   clock_t iInitialClock;
+   clock_t iPutClock;
+   clock_t iGetClock;
+   clock_t iFinalClock;
+   clock_t iLoadStartClock;
+   double dUnreservedSeconds;
+   double dReservedSeconds;
+   size_t uLength = 0;
+   size_t uLength2;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a potentially large SymTable object.\n");
+   printf("No output except CPU time consumed should appear here:\n");
+   fflush(stdout);
+
+   /* Note the current time. */
+   iInitialClock = clock();
+
+   /* Create oSymTableSmall, and put a couple of bindings into it. */
+   oSymTableSmall = SymTable_new();
    ASSURE(oSymTableSmall != NULL);
    iSuccessful = SymTable_put(oSymTableSmall, "xxx", "xxx");
    ASSURE(iSuccessful);
@@ -830,6 +2117,8 @@ static void testLargeTable(int iBindingCount)
       ASSURE(uLength == (size_t)(i+1));
    }
 
+   iPutClock = clock();
+
    /* Get each binding's value, and make sure that it contains
       the same characters as its key. */
    iSmall = 0;
@@ -858,6 +2147,8 @@ static void testLargeTable(int iBindingCount)
       ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
    }
 
+   iGetClock = clock();
+
    /* Remove each binding. Also free each binding's value. */
    iSmall = 0;
    iLarge = iBindingCount - 1;
@@ -912,6 +2203,31 @@ static void testLargeTable(int iBindingCount)
    iFinalClock = clock();
    printf("CPU time (%d bindings):  %f seconds\n", iBindingCount,
       ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+   printf("   put: %f   get: %f   remove: %f seconds\n",
+      ((double)(iPutClock - iInitialClock)) / CLOCKS_PER_SEC,
+      ((double)(iGetClock - iPutClock)) / CLOCKS_PER_SEC,
+      ((double)(iFinalClock - iGetClock)) / CLOCKS_PER_SEC);
+
+   /* Load the same keys again, into a table that grows as they come
+      and into one created with room for all of them, which should
+      not spend time moving bindings to ever larger bucket arrays. */
+   iLoadStartClock = clock();
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   loadLargeTable(oSymTable, iBindingCount);
+   dUnreservedSeconds = 
+      ((double)(clock() - iLoadStartClock)) / CLOCKS_PER_SEC;
+   SymTable_free(oSymTable);
+
+   iLoadStartClock = clock();
+   oSymTable = SymTable_newWithCapacity((size_t)iBindingCount);
+   ASSURE(oSymTable != NULL);
+   loadLargeTable(oSymTable, iBindingCount);
+   dReservedSeconds = 
+      ((double)(clock() - iLoadStartClock)) / CLOCKS_PER_SEC;
+   SymTable_free(oSymTable);
+   printf("   load unreserved: %f   reserved: %f seconds\n",
+      dUnreservedSeconds, dReservedSeconds);
    fflush(stdout);
 }
 
@@ -926,7 +2242,13 @@ static void testLargeTable(int iBindingCount)
 
 int main(int argc, char *argv[])
 {
+   /* The tests of particular functions need not be as large as the
+      test of a large table, and would otherwise take most of the CPU
+      time that setCpuTimeLimit allows. */
+   enum {MAX_FUNCTION_TEST_BINDING_COUNT = 1000000};
+
    int iBindingCount;
+   int iFunctionTestCount;
 
    if (argc != 2)
    {
@@ -949,17 +2271,33 @@ int main(int argc, char *argv[])
    setCpuTimeLimit();
 #endif
 
+   iFunctionTestCount = iBindingCount < MAX_FUNCTION_TEST_BINDING_COUNT ?
+      iBindingCount : MAX_FUNCTION_TEST_BINDING_COUNT;
+
    testBasics();
    testKeyComparison();
    testKeyOwnership();
    testRemove();
+   testLookalikeKeys();
    testMap();
    testEmptyTable();
    testEmptyKey();
    testNullValue();
    testLongKey();
+   testKeySlices();
+   testKeyHandles();
+   testUpsert();
    testTableOfTables();
    testCollisions();
+   testWideHash(iFunctionTestCount);
+   testBatch(iFunctionTestCount);
+   testMapParallel(iFunctionTestCount);
+   testIterator(iFunctionTestCount);
+   testCompact(iFunctionTestCount);
+   testCapacity(iFunctionTestCount);
+#ifdef SYMTABLE_ORDERED
+   testOrdered(iFunctionTestCount);
+#endif
    testLargeTable(iBindingCount);
 
    printf("------------------------------------------------------\n");